@@ -0,0 +1,174 @@
+#include "Adafruit_GFX.h"
+#include <string.h>
+
+// Digits of the built-in Adafruit font, 5 columns each, bit 0 is the top row
+static const uint8_t digitFont[10][5] = {
+    {0x3E, 0x51, 0x49, 0x45, 0x3E},   // 0
+    {0x00, 0x42, 0x7F, 0x40, 0x00},   // 1
+    {0x72, 0x49, 0x49, 0x49, 0x46},   // 2
+    {0x21, 0x41, 0x49, 0x4D, 0x33},   // 3
+    {0x18, 0x14, 0x12, 0x7F, 0x10},   // 4
+    {0x27, 0x45, 0x45, 0x45, 0x39},   // 5
+    {0x3C, 0x4A, 0x49, 0x49, 0x31},   // 6
+    {0x41, 0x21, 0x11, 0x09, 0x07},   // 7
+    {0x36, 0x49, 0x49, 0x49, 0x36},   // 8
+    {0x46, 0x49, 0x49, 0x29, 0x1E},   // 9
+};
+
+/**
+ * @brief Constructor
+ * @param w Width in pixels
+ * @param h Height in pixels
+ */
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) :
+    displayWidth(w),
+    displayHeight(h),
+    cursorX(0),
+    cursorY(0),
+    textColor(0xFFFF),
+    textBackground(0xFFFF),
+    textSize(1),
+    wrap(true) {
+}
+
+/**
+ * @brief Fill a rectangle, pixel by pixel unless the display does better
+ * @param x X-position of the top left corner
+ * @param y Y-position of the top left corner
+ * @param w Width
+ * @param h Height
+ * @param color RGB565 color
+ */
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    for (int16_t row = y; row < y + h; row++) {
+        for (int16_t col = x; col < x + w; col++) {
+            drawPixel(col, row, color);
+        }
+    }
+}
+
+/**
+ * @brief Fill the whole display
+ * @param color RGB565 color
+ */
+void Adafruit_GFX::fillScreen(uint16_t color) {
+    fillRect(0, 0, displayWidth, displayHeight, color);
+}
+
+/**
+ * @brief Draw one character of the built-in font
+ * @param x X-position of the top left corner
+ * @param y Y-position of the top left corner
+ * @param c Character
+ * @param color Foreground color
+ * @param bg Background color, same as color for a transparent background
+ * @param size Scale factor
+ */
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+    if (x >= displayWidth || y >= displayHeight || x + 6 * size - 1 < 0 || y + 8 * size - 1 < 0) {
+        return;
+    }
+
+    const uint8_t* glyph = c >= '0' && c <= '9' ? digitFont[c - '0'] : nullptr;
+
+    // Five glyph columns plus one column of spacing, like the original
+    for (int8_t i = 0; i < 6; i++) {
+        uint8_t line = glyph != nullptr && i < 5 ? glyph[i] : 0;
+        for (int8_t j = 0; j < 8; j++, line >>= 1) {
+            if (line & 1) {
+                fillRect(x + i * size, y + j * size, size, size, color);
+            } else if (bg != color) {
+                fillRect(x + i * size, y + j * size, size, size, bg);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Draw a character at the cursor and advance it
+ * @param c Character, '\n' starts a new line
+ * @return 1
+ */
+size_t Adafruit_GFX::write(uint8_t c) {
+    if (c == '\n') {
+        cursorX = 0;
+        cursorY += textSize * 8;
+    } else if (c != '\r') {
+        if (wrap && cursorX + textSize * 6 > displayWidth) {
+            cursorX = 0;
+            cursorY += textSize * 8;
+        }
+        drawChar(cursorX, cursorY, c, textColor, textBackground, textSize);
+        cursorX += textSize * 6;
+    }
+    return 1;
+}
+
+/**
+ * @brief Draw a string at the cursor
+ * @param text Null terminated string
+ * @return Characters written
+ */
+size_t Adafruit_GFX::print(const char* text) {
+    size_t count = 0;
+    while (*text != '\0') {
+        count += write((uint8_t)*text++);
+    }
+    return count;
+}
+
+/**
+ * @brief Constructor, the canvas starts cleared
+ * @param w Width in pixels
+ * @param h Height in pixels
+ */
+GFXcanvas1::GFXcanvas1(uint16_t w, uint16_t h) :
+    Adafruit_GFX(w, h),
+    buffer(new uint8_t[((w + 7) / 8) * h]()) {
+}
+
+/**
+ * @brief Destructor
+ */
+GFXcanvas1::~GFXcanvas1() {
+    delete[] buffer;
+}
+
+/**
+ * @brief Set or clear one pixel
+ * @param x X-position
+ * @param y Y-position
+ * @param color Non-zero sets the pixel
+ */
+void GFXcanvas1::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || y < 0 || x >= displayWidth || y >= displayHeight) {
+        return;
+    }
+    uint8_t* byte = &buffer[y * ((displayWidth + 7) / 8) + x / 8];
+    if (color) {
+        *byte |= 0x80 >> (x & 7);
+    } else {
+        *byte &= ~(0x80 >> (x & 7));
+    }
+}
+
+/**
+ * @brief Set or clear the whole canvas
+ * @param color Non-zero sets every pixel
+ */
+void GFXcanvas1::fillScreen(uint16_t color) {
+    memset(buffer, color ? 0xFF : 0x00, ((displayWidth + 7) / 8) * displayHeight);
+}
+
+/**
+ * @brief Read back a pixel
+ * @param x X-position
+ * @param y Y-position
+ * @return True if set, false if clear or outside the canvas
+ */
+bool GFXcanvas1::getPixel(int16_t x, int16_t y) const {
+    if (x < 0 || y < 0 || x >= displayWidth || y >= displayHeight) {
+        return false;
+    }
+    return buffer[y * ((displayWidth + 7) / 8) + x / 8] & (0x80 >> (x & 7));
+}
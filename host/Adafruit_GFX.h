@@ -0,0 +1,149 @@
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Stand-in for the Adafruit GFX base class, text and rectangles only
+ *
+ * Text uses the classic 6x8 font cell with the glyphs of the built-in
+ * Adafruit font. Only digits and space are included, which is all the
+ * firmware prints; other characters advance the cursor without drawing.
+ */
+class Adafruit_GFX {
+public:
+    /**
+     * @brief Constructor
+     * @param w Width in pixels
+     * @param h Height in pixels
+     */
+    Adafruit_GFX(int16_t w, int16_t h);
+
+    virtual ~Adafruit_GFX() {
+    }
+
+    /**
+     * @brief Set one pixel, implemented by the display
+     * @param x X-position
+     * @param y Y-position
+     * @param color RGB565 color
+     */
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    /**
+     * @brief Fill a rectangle, pixel by pixel unless the display does better
+     * @param x X-position of the top left corner
+     * @param y Y-position of the top left corner
+     * @param w Width
+     * @param h Height
+     * @param color RGB565 color
+     */
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+    /**
+     * @brief Fill the whole display
+     * @param color RGB565 color
+     */
+    virtual void fillScreen(uint16_t color);
+
+    /**
+     * @brief Draw one character of the built-in font
+     * @param x X-position of the top left corner
+     * @param y Y-position of the top left corner
+     * @param c Character
+     * @param color Foreground color
+     * @param bg Background color, same as color for a transparent background
+     * @param size Scale factor
+     */
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+
+    void setCursor(int16_t x, int16_t y) {
+        cursorX = x;
+        cursorY = y;
+    }
+
+    void setTextColor(uint16_t color) {
+        textColor = color;
+        textBackground = color;
+    }
+
+    void setTextColor(uint16_t color, uint16_t background) {
+        textColor = color;
+        textBackground = background;
+    }
+
+    void setTextSize(uint8_t size) {
+        textSize = size > 0 ? size : 1;
+    }
+
+    void setTextWrap(bool enabled) {
+        wrap = enabled;
+    }
+
+    int16_t width() const {
+        return displayWidth;
+    }
+
+    int16_t height() const {
+        return displayHeight;
+    }
+
+    /**
+     * @brief Draw a character at the cursor and advance it
+     * @param c Character, '\n' starts a new line
+     * @return 1
+     */
+    size_t write(uint8_t c);
+
+    /**
+     * @brief Draw a string at the cursor
+     * @param text Null terminated string
+     * @return Characters written
+     */
+    size_t print(const char* text);
+
+protected:
+    int16_t displayWidth;       // Width in pixels
+    int16_t displayHeight;      // Height in pixels
+    int16_t cursorX;            // Position of the next character
+    int16_t cursorY;
+    uint16_t textColor;         // Foreground of the next character
+    uint16_t textBackground;    // Same as textColor for a transparent background
+    uint8_t textSize;           // Scale factor of the next character
+    bool wrap;                  // Continue on the next line at the right edge
+};
+
+/**
+ * @brief 1 bit per pixel offscreen canvas
+ */
+class GFXcanvas1 : public Adafruit_GFX {
+public:
+    /**
+     * @brief Constructor, the canvas starts cleared
+     * @param w Width in pixels
+     * @param h Height in pixels
+     */
+    GFXcanvas1(uint16_t w, uint16_t h);
+
+    ~GFXcanvas1();
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void fillScreen(uint16_t color) override;
+
+    /**
+     * @brief Read back a pixel
+     * @param x X-position
+     * @param y Y-position
+     * @return True if set, false if clear or outside the canvas
+     */
+    bool getPixel(int16_t x, int16_t y) const;
+
+private:
+    uint8_t* buffer;            // Rows padded to whole bytes, MSB first
+
+    GFXcanvas1(const GFXcanvas1&) = delete;
+    GFXcanvas1& operator=(const GFXcanvas1&) = delete;
+};
+
+#endif // HOST_ADAFRUIT_GFX_H
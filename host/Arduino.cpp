@@ -0,0 +1,191 @@
+#include "Arduino.h"
+#include <chrono>
+#include <thread>
+#include "clock.h"
+
+// Serial port instance
+HardwareSerial Serial;
+
+// Arduino's random() state, xorshift so runs do not depend on the C library
+static uint32_t randomState = 1;
+
+/**
+ * @brief Milliseconds since start on the active clock
+ * @return Time in milliseconds
+ */
+unsigned long millis() {
+    return clockMillis();
+}
+
+/**
+ * @brief Microseconds since start on the active clock
+ * @return Time in microseconds
+ */
+unsigned long micros() {
+    return (unsigned long)clockMicros();
+}
+
+/**
+ * @brief Wait on the active clock, a virtual clock just advances
+ * @param ms Milliseconds to wait
+ */
+void delay(unsigned long ms) {
+    clockSleepMicros((uint64_t)ms * 1000);
+}
+
+/**
+ * @brief Next number of the xorshift32 sequence
+ * @return Random 32-bit value
+ */
+static uint32_t nextRandom() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+/**
+ * @brief Random number in [0, howBig)
+ * @param howBig Upper bound, exclusive
+ * @return Random number, 0 if howBig is 0
+ */
+long random(long howBig) {
+    if (howBig <= 0) {
+        return 0;
+    }
+    return nextRandom() % howBig;
+}
+
+/**
+ * @brief Random number in [howSmall, howBig)
+ * @param howSmall Lower bound, inclusive
+ * @param howBig Upper bound, exclusive
+ * @return Random number, howSmall if the range is empty
+ */
+long random(long howSmall, long howBig) {
+    if (howSmall >= howBig) {
+        return howSmall;
+    }
+    return random(howBig - howSmall) + howSmall;
+}
+
+/**
+ * @brief Restart the random sequence
+ * @param seed Seed, the same seed gives the same sequence
+ */
+void randomSeed(unsigned long seed) {
+    // Zero would lock xorshift at zero
+    randomState = seed != 0 ? (uint32_t)seed : 1;
+}
+
+/**
+ * @brief Write one byte to stdout
+ * @param c Byte to write
+ * @return Bytes written
+ */
+size_t HardwareSerial::write(uint8_t c) {
+    return fwrite(&c, 1, 1, stdout);
+}
+
+/**
+ * @brief Write bytes to stdout, flushed so piped output is not delayed
+ * @param buffer Bytes to write
+ * @param size Number of bytes
+ * @return Bytes written
+ */
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    size_t written = fwrite(buffer, 1, size, stdout);
+    fflush(stdout);
+    return written;
+}
+
+/**
+ * @brief Write a string to stdout
+ * @param text Null terminated string
+ * @return Bytes written
+ */
+size_t HardwareSerial::print(const char* text) {
+    return fputs(text, stdout) < 0 ? 0 : strlen(text);
+}
+
+/**
+ * @brief Write a string and a line break to stdout
+ * @param text Null terminated string
+ * @return Bytes written
+ */
+size_t HardwareSerial::println(const char* text) {
+    return print(text) + print("\n");
+}
+
+/**
+ * @brief Write formatted text to stdout
+ * @param format printf format
+ * @return Bytes written
+ */
+int HardwareSerial::printf(const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vprintf(format, arguments);
+    va_end(arguments);
+    return length;
+}
+
+/**
+ * @brief Write out everything buffered for stdout
+ */
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+/**
+ * @brief Start a thread running the task function, core and priority are ignored
+ * @return pdPASS
+ */
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackSize,
+                                   void* parameter, int priority, TaskHandle_t* handle, int core) {
+    std::thread(function, parameter).detach();
+    if (handle != nullptr) {
+        *handle = nullptr;
+    }
+    return pdPASS;
+}
+
+/**
+ * @brief End the calling thread, only nullptr (the calling task) is supported
+ * @param task Must be nullptr
+ */
+void vTaskDelete(TaskHandle_t task) {
+    // Tasks never return, park the thread until the process exits
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::hours(1));
+    }
+}
+
+/**
+ * @brief Sleep the calling thread
+ * @param ticks Milliseconds to sleep
+ */
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+/**
+ * @brief Current time of the active clock in ticks
+ * @return Time in milliseconds
+ */
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)clockMillis();
+}
+
+/**
+ * @brief Wait on the active clock until the next period
+ * @param previousWakeTime Time of the last wake up, advanced by period
+ * @param period Period in milliseconds
+ */
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t period) {
+    *previousWakeTime += period;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previousWakeTime - now) > 0) {
+        delay(*previousWakeTime - now);
+    }
+}
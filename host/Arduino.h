@@ -0,0 +1,127 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/**
+ * Stand-in for the parts of the Arduino core and FreeRTOS used by the
+ * rendering and counter code, for the native PlatformIO environment.
+ *
+ * Time comes from the active clock, see clock.h. Host programs install a
+ * VirtualClock, then millis() and micros() only move when the program
+ * advances it or calls delay(), so frames render as fast as the CPU
+ * allows while animations see the same timing as on the device.
+ * random() is a seeded generator, runs are reproducible.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+/**
+ * @brief Milliseconds since start on the active clock
+ * @return Time in milliseconds
+ */
+unsigned long millis();
+
+/**
+ * @brief Microseconds since start on the active clock
+ * @return Time in microseconds
+ */
+unsigned long micros();
+
+/**
+ * @brief Wait on the active clock, a virtual clock just advances
+ * @param ms Milliseconds to wait
+ */
+void delay(unsigned long ms);
+
+/**
+ * @brief Random number in [0, howBig)
+ * @param howBig Upper bound, exclusive
+ * @return Random number, 0 if howBig is 0
+ */
+long random(long howBig);
+
+/**
+ * @brief Random number in [howSmall, howBig)
+ * @param howSmall Lower bound, inclusive
+ * @param howBig Upper bound, exclusive
+ * @return Random number, howSmall if the range is empty
+ */
+long random(long howSmall, long howBig);
+
+/**
+ * @brief Restart the random sequence
+ * @param seed Seed, the same seed gives the same sequence
+ */
+void randomSeed(unsigned long seed);
+
+/**
+ * @brief Serial port writing to stdout
+ */
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) {
+    }
+
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t print(const char* text);
+    size_t println(const char* text = "");
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    void flush();
+};
+
+extern HardwareSerial Serial;
+
+// FreeRTOS, tasks run as threads and delays sleep in real time
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdPASS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+/**
+ * @brief Start a thread running the task function, core and priority are ignored
+ * @return pdPASS
+ */
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackSize,
+                                   void* parameter, int priority, TaskHandle_t* handle, int core);
+
+/**
+ * @brief End the calling thread, only nullptr (the calling task) is supported
+ * @param task Must be nullptr
+ */
+void vTaskDelete(TaskHandle_t task);
+
+/**
+ * @brief Sleep the calling thread
+ * @param ticks Milliseconds to sleep
+ */
+void vTaskDelay(TickType_t ticks);
+
+/**
+ * @brief Current time of the active clock in ticks
+ * @return Time in milliseconds
+ */
+TickType_t xTaskGetTickCount();
+
+/**
+ * @brief Wait on the active clock until the next period
+ * @param previousWakeTime Time of the last wake up, advanced by period
+ * @param period Period in milliseconds
+ */
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t period);
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,76 @@
+#include "ESP32-HUB75-MatrixPanel-I2S-DMA.h"
+#include <algorithm>
+
+/**
+ * @brief Constructor
+ * @param config Panel size and chain length, everything else is ignored
+ */
+MatrixPanel_I2S_DMA::MatrixPanel_I2S_DMA(const HUB75_I2S_CFG& config) :
+    Adafruit_GFX(config.mx_width * config.chain_length, config.mx_height),
+    framebuffer(nullptr),
+    brightness(128) {
+}
+
+/**
+ * @brief Destructor
+ */
+MatrixPanel_I2S_DMA::~MatrixPanel_I2S_DMA() {
+    delete[] framebuffer;
+}
+
+/**
+ * @brief Allocate the framebuffer, cleared to black
+ * @return True
+ */
+bool MatrixPanel_I2S_DMA::begin() {
+    if (framebuffer == nullptr) {
+        framebuffer = new uint16_t[displayWidth * displayHeight]();
+    }
+    return true;
+}
+
+/**
+ * @brief Set one pixel, ignored outside the panel or before begin()
+ * @param x X-position
+ * @param y Y-position
+ * @param color RGB565 color
+ */
+void MatrixPanel_I2S_DMA::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (framebuffer == nullptr || x < 0 || y < 0 || x >= displayWidth || y >= displayHeight) {
+        return;
+    }
+    framebuffer[y * displayWidth + x] = color;
+}
+
+/**
+ * @brief Fill a rectangle, clipped to the panel
+ * @param x X-position of the top left corner
+ * @param y Y-position of the top left corner
+ * @param w Width
+ * @param h Height
+ * @param color RGB565 color
+ */
+void MatrixPanel_I2S_DMA::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (framebuffer == nullptr) {
+        return;
+    }
+
+    int16_t x0 = std::max<int16_t>(x, 0);
+    int16_t y0 = std::max<int16_t>(y, 0);
+    int16_t x1 = std::min<int16_t>(x + w, displayWidth);
+    int16_t y1 = std::min<int16_t>(y + h, displayHeight);
+    for (int16_t row = y0; row < y1; row++) {
+        uint16_t* pixel = &framebuffer[row * displayWidth];
+        for (int16_t col = x0; col < x1; col++) {
+            pixel[col] = color;
+        }
+    }
+}
+
+/**
+ * @brief Fill the whole panel
+ * @param color RGB565 color
+ */
+void MatrixPanel_I2S_DMA::fillScreen(uint16_t color) {
+    fillRect(0, 0, displayWidth, displayHeight, color);
+}
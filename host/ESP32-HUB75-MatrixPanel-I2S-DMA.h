@@ -0,0 +1,89 @@
+#ifndef HOST_MATRIX_PANEL_H
+#define HOST_MATRIX_PANEL_H
+
+#include <stdint.h>
+#include "Adafruit_GFX.h"
+
+/**
+ * @brief Stand-in for the HUB75 panel configuration, pins are ignored
+ */
+struct HUB75_I2S_CFG {
+    enum shift_driver { SHIFTREG = 0, FM6124, FM6126A, ICN2038S, MBI5124, SM5266P };
+
+    struct i2s_pins {
+        int8_t r1, g1, b1, r2, g2, b2, a, b, c, d, e, lat, oe, clk;
+    };
+
+    uint16_t mx_width;          // Width of one panel
+    uint16_t mx_height;         // Height of one panel
+    uint16_t chain_length;      // Panels side by side
+    i2s_pins gpio;              // Pin assignment
+    shift_driver driver;        // Shift register chip
+    bool clkphase;              // Latch on the falling clock edge
+
+    HUB75_I2S_CFG(uint16_t width = 64, uint16_t height = 32, uint16_t chain = 1,
+                  i2s_pins pins = {25, 26, 27, 14, 12, 13, 23, 19, 5, 17, -1, 4, 15, 16}) :
+        mx_width(width),
+        mx_height(height),
+        chain_length(chain),
+        gpio(pins),
+        driver(SHIFTREG),
+        clkphase(true) {
+    }
+};
+
+/**
+ * @brief Stand-in for the HUB75 DMA driver, renders into an RGB565 framebuffer
+ *
+ * Host builds only. The framebuffer holds exactly what drawPixel() and
+ * fillRect() wrote, without the colour depth reduction of the real panel.
+ */
+class MatrixPanel_I2S_DMA : public Adafruit_GFX {
+public:
+    /**
+     * @brief Constructor
+     * @param config Panel size and chain length, everything else is ignored
+     */
+    explicit MatrixPanel_I2S_DMA(const HUB75_I2S_CFG& config);
+
+    ~MatrixPanel_I2S_DMA();
+
+    /**
+     * @brief Allocate the framebuffer, cleared to black
+     * @return True
+     */
+    bool begin();
+
+    void setBrightness8(uint8_t value) {
+        brightness = value;
+    }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void fillScreen(uint16_t color) override;
+
+    void clearScreen() {
+        fillScreen(0);
+    }
+
+    uint16_t color565(uint8_t r, uint8_t g, uint8_t b) {
+        return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+    }
+
+    /**
+     * @brief Get the framebuffer, host builds only
+     * @return width() * height() RGB565 pixels, row by row, nullptr before begin()
+     */
+    const uint16_t* getFramebuffer() const {
+        return framebuffer;
+    }
+
+private:
+    uint16_t* framebuffer;      // Row by row, allocated by begin()
+    uint8_t brightness;         // Last value passed to setBrightness8()
+
+    MatrixPanel_I2S_DMA(const MatrixPanel_I2S_DMA&) = delete;
+    MatrixPanel_I2S_DMA& operator=(const MatrixPanel_I2S_DMA&) = delete;
+};
+
+#endif // HOST_MATRIX_PANEL_H
@@ -0,0 +1,70 @@
+#include "Preferences.h"
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// All namespaces, keyed by "namespace/key"
+static std::map<std::string, std::vector<uint8_t>> storage;
+static std::mutex storageMutex;
+
+/**
+ * @brief Open a namespace
+ * @param name Namespace name
+ * @param readOnly Refuse writes while open
+ * @return True
+ */
+bool Preferences::begin(const char* name, bool readOnly) {
+    snprintf(space, sizeof(space), "%s", name);
+    this->readOnly = readOnly;
+    return true;
+}
+
+/**
+ * @brief Read a blob
+ * @param key Key in the open namespace
+ * @param buffer Destination
+ * @param length Size of the destination
+ * @return Bytes read, 0 if the key is missing or the blob does not fit
+ */
+size_t Preferences::getBytes(const char* key, void* buffer, size_t length) {
+    std::lock_guard<std::mutex> lock(storageMutex);
+    auto entry = storage.find(std::string(space) + "/" + key);
+    if (entry == storage.end() || entry->second.size() > length) {
+        return 0;
+    }
+    memcpy(buffer, entry->second.data(), entry->second.size());
+    return entry->second.size();
+}
+
+/**
+ * @brief Write a blob
+ * @param key Key in the open namespace
+ * @param buffer Source
+ * @param length Bytes to write
+ * @return Bytes written, 0 if opened read-only
+ */
+size_t Preferences::putBytes(const char* key, const void* buffer, size_t length) {
+    if (readOnly) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(storageMutex);
+    const uint8_t* bytes = static_cast<const uint8_t*>(buffer);
+    storage[std::string(space) + "/" + key].assign(bytes, bytes + length);
+    return length;
+}
+
+/**
+ * @brief Delete a key
+ * @param key Key in the open namespace
+ * @return True if the key existed
+ */
+bool Preferences::remove(const char* key) {
+    if (readOnly) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(storageMutex);
+    return storage.erase(std::string(space) + "/" + key) > 0;
+}
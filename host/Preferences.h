@@ -0,0 +1,53 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Stand-in for the NVS key-value store, kept in memory for the lifetime of the process
+ */
+class Preferences {
+public:
+    /**
+     * @brief Open a namespace
+     * @param name Namespace name
+     * @param readOnly Refuse writes while open
+     * @return True
+     */
+    bool begin(const char* name, bool readOnly = false);
+
+    void end() {
+    }
+
+    /**
+     * @brief Read a blob
+     * @param key Key in the open namespace
+     * @param buffer Destination
+     * @param length Size of the destination
+     * @return Bytes read, 0 if the key is missing or the blob does not fit
+     */
+    size_t getBytes(const char* key, void* buffer, size_t length);
+
+    /**
+     * @brief Write a blob
+     * @param key Key in the open namespace
+     * @param buffer Source
+     * @param length Bytes to write
+     * @return Bytes written, 0 if opened read-only
+     */
+    size_t putBytes(const char* key, const void* buffer, size_t length);
+
+    /**
+     * @brief Delete a key
+     * @param key Key in the open namespace
+     * @return True if the key existed
+     */
+    bool remove(const char* key);
+
+private:
+    char space[16];             // Open namespace, NVS limits names to 15 characters
+    bool readOnly;              // Opened for reading only
+};
+
+#endif // HOST_PREFERENCES_H
@@ -0,0 +1,4 @@
+#include "WiFi.h"
+
+// WiFi station instance
+WiFiClass WiFi;
@@ -0,0 +1,39 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <stdint.h>
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+/**
+ * @brief Stand-in for the WiFi station, only reports a status set by the host program
+ */
+class WiFiClass {
+public:
+    wl_status_t status() const {
+        return currentStatus;
+    }
+
+    /**
+     * @brief Set the status reported from now on, host builds only
+     * @param status New connection status
+     */
+    void setStatus(wl_status_t status) {
+        currentStatus = status;
+    }
+
+private:
+    volatile wl_status_t currentStatus = WL_DISCONNECTED;
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
@@ -0,0 +1,200 @@
+#include <Arduino.h>
+#include <vector>
+#include "clock.h"
+#include "fnv1a.h"
+#include "matrix_config.h"
+#include "animations/animation_benchmark.h"
+
+#define LOG_TAG "benchmark"
+#include "logger.h"
+
+// Golden frame hashes, one line per frame: style name, frame index, hash in hex
+#define BENCHMARK_GOLDEN_FILE "host/golden_frames.txt"
+
+// Frame hashes of the current run, indexed by style and frame
+static std::vector<uint32_t> frameHashes[STYLE_COUNT];
+
+// Time of the animations, advanced one frame interval per frame
+static VirtualClock virtualClock;
+
+/**
+ * @brief Hash the framebuffer with FNV-1a
+ * @return Hash of all pixels, never 0
+ */
+static uint32_t hashFramebuffer() {
+    // Pixels are hashed low byte first as they lie in memory on a little-endian host
+    size_t length = matrix->width() * matrix->height() * sizeof(uint16_t);
+    uint32_t hash = fnv1a(FNV1A_SEED, matrix->getFramebuffer(), length);
+    return hash != 0 ? hash : 1;
+}
+
+/**
+ * @brief Record the frame and advance virtual time by one frame interval
+ * @param style Style being benchmarked
+ * @param frame Index of the frame just drawn
+ * @return Hash of the frame
+ */
+static uint32_t recordFrame(AnimationStyle style, uint32_t frame) {
+    uint32_t hash = hashFramebuffer();
+    frameHashes[style].push_back(hash);
+    virtualClock.advanceMillis(ANIMATION_BENCHMARK_INTERVAL);
+    return hash;
+}
+
+/**
+ * @brief Find a style by name
+ * @param name Name returned by AnimationManager::getStyleName()
+ * @return Style, STYLE_COUNT if unknown
+ */
+static AnimationStyle styleFromName(const char* name) {
+    for (int i = 0; i < STYLE_COUNT; i++) {
+        if (strcmp(AnimationManager::getStyleName(static_cast<AnimationStyle>(i)), name) == 0) {
+            return static_cast<AnimationStyle>(i);
+        }
+    }
+    return STYLE_COUNT;
+}
+
+/**
+ * @brief Read the golden hashes
+ * @param path Golden file
+ * @param golden Filled with the hashes, indexed by style and frame
+ * @return False if the file cannot be read
+ */
+static bool readGolden(const char* path, std::vector<uint32_t> golden[STYLE_COUNT]) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        return false;
+    }
+
+    char line[96];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        char name[32];
+        unsigned long frame;
+        unsigned long hash;
+        if (line[0] == '#' || sscanf(line, "%31s %lu %lx", name, &frame, &hash) != 3) {
+            continue;
+        }
+        AnimationStyle style = styleFromName(name);
+        if (style == STYLE_COUNT) {
+            continue;
+        }
+        if (golden[style].size() <= frame) {
+            golden[style].resize(frame + 1, 0);
+        }
+        golden[style][frame] = hash;
+    }
+    fclose(file);
+    return true;
+}
+
+/**
+ * @brief Write the hashes of this run as the new golden set
+ * @param path Golden file
+ * @return False if the file cannot be written
+ */
+static bool writeGolden(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    fprintf(file, "# Frame hashes of the animation benchmark, regenerate with: program --update\n");
+    for (int i = 0; i < STYLE_COUNT; i++) {
+        const char* name = AnimationManager::getStyleName(static_cast<AnimationStyle>(i));
+        for (size_t frame = 0; frame < frameHashes[i].size(); frame++) {
+            fprintf(file, "%s %u %08lx\n", name, (unsigned)frame, (unsigned long)frameHashes[i][frame]);
+        }
+    }
+    return fclose(file) == 0;
+}
+
+/**
+ * @brief Compare the frames of one style with the golden set
+ * @param style Benchmarked style
+ * @param golden Golden hashes of the style
+ * @return True if every frame matches
+ */
+static bool checkGolden(AnimationStyle style, const std::vector<uint32_t>& golden) {
+    const std::vector<uint32_t>& hashes = frameHashes[style];
+    uint32_t mismatches = 0;
+    size_t firstMismatch = 0;
+    for (size_t frame = 0; frame < hashes.size(); frame++) {
+        if (frame >= golden.size() || golden[frame] != hashes[frame]) {
+            if (mismatches == 0) {
+                firstMismatch = frame;
+            }
+            mismatches++;
+        }
+    }
+
+    if (mismatches > 0) {
+        LOG_ERROR("%s: %lu of %lu frames differ from the golden set, first at frame %lu",
+                  AnimationManager::getStyleName(style), (unsigned long)mismatches,
+                  (unsigned long)hashes.size(), (unsigned long)firstMismatch);
+    }
+    return mismatches == 0;
+}
+
+/**
+ * @brief Benchmark every animation style on the stand-in panel
+ *
+ * Usage: program [--update] [frames] [golden_file]
+ *
+ * Every frame is hashed and compared with the golden set, the exit code
+ * is 1 if any frame differs. --update writes the golden set instead,
+ * only do that when a change to the visuals is intended.
+ */
+int main(int argc, char** argv) {
+    bool update = false;
+    uint32_t frames = ANIMATION_BENCHMARK_FRAMES;
+    const char* goldenPath = BENCHMARK_GOLDEN_FILE;
+    int position = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else if (position++ == 0) {
+            frames = strtoul(argv[i], nullptr, 10);
+        } else {
+            goldenPath = argv[i];
+        }
+    }
+
+    setClock(&virtualClock);
+    Serial.begin(115200);
+    initLogging();
+    initMatrix();
+
+    std::vector<uint32_t> golden[STYLE_COUNT];
+    bool haveGolden = !update && readGolden(goldenPath, golden);
+    if (!update && !haveGolden) {
+        LOG_WARN("No golden set at %s, run with --update to create it", goldenPath);
+    }
+
+    bool passed = haveGolden || update;
+    for (int i = 0; i < STYLE_COUNT; i++) {
+        AnimationStyle style = static_cast<AnimationStyle>(i);
+        AnimationBenchmarkResult result;
+        if (!runAnimationBenchmark(style, frames, recordFrame, result)) {
+            continue;
+        }
+        logAnimationBenchmark(style, result);
+        if (haveGolden && !checkGolden(style, golden[style])) {
+            passed = false;
+        }
+    }
+
+    if (update) {
+        if (writeGolden(goldenPath)) {
+            LOG_INFO("Golden set written to %s", goldenPath);
+        } else {
+            LOG_ERROR("Failed to write %s", goldenPath);
+            passed = false;
+        }
+    } else if (haveGolden && passed) {
+        LOG_INFO("All frames match the golden set");
+    }
+
+    flushLogging();
+    return passed ? 0 : 1;
+}
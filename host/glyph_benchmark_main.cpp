@@ -0,0 +1,142 @@
+#include <Arduino.h>
+#include <vector>
+#include "clock.h"
+#include "matrix_config.h"
+#include "glyph_cache.h"
+
+#define LOG_TAG "glyph_bench"
+#include "logger.h"
+
+// Benchmark configuration
+#define GLYPH_BENCHMARK_ROUNDS 2000     // Draws per digit, text size and renderer
+#define GLYPH_BENCHMARK_X 2             // Position of the timed draws, fully on the panel
+#define GLYPH_BENCHMARK_Y 2
+#define GLYPH_BENCHMARK_STEP_X 3        // Grid of the compared positions, includes every panel edge
+#define GLYPH_BENCHMARK_STEP_Y 2
+#define GLYPH_BENCHMARK_COLOR 0xFD20    // Any color but black
+
+/**
+ * @brief Draw a digit through the GFX font renderer, the path blitGlyph() replaces
+ * @param digit Digit character
+ * @param x X-position
+ * @param y Y-position
+ * @param textSize Size of the text
+ */
+static void printDigit(char digit, int16_t x, int16_t y, uint8_t textSize) {
+    char text[2] = {digit, '\0'};
+    matrix->setCursor(x, y);
+    matrix->setTextColor(GLYPH_BENCHMARK_COLOR);
+    matrix->setTextSize(textSize);
+    matrix->print(text);
+}
+
+/**
+ * @brief Draw a digit from the glyph cache
+ * @param digit Digit character
+ * @param x X-position
+ * @param y Y-position
+ * @param textSize Size of the text
+ */
+static void blitDigit(char digit, int16_t x, int16_t y, uint8_t textSize) {
+    blitGlyph(glyphCache.getDigitRows(digit, textSize), x, y, textSize, GLYPH_BENCHMARK_COLOR);
+}
+
+/**
+ * @brief Draw a digit on a cleared panel and keep the pixels
+ * @param draw Renderer to use
+ * @param digit Digit character
+ * @param x X-position
+ * @param y Y-position
+ * @param textSize Size of the text
+ * @param pixels Filled with the framebuffer
+ */
+static void renderDigit(void (*draw)(char, int16_t, int16_t, uint8_t), char digit, int16_t x, int16_t y,
+                        uint8_t textSize, std::vector<uint16_t>& pixels) {
+    matrix->fillScreen(0);
+    draw(digit, x, y, textSize);
+    const uint16_t* framebuffer = matrix->getFramebuffer();
+    pixels.assign(framebuffer, framebuffer + matrix->width() * matrix->height());
+}
+
+/**
+ * @brief Compare both renderers at every position of a grid around the panel
+ * @param digit Digit character
+ * @param textSize Size of the text
+ * @return False if any pixel differs
+ */
+static bool compareDigit(char digit, uint8_t textSize) {
+    std::vector<uint16_t> printed;
+    std::vector<uint16_t> blitted;
+    int16_t width = GLYPH_BASE_WIDTH * textSize;
+    int16_t height = GLYPH_BASE_HEIGHT * textSize;
+
+    for (int16_t y = -height; y <= PANE_HEIGHT; y += GLYPH_BENCHMARK_STEP_Y) {
+        for (int16_t x = -width; x <= PANE_WIDTH; x += GLYPH_BENCHMARK_STEP_X) {
+            renderDigit(printDigit, digit, x, y, textSize, printed);
+            renderDigit(blitDigit, digit, x, y, textSize, blitted);
+            if (printed != blitted) {
+                LOG_ERROR("Digit %c at size %u differs at %d,%d", digit, textSize, x, y);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Time one renderer
+ * @param draw Renderer to use
+ * @param digit Digit character
+ * @param textSize Size of the text
+ * @return Average time per draw in nanoseconds
+ */
+static double timeDigit(void (*draw)(char, int16_t, int16_t, uint8_t), char digit, uint8_t textSize) {
+    uint64_t start = clockMicros();
+    for (int i = 0; i < GLYPH_BENCHMARK_ROUNDS; i++) {
+        draw(digit, GLYPH_BENCHMARK_X, GLYPH_BENCHMARK_Y, textSize);
+    }
+    return (clockMicros() - start) * 1000.0 / GLYPH_BENCHMARK_ROUNDS;
+}
+
+/**
+ * @brief Time blitGlyph() against matrix->print() on the stand-in panel
+ *
+ * Every digit is drawn at every cached text size by both renderers, on
+ * and across every panel edge, and the framebuffers have to match pixel
+ * for pixel. Then both are timed per digit and text size. The exit code
+ * is 1 if any pixel differs.
+ */
+int main(int argc, char** argv) {
+    Serial.begin(115200);
+    initLogging();
+    initMatrix();
+    // The firmware draws without wrapping, a wrapped digit would jump to the next line
+    matrix->setTextWrap(false);
+
+    bool passed = true;
+    for (uint8_t textSize = 1; textSize <= GLYPH_CACHE_MAX_TEXT_SIZE; textSize++) {
+        double printTotal = 0;
+        double blitTotal = 0;
+        for (char digit = '0'; digit <= '9'; digit++) {
+            passed &= compareDigit(digit, textSize);
+
+            // Warm the cache so its one-time rasterization is not timed
+            blitDigit(digit, GLYPH_BENCHMARK_X, GLYPH_BENCHMARK_Y, textSize);
+            double printTime = timeDigit(printDigit, digit, textSize);
+            double blitTime = timeDigit(blitDigit, digit, textSize);
+            printTotal += printTime;
+            blitTotal += blitTime;
+            LOG_INFO("Size %u digit %c: print %.0f ns, blit %.0f ns, %.1fx", textSize, digit,
+                     printTime, blitTime, printTime / blitTime);
+        }
+        LOG_INFO("Size %u average: print %.0f ns, blit %.0f ns, %.1fx", textSize,
+                 printTotal / 10, blitTotal / 10, printTotal / blitTotal);
+    }
+
+    if (passed) {
+        LOG_INFO("blitGlyph() matches matrix->print() for every digit and size");
+    }
+
+    flushLogging();
+    return passed ? 0 : 1;
+}
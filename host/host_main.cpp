@@ -0,0 +1,90 @@
+#include <Arduino.h>
+#include <chrono>
+#include <thread>
+#include "clock.h"
+#include "matrix_config.h"
+#include "animations/animation_manager.h"
+
+#define LOG_TAG "host"
+#include "logger.h"
+
+// Host run configuration
+#define HOST_FRAME_INTERVAL 100        // Virtual time per frame, matches REFRESH_INTERVAL in main.h
+#define HOST_DEFAULT_FRAMES 10000      // Frames rendered when none are given
+#define HOST_COUNTER_START 12345       // First counter value shown
+#define HOST_COUNTER_STEP_FRAMES 50    // Frames between counter increments
+
+// Global animation manager instance, main.cpp is not part of host builds
+AnimationManager animationManager;
+
+// Time of the animations, advanced one frame interval per frame
+static VirtualClock virtualClock;
+
+/**
+ * @brief Write the framebuffer as a binary PPM image
+ * @param path Output file
+ * @return True if the file was written
+ */
+static bool writeFramePpm(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    const uint16_t* pixels = matrix->getFramebuffer();
+    fprintf(file, "P6\n%d %d\n255\n", matrix->width(), matrix->height());
+    for (int i = 0; i < matrix->width() * matrix->height(); i++) {
+        uint16_t color = pixels[i];
+        uint8_t rgb[3] = {
+            (uint8_t)(((color >> 11) & 0x1F) * 255 / 31),
+            (uint8_t)(((color >> 5) & 0x3F) * 255 / 63),
+            (uint8_t)((color & 0x1F) * 255 / 31)
+        };
+        fwrite(rgb, 1, sizeof(rgb), file);
+    }
+    return fclose(file) == 0;
+}
+
+/**
+ * @brief Render frames as fast as possible on the stand-in panel
+ *
+ * Usage: program [frames] [last_frame.ppm]
+ *
+ * Virtual time advances by one frame interval per frame, so animations
+ * run through the same states as on the device. The wall clock rate is
+ * what matters for profiling, e.g. with perf record.
+ */
+int main(int argc, char** argv) {
+    unsigned long frames = argc > 1 ? strtoul(argv[1], nullptr, 10) : HOST_DEFAULT_FRAMES;
+    const char* imagePath = argc > 2 ? argv[2] : nullptr;
+
+    setClock(&virtualClock);
+    Serial.begin(115200);
+    initLogging();
+    initMatrix();
+    animationManager.init();
+
+    unsigned long counter = HOST_COUNTER_START;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long frame = 0; frame < frames; frame++) {
+        if (frame % HOST_COUNTER_STEP_FRAMES == 0) {
+            counter++;
+        }
+        animationManager.update(counter);
+        updateStatusIndicator(true, true, false);
+        virtualClock.advanceMillis(HOST_FRAME_INTERVAL);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LOG_INFO("Rendered %lu frames in %.3f s, %.0f frames/s", frames, seconds, seconds > 0 ? frames / seconds : 0.0);
+    if (imagePath != nullptr) {
+        if (writeFramePpm(imagePath)) {
+            LOG_INFO("Last frame written to %s", imagePath);
+        } else {
+            LOG_ERROR("Failed to write %s", imagePath);
+        }
+    }
+
+    flushLogging();
+    return 0;
+}
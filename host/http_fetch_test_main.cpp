@@ -0,0 +1,519 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "clock.h"
+#include "counter.h"
+#include "http_fetch.h"
+#include "metrics_json_scanner.h"
+
+#define LOG_TAG "fetch_test"
+#include "logger.h"
+
+// Test configuration
+#define TEST_PORT 18081                     // Stand-in server
+#define TEST_CLOSED_PORT 18082              // Bound but not listening, connects are refused
+#define TEST_STEP 1                         // Virtual milliseconds per poll() call
+#define TEST_REQUEST_TIMEOUT 10000          // Request timeout of the cases that get an answer
+#define TEST_HANG_TIMEOUT 300               // Request timeout of the case that gets none
+#define TEST_REQUEST_MAX 1024               // Longest request headers
+#define TEST_REQUESTS_MAX 3                 // Requests per case
+
+/**
+ * @brief How the stand-in server answers a request
+ */
+enum TestReply {
+    REPLY_LENGTH,           // Body delimited by Content-Length
+    REPLY_CHUNKED,          // Chunked body with extensions and a trailer, sent in pieces
+    REPLY_VALIDATORS,       // Metrics body with ETag and Last-Modified
+    REPLY_LAST_MODIFIED,    // Metrics body with Last-Modified only
+    REPLY_NOT_MODIFIED,     // 304 without body
+    REPLY_EARLY_HINTS,      // Interim 103 and 100 responses before REPLY_LENGTH, sent in pieces
+    REPLY_DROP_ONCE,        // Connection closed after the request, the retry gets REPLY_LENGTH
+    REPLY_NONE              // Request is never answered
+};
+
+/**
+ * @brief One request of a case and its expected result
+ */
+struct TestRequest {
+    TestReply reply;            // Server behaviour
+    int expectedCode;           // Status code or HTTP_FETCH_ERROR_* code
+    const char* expectedBody;   // Body of a successful request, nullptr if not checked
+    const char* expectedHeader; // Header line the request has to carry, nullptr if not checked
+    bool closeIdle;             // Server closes the kept-alive connection before the request
+};
+
+/**
+ * @brief Requests made in order with one HttpFetch against the stand-in server
+ *
+ * The validators of every 200 response are used for the following
+ * requests, as the counter does after a valid body.
+ */
+struct TestCase {
+    const char* name;                           // Case name for the log
+    const char* url;                            // URL passed to HttpFetch::begin()
+    unsigned long timeout;                      // Request timeout in milliseconds
+    size_t requestCount;                        // Requests in the case
+    TestRequest requests[TEST_REQUESTS_MAX];    // Requests in order
+    uint32_t expectedAccepts;                   // Connections the server accepts
+    uint32_t expectedReuses;                    // Requests sent on a kept-alive connection
+    uint32_t expectedReconnects;                // Kept-alive connections the client reopens
+};
+
+// Body of every successful case
+static const char TEST_BODY[] = "Wikipedia in\r\n\r\nchunks.";
+
+// Response with Content-Length
+static const char LENGTH_RESPONSE[] =
+    "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 23\r\n\r\nWikipedia in\r\n\r\nchunks.";
+
+// Metrics body of the conditional requests, the counter check parses it
+static const char METRICS_BODY[] = "{\"username\": \"test\", \"followers_count\": 12345, "
+                                   "\"last_updated\": \"2026-01-01 12:00:00\"}";
+
+// Validators of the metrics body
+#define TEST_ETAG "\"v1\""
+#define TEST_LAST_MODIFIED "Thu, 01 Jan 2026 12:00:00 GMT"
+
+// Metrics response with both validators, and with the date only
+static char validatorsResponse[512];
+static char lastModifiedResponse[512];
+
+// Not modified, the Content-Length of the unchanged body must not make the client wait for it
+static const char NOT_MODIFIED_RESPONSE[] =
+    "HTTP/1.1 304 Not Modified\r\nETag: " TEST_ETAG "\r\nContent-Length: 85\r\n\r\n";
+
+// Chunked response, split inside the status line, a size line, an extension, a payload and the trailer
+static const char* const CHUNKED_RESPONSE[] = {
+    "HTTP/1.1 2",
+    "00 OK\r\nContent-Type: text/plain\r\nTransfer-Encoding: chunked\r\n\r\n4\r\nWi",
+    "ki\r\n5;name=va",
+    "lue\r\npedia\r\nE",
+    "\r\n in\r\n\r\nchunks.\r",
+    "\n0\r\nExpires: nev",
+    "er\r\n\r\n"
+};
+
+// Interim responses ahead of the final one, split after an interim block and inside the final one
+static const char* const EARLY_HINTS_RESPONSE[] = {
+    "HTTP/1.1 103 Early Hints\r\nLink: </style.css>; rel=preload\r\n\r\n",
+    "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nContent-",
+    "Type: text/plain\r\nContent-Length: 23\r\n\r\nWikipedia in\r\n\r\nchunks."
+};
+
+static const TestCase TEST_CASES[] = {
+    {"resolve", "http://localhost:18081/metrics", TEST_REQUEST_TIMEOUT, 1,
+     {{REPLY_LENGTH, 200, TEST_BODY, nullptr, false}}, 1, 0, 0},
+    {"connect", "http://127.0.0.1:18081/metrics", TEST_REQUEST_TIMEOUT, 1,
+     {{REPLY_LENGTH, 200, TEST_BODY, nullptr, false}}, 1, 0, 0},
+    {"refused", "http://127.0.0.1:18082/metrics", TEST_REQUEST_TIMEOUT, 1,
+     {{REPLY_NONE, HTTP_FETCH_ERROR_CONNECTION_REFUSED, nullptr, nullptr, false}}, 0, 0, 0},
+    {"timeout", "http://127.0.0.1:18081/metrics", TEST_HANG_TIMEOUT, 1,
+     {{REPLY_NONE, HTTP_FETCH_ERROR_READ_TIMEOUT, nullptr, nullptr, false}}, 1, 0, 0},
+    {"chunked", "http://127.0.0.1:18081/metrics", TEST_REQUEST_TIMEOUT, 1,
+     {{REPLY_CHUNKED, 200, TEST_BODY, nullptr, false}}, 1, 0, 0},
+    {"not_modified", "http://127.0.0.1:18081/metrics", TEST_REQUEST_TIMEOUT, 2,
+     {{REPLY_VALIDATORS, 200, METRICS_BODY, nullptr, false},
+      {REPLY_NOT_MODIFIED, 304, "", "If-None-Match: " TEST_ETAG "\r\n", false}}, 1, 1, 0},
+    {"not_modified_since", "http://127.0.0.1:18081/metrics", TEST_REQUEST_TIMEOUT, 2,
+     {{REPLY_LAST_MODIFIED, 200, METRICS_BODY, nullptr, false},
+      {REPLY_NOT_MODIFIED, 304, "", "If-Modified-Since: " TEST_LAST_MODIFIED "\r\n", false}}, 1, 1, 0},
+    {"keep_alive", "http://127.0.0.1:18081/metrics", TEST_REQUEST_TIMEOUT, 2,
+     {{REPLY_LENGTH, 200, TEST_BODY, nullptr, false},
+      {REPLY_LENGTH, 200, TEST_BODY, nullptr, false}}, 1, 1, 0},
+    {"idle_close", "http://127.0.0.1:18081/metrics", TEST_REQUEST_TIMEOUT, 2,
+     {{REPLY_LENGTH, 200, TEST_BODY, nullptr, false},
+      {REPLY_LENGTH, 200, TEST_BODY, nullptr, true}}, 2, 0, 1},
+    {"dropped", "http://127.0.0.1:18081/metrics", TEST_REQUEST_TIMEOUT, 2,
+     {{REPLY_LENGTH, 200, TEST_BODY, nullptr, false},
+      {REPLY_DROP_ONCE, 200, TEST_BODY, nullptr, false}}, 2, 1, 1},
+    {"early_hints", "http://127.0.0.1:18081/metrics", TEST_REQUEST_TIMEOUT, 2,
+     {{REPLY_EARLY_HINTS, 200, TEST_BODY, nullptr, false},
+      {REPLY_LENGTH, 200, TEST_BODY, nullptr, false}}, 1, 1, 0},
+};
+
+/**
+ * @brief Connection of HttpFetch to the stand-in server
+ */
+struct ServerConnection {
+    int fd;                             // Socket, -1 if closed
+    TestReply reply;                    // How the request is answered
+    bool answering;                     // Complete request received
+    size_t piecesSent;                  // Response pieces sent so far
+    size_t length;                      // Bytes in request
+    char request[TEST_REQUEST_MAX];     // Request headers received so far
+};
+
+// Time of the test, advanced one step per poll() call
+static VirtualClock virtualClock;
+
+// Stand-in server
+static int listenSocket = -1;
+static int closedSocket = -1;
+static ServerConnection connection = {-1, REPLY_NONE, false, 0, 0, {0}};
+
+// Headers of the last complete request
+static char lastRequest[TEST_REQUEST_MAX];
+
+// Connections accepted since start
+static uint32_t acceptCount = 0;
+
+// A REPLY_DROP_ONCE request was dropped already
+static bool requestDropped = false;
+
+/**
+ * @brief Open a loopback socket on a port
+ * @param port Port to bind
+ * @param listening Accept connections, otherwise connects are refused
+ * @return Socket, -1 if the port is not available
+ */
+static int bindLoopback(uint16_t port, bool listening) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || (listening && listen(fd, 4) != 0)) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+}
+
+/**
+ * @brief Close the server side of the current connection
+ */
+static void closeConnection() {
+    if (connection.fd >= 0) {
+        close(connection.fd);
+        connection.fd = -1;
+    }
+}
+
+/**
+ * @brief Send the next part of the response
+ * @return False if the connection has to be closed
+ */
+static bool sendResponse() {
+    const char* const* pieces;
+    size_t pieceCount = 1;
+    static const char* const lengthPieces[] = {LENGTH_RESPONSE};
+    static const char* const validatorsPieces[] = {validatorsResponse};
+    static const char* const lastModifiedPieces[] = {lastModifiedResponse};
+    static const char* const notModifiedPieces[] = {NOT_MODIFIED_RESPONSE};
+    if (connection.reply == REPLY_LENGTH) {
+        pieces = lengthPieces;
+    } else if (connection.reply == REPLY_CHUNKED) {
+        pieces = CHUNKED_RESPONSE;
+        pieceCount = sizeof(CHUNKED_RESPONSE) / sizeof(CHUNKED_RESPONSE[0]);
+    } else if (connection.reply == REPLY_VALIDATORS) {
+        pieces = validatorsPieces;
+    } else if (connection.reply == REPLY_LAST_MODIFIED) {
+        pieces = lastModifiedPieces;
+    } else if (connection.reply == REPLY_NOT_MODIFIED) {
+        pieces = notModifiedPieces;
+    } else if (connection.reply == REPLY_EARLY_HINTS) {
+        pieces = EARLY_HINTS_RESPONSE;
+        pieceCount = sizeof(EARLY_HINTS_RESPONSE) / sizeof(EARLY_HINTS_RESPONSE[0]);
+    } else {
+        return true;
+    }
+    const char* piece = pieces[connection.piecesSent];
+
+    // Loopback sockets take a piece of this size in one call
+    ssize_t length = strlen(piece);
+    if (send(connection.fd, piece, length, MSG_NOSIGNAL) != length) {
+        return false;
+    }
+
+    // Read the next request on the same connection once the response is out
+    connection.piecesSent++;
+    if (connection.piecesSent == pieceCount) {
+        connection.answering = false;
+        connection.length = 0;
+    }
+    return true;
+}
+
+/**
+ * @brief Accept the connection, read the request and answer it, never blocks
+ * @param reply How to answer the request
+ */
+static void serviceServer(TestReply reply) {
+    if (connection.fd < 0) {
+        int fd = accept(listenSocket, nullptr, nullptr);
+        if (fd < 0) {
+            return;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        acceptCount++;
+        connection.fd = fd;
+        connection.answering = false;
+        connection.length = 0;
+    }
+
+    // One response piece per call, so HttpFetch sees every split
+    if (connection.answering) {
+        if (!sendResponse()) {
+            closeConnection();
+        }
+        return;
+    }
+
+    ssize_t received = recv(connection.fd, connection.request + connection.length,
+                            sizeof(connection.request) - 1 - connection.length, 0);
+    if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        closeConnection();
+        return;
+    }
+    if (received < 0) {
+        return;
+    }
+    connection.length += received;
+    connection.request[connection.length] = '\0';
+    if (strstr(connection.request, "\r\n\r\n") != nullptr) {
+        memcpy(lastRequest, connection.request, connection.length + 1);
+        if (reply == REPLY_DROP_ONCE && !requestDropped) {
+            requestDropped = true;
+            closeConnection();
+            return;
+        }
+        connection.reply = reply == REPLY_DROP_ONCE ? REPLY_LENGTH : reply;
+        connection.piecesSent = 0;
+        connection.answering = true;
+    }
+}
+
+/**
+ * @brief Poll a request to completion while serving it
+ * @param fetch Started request
+ * @param reply How to answer the request
+ * @param timeout Request timeout in milliseconds
+ */
+static void completeRequest(HttpFetch& fetch, TestReply reply, unsigned long timeout) {
+    // The timeout has to end every request, the limit only guards against a broken one
+    unsigned long limit = timeout / TEST_STEP * 2;
+    for (unsigned long step = 0; step < limit && fetch.poll() != API_REQUEST_COMPLETE; step++) {
+        virtualClock.advanceMillis(TEST_STEP);
+        serviceServer(reply);
+    }
+}
+
+/**
+ * @brief Run one request of a case and check its result
+ * @param test Case the request belongs to
+ * @param index Index of the request in the case
+ * @param fetch Client of the case, idle
+ * @return True if code, body and request headers are as expected
+ */
+static bool runRequest(const TestCase& test, size_t index, HttpFetch& fetch) {
+    const TestRequest& expected = test.requests[index];
+    if (expected.closeIdle) {
+        closeConnection();
+    }
+    lastRequest[0] = '\0';
+    requestDropped = false;
+    fetch.start();
+    completeRequest(fetch, expected.reply, test.timeout);
+
+    if (fetch.getState() != API_REQUEST_COMPLETE) {
+        LOG_ERROR("%s #%u: request did not complete", test.name, (unsigned)index);
+        return false;
+    }
+    if (expected.expectedHeader != nullptr && strstr(lastRequest, expected.expectedHeader) == nullptr) {
+        LOG_ERROR("%s #%u: request without %s", test.name, (unsigned)index, expected.expectedHeader);
+        return false;
+    }
+    if (fetch.getResponseCode() != expected.expectedCode) {
+        LOG_ERROR("%s #%u: code %d, expected %d", test.name, (unsigned)index, fetch.getResponseCode(),
+                  expected.expectedCode);
+        return false;
+    }
+    if (expected.expectedBody != nullptr && (fetch.getBodyLength() != strlen(expected.expectedBody) ||
+                                             strcmp(fetch.getBody(), expected.expectedBody) != 0)) {
+        LOG_ERROR("%s #%u: body \"%s\", expected \"%s\"", test.name, (unsigned)index, fetch.getBody(),
+                  expected.expectedBody);
+        return false;
+    }
+
+    const HttpFetchTiming& timing = fetch.getTiming();
+    LOG_INFO("%s #%u: code %d, resolve %lu us, connect %lu us", test.name, (unsigned)index,
+             fetch.getResponseCode(), (unsigned long)timing.resolve, (unsigned long)timing.connect);
+
+    // Conditional from now on, as the counter does after a valid body
+    if (fetch.getResponseCode() == 200) {
+        fetch.useResponseValidators();
+    }
+    fetch.end();
+    return true;
+}
+
+/**
+ * @brief Run the requests of a case with one client
+ * @param test Case to run
+ * @return True if every request is as expected
+ */
+static bool runCase(const TestCase& test) {
+    HttpFetch fetch;
+    if (!fetch.begin(test.url)) {
+        LOG_ERROR("%s: cannot parse %s", test.name, test.url);
+        return false;
+    }
+    fetch.setTimeout(test.timeout);
+
+    uint32_t acceptsBefore = acceptCount;
+    bool passed = true;
+    for (size_t i = 0; i < test.requestCount && passed; i++) {
+        passed = runRequest(test, i, fetch);
+    }
+    closeConnection();
+    if (!passed) {
+        return false;
+    }
+
+    uint32_t accepts = acceptCount - acceptsBefore;
+    if (accepts != test.expectedAccepts || fetch.getReuseCount() != test.expectedReuses ||
+        fetch.getReconnectCount() != test.expectedReconnects) {
+        LOG_ERROR("%s: %lu accepts, %lu reuses, %lu reconnects, expected %lu, %lu, %lu", test.name,
+                  (unsigned long)accepts, (unsigned long)fetch.getReuseCount(),
+                  (unsigned long)fetch.getReconnectCount(), (unsigned long)test.expectedAccepts,
+                  (unsigned long)test.expectedReuses, (unsigned long)test.expectedReconnects);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Poll the counter's request to completion while serving it
+ * @param reply How to answer the request
+ * @return Result of processAsyncCounterFetch()
+ */
+static bool runCounterFetch(TestReply reply) {
+    lastRequest[0] = '\0';
+    if (!startAsyncCounterFetch()) {
+        return false;
+    }
+    unsigned long limit = TEST_REQUEST_TIMEOUT / TEST_STEP * 2;
+    for (unsigned long step = 0; step < limit && getAPIRequestState() != API_REQUEST_COMPLETE; step++) {
+        virtualClock.advanceMillis(TEST_STEP);
+        serviceServer(reply);
+    }
+    return processAsyncCounterFetch();
+}
+
+/**
+ * @brief Check that a 304 leaves the counter as the previous 200 set it
+ *
+ * The counter module polls COUNTER_API_BASE, which env:native_http_fetch
+ * points at the stand-in server.
+ *
+ * @return True if the counter and its timestamp survive the 304
+ */
+static bool runCounterCase() {
+    initCounter();
+    WiFi.setStatus(WL_CONNECTED);
+
+    if (!runCounterFetch(REPLY_VALIDATORS) || getCounterValue() != 12345) {
+        LOG_ERROR("counter: first poll did not set the counter, it is %lu", getCounterValue());
+        return false;
+    }
+    char lastUpdated[METRICS_TIMESTAMP_MAX];
+    strcpy(lastUpdated, getCounterLastUpdated());
+
+    bool processed = runCounterFetch(REPLY_NOT_MODIFIED);
+    closeConnection();
+    if (strstr(lastRequest, "If-None-Match: " TEST_ETAG "\r\n") == nullptr) {
+        LOG_ERROR("counter: second poll was not conditional");
+        return false;
+    }
+    if (!processed || !isLastRequestSuccessful()) {
+        LOG_ERROR("counter: 304 was not accepted");
+        return false;
+    }
+    if (getCounterValue() != 12345 || strcmp(getCounterLastUpdated(), lastUpdated) != 0) {
+        LOG_ERROR("counter: 304 changed the counter to %lu (Last updated: %s)", getCounterValue(),
+                  getCounterLastUpdated());
+        return false;
+    }
+    LOG_INFO("counter: %lu (Last updated: %s) kept on 304", getCounterValue(), getCounterLastUpdated());
+
+    // The second poll went out on the connection of the first
+    uint32_t reuses;
+    uint32_t reconnects;
+    getApiConnectionStats(reuses, reconnects);
+    if (reuses != 1 || reconnects != 0) {
+        LOG_ERROR("counter: %lu reuses, %lu reconnects, expected 1 and 0", (unsigned long)reuses,
+                  (unsigned long)reconnects);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Run HttpFetch against a stand-in server on localhost
+ *
+ * Covers name resolution, connecting to an IP literal, a refused
+ * connection, a request that is never answered, a chunked body
+ * arriving in pieces, conditional requests answered with 304 by
+ * HttpFetch and by the counter, keep-alive: reuse, an idle connection
+ * closed by the server and a request dropped by it, and interim 1xx
+ * responses ahead of the final one. The exit code is 1 if any case
+ * fails.
+ */
+int main(int argc, char** argv) {
+    setClock(&virtualClock);
+    Serial.begin(115200);
+    initLogging();
+
+    listenSocket = bindLoopback(TEST_PORT, true);
+    closedSocket = bindLoopback(TEST_CLOSED_PORT, false);
+    if (listenSocket < 0 || closedSocket < 0) {
+        LOG_ERROR("Cannot bind ports %d and %d", TEST_PORT, TEST_CLOSED_PORT);
+        return 1;
+    }
+
+    // The metrics responses carry the length of the shared body
+    snprintf(validatorsResponse, sizeof(validatorsResponse),
+             "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nETag: " TEST_ETAG "\r\n"
+             "Last-Modified: " TEST_LAST_MODIFIED "\r\nContent-Length: %u\r\n\r\n%s",
+             (unsigned)strlen(METRICS_BODY), METRICS_BODY);
+    snprintf(lastModifiedResponse, sizeof(lastModifiedResponse),
+             "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+             "Last-Modified: " TEST_LAST_MODIFIED "\r\nContent-Length: %u\r\n\r\n%s",
+             (unsigned)strlen(METRICS_BODY), METRICS_BODY);
+
+    size_t failed = 0;
+    size_t caseCount = sizeof(TEST_CASES) / sizeof(TEST_CASES[0]);
+    for (size_t i = 0; i < caseCount; i++) {
+        if (!runCase(TEST_CASES[i])) {
+            failed++;
+        }
+    }
+    if (!runCounterCase()) {
+        failed++;
+    }
+    caseCount++;
+    if (failed == 0) {
+        LOG_INFO("All %u cases passed", (unsigned)caseCount);
+    } else {
+        LOG_ERROR("%u of %u cases failed", (unsigned)failed, (unsigned)caseCount);
+    }
+
+    close(listenSocket);
+    close(closedSocket);
+
+    flushLogging();
+    return failed == 0 ? 0 : 1;
+}
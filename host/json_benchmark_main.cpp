@@ -0,0 +1,196 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <new>
+#include <string>
+#include "clock.h"
+#include "heap_stats.h"
+#include "http_fetch.h"
+#include "metrics_json_scanner.h"
+
+#define LOG_TAG "json_bench"
+#include "logger.h"
+
+// Benchmark configuration
+#define JSON_BENCHMARK_ROUNDS 20000     // Parses per document and parser
+#define JSON_DOCUMENT_CAPACITY 1024     // Capacity of the DynamicJsonDocument the firmware used
+
+/**
+ * @brief Allocator of the old document, through the counted operator new of heap_stats.cpp
+ *
+ * DynamicJsonDocument allocates with malloc(), which the host heap does
+ * not see. On the device both end up in the same heap.
+ */
+struct CountedJsonAllocator {
+    void* allocate(size_t size) {
+        return operator new(size, std::nothrow);
+    }
+
+    void deallocate(void* pointer) {
+        operator delete(pointer);
+    }
+};
+
+// DynamicJsonDocument with its pool in the counted heap
+typedef BasicJsonDocument<CountedJsonAllocator> CountedJsonDocument;
+
+/**
+ * @brief Response bodies of the metrics API
+ */
+struct JsonSample {
+    const char* name;       // Sample name for the log
+    const char* body;       // Response body
+};
+
+static const JsonSample JSON_SAMPLES[] = {
+    {"metrics",
+     "{\"username\": \"insta_counter\", \"followers_count\": 12345, \"posts_count\": 42, "
+     "\"recent_posts_count\": 3, \"last_updated\": \"2026-01-01 12:00:00\"}"},
+    {"nested",
+     "{\"username\": \"insta_counter\", \"profile\": {\"bio\": \"Counting \\\"followers\\\" \\u2764\", "
+     "\"links\": [\"https://example.com\", null, true]}, \"recent_posts\": [{\"id\": 1, \"likes\": 120}, "
+     "{\"id\": 2, \"likes\": 98, \"tags\": [\"led\", \"matrix\"]}], \"followers_count\": 12345, "
+     "\"posts_count\": 42, \"last_updated\": \"2026-01-01 12:00:00\"}"},
+};
+
+/**
+ * @brief Fields both parsers extract
+ */
+struct JsonFields {
+    unsigned long followersCount;   // followers_count
+    std::string username;           // username
+    std::string lastUpdated;        // last_updated
+};
+
+/**
+ * @brief Parse a body with the scanner, fed in chunks like HttpFetch delivers them
+ * @param body Response body
+ * @param fields Filled with the extracted fields
+ * @return False if the document was not complete
+ */
+static bool parseWithScanner(const char* body, JsonFields* fields) {
+    static MetricsJsonScanner scanner;
+    size_t length = strlen(body);
+
+    scanner.reset();
+    for (size_t offset = 0; offset < length; offset += HTTP_FETCH_IO_CHUNK) {
+        scanner.feed(body + offset, min<size_t>(length - offset, HTTP_FETCH_IO_CHUNK));
+    }
+    if (!scanner.isComplete() || !scanner.hasFollowersCount()) {
+        return false;
+    }
+    if (fields != nullptr) {
+        fields->followersCount = scanner.getFollowersCount();
+        fields->username = scanner.getUsername();
+        fields->lastUpdated = scanner.getLastUpdated();
+    }
+    return true;
+}
+
+/**
+ * @brief Parse a body like the firmware did before the scanner
+ *
+ * The buffered body went into a DynamicJsonDocument and the strings were
+ * copied into String objects, std::string stands in for them here.
+ *
+ * @param body Response body
+ * @param fields Filled with the extracted fields
+ * @return False if the document could not be parsed
+ */
+static bool parseWithDocument(const char* body, JsonFields* fields) {
+    CountedJsonDocument doc(JSON_DOCUMENT_CAPACITY);
+    DeserializationError error = deserializeJson(doc, body, strlen(body));
+    if (error) {
+        return false;
+    }
+
+    unsigned long followers = doc["followers_count"];
+    std::string username = doc["username"].as<const char*>();
+    std::string lastUpdated = doc["last_updated"].as<const char*>();
+    if (fields != nullptr) {
+        fields->followersCount = followers;
+        fields->username = username;
+        fields->lastUpdated = lastUpdated;
+    }
+    return true;
+}
+
+/**
+ * @brief Time a parser and measure the heap one parse needs
+ * @param parse Parser to measure
+ * @param body Response body
+ * @param nanoseconds Average time per parse
+ * @param peakBytes Highest heap usage above the start of a parse
+ * @param allocations Allocations per parse
+ */
+static void measureParser(bool (*parse)(const char*, JsonFields*), const char* body, double& nanoseconds,
+                          uint32_t& peakBytes, uint32_t& allocations) {
+    HeapStats before;
+    HeapStats after;
+
+    resetHeapPeak();
+    readHeapStats(before);
+    parse(body, nullptr);
+    readHeapStats(after);
+    peakBytes = after.peakUsedBytes - before.usedBytes;
+    allocations = after.allocationCount - before.allocationCount;
+
+    uint64_t start = clockMicros();
+    for (int i = 0; i < JSON_BENCHMARK_ROUNDS; i++) {
+        parse(body, nullptr);
+    }
+    nanoseconds = (clockMicros() - start) * 1000.0 / JSON_BENCHMARK_ROUNDS;
+}
+
+/**
+ * @brief Compare the metrics scanner with the old DynamicJsonDocument path
+ *
+ * Both parse the same response bodies and have to extract the same
+ * fields. For each the time per parse, the peak heap and the number of
+ * allocations are logged. The exit code is 1 if the results differ.
+ */
+int main(int argc, char** argv) {
+    Serial.begin(115200);
+    initLogging();
+
+    bool passed = true;
+    for (const JsonSample& sample : JSON_SAMPLES) {
+        JsonFields scanned;
+        JsonFields parsed;
+        if (!parseWithScanner(sample.body, &scanned) || !parseWithDocument(sample.body, &parsed)) {
+            LOG_ERROR("%s: parse failed", sample.name);
+            passed = false;
+            continue;
+        }
+        if (scanned.followersCount != parsed.followersCount || scanned.username != parsed.username ||
+            scanned.lastUpdated != parsed.lastUpdated) {
+            LOG_ERROR("%s: scanner read %lu \"%s\" \"%s\", document %lu \"%s\" \"%s\"", sample.name,
+                      scanned.followersCount, scanned.username.c_str(), scanned.lastUpdated.c_str(),
+                      parsed.followersCount, parsed.username.c_str(), parsed.lastUpdated.c_str());
+            passed = false;
+            continue;
+        }
+
+        double scannerTime;
+        double documentTime;
+        uint32_t scannerPeak;
+        uint32_t documentPeak;
+        uint32_t scannerAllocations;
+        uint32_t documentAllocations;
+        measureParser(parseWithScanner, sample.body, scannerTime, scannerPeak, scannerAllocations);
+        measureParser(parseWithDocument, sample.body, documentTime, documentPeak, documentAllocations);
+
+        LOG_INFO("%s (%u B): scanner %.0f ns, %lu B heap, %lu allocations", sample.name,
+                 (unsigned)strlen(sample.body), scannerTime, (unsigned long)scannerPeak,
+                 (unsigned long)scannerAllocations);
+        LOG_INFO("%s (%u B): document %.0f ns, %lu B heap, %lu allocations", sample.name,
+                 (unsigned)strlen(sample.body), documentTime, (unsigned long)documentPeak,
+                 (unsigned long)documentAllocations);
+    }
+
+    if (passed) {
+        LOG_INFO("Scanner and document extract the same fields");
+    }
+
+    flushLogging();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+#include <Arduino.h>
+#include <limits.h>
+#include "metrics_json_scanner.h"
+
+#define LOG_TAG "scanner_test"
+#include "logger.h"
+
+// Test configuration
+#define TEST_BODY_MAX 160               // Longest document
+
+/**
+ * @brief One document and the follower count expected from it
+ */
+struct TestCase {
+    const char* name;           // Case name for the log
+    const char* count;          // followers_count value as it appears in the document
+    bool expectedFound;         // hasFollowersCount() after the document
+    unsigned long expected;     // getFollowersCount() if found
+};
+
+// ULONG_MAX, and ten times it written with one more digit and with an exponent
+static char maxCount[24];
+static char tooLongCount[24];
+static char maxExponentCount[24];
+
+static const TestCase TEST_CASES[] = {
+    {"integer", "12345", true, 12345},
+    {"fraction", "12345.9", true, 12345},
+    {"exponent", "1e6", true, 1000000},
+    {"fraction_exponent", "1.2E4", true, 12000},
+    {"signed_exponent", "25E+2", true, 2500},
+    {"negative_exponent", "12345e-2", true, 123},
+    {"small", "1e-3", true, 0},
+    {"negative", "-5", false, 0},
+    {"max", maxCount, true, ULONG_MAX},
+    {"overflow", tooLongCount, false, 0},
+    {"exponent_overflow", maxExponentCount, false, 0},
+    {"large_exponent", "1e400", false, 0},
+};
+
+/**
+ * @brief Scan a document and check the follower count
+ * @param test Case to run
+ * @param chunk Bytes fed per call, the document arrives in pieces of this size
+ * @return True if the follower count is as expected
+ */
+static bool runCase(const TestCase& test, size_t chunk) {
+    char body[TEST_BODY_MAX];
+    int length = snprintf(body, sizeof(body),
+                          "{\"username\": \"test\", \"followers_count\": %s, \"last_updated\": \"2026-01-01\"}",
+                          test.count);
+
+    MetricsJsonScanner scanner;
+    for (int offset = 0; offset < length; offset += chunk) {
+        scanner.feed(body + offset, min<size_t>(length - offset, chunk));
+    }
+
+    if (!scanner.isComplete() || strcmp(scanner.getLastUpdated(), "2026-01-01") != 0) {
+        LOG_ERROR("%s: document not scanned in %u byte chunks", test.name, (unsigned)chunk);
+        return false;
+    }
+    if (scanner.hasFollowersCount() != test.expectedFound ||
+        (test.expectedFound && scanner.getFollowersCount() != test.expected)) {
+        LOG_ERROR("%s: %s in %u byte chunks read as %s %lu, expected %s %lu", test.name, test.count,
+                  (unsigned)chunk, scanner.hasFollowersCount() ? "found" : "missing", scanner.getFollowersCount(),
+                  test.expectedFound ? "found" : "missing", test.expected);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Check the follower counts MetricsJsonScanner extracts
+ *
+ * Covers fractions, exponents and counts that do not fit an unsigned
+ * long, each fed whole and one byte at a time. The exit code is 1 if
+ * any case fails.
+ */
+int main(int argc, char** argv) {
+    Serial.begin(115200);
+    initLogging();
+
+    snprintf(maxCount, sizeof(maxCount), "%lu", ULONG_MAX);
+    snprintf(tooLongCount, sizeof(tooLongCount), "%lu0", ULONG_MAX);
+    snprintf(maxExponentCount, sizeof(maxExponentCount), "%lue1", ULONG_MAX);
+
+    size_t failed = 0;
+    size_t caseCount = sizeof(TEST_CASES) / sizeof(TEST_CASES[0]);
+    for (size_t i = 0; i < caseCount; i++) {
+        if (!runCase(TEST_CASES[i], TEST_BODY_MAX) || !runCase(TEST_CASES[i], 1)) {
+            failed++;
+        }
+    }
+    if (failed == 0) {
+        LOG_INFO("All %u cases passed", (unsigned)caseCount);
+    } else {
+        LOG_ERROR("%u of %u cases failed", (unsigned)failed, (unsigned)caseCount);
+    }
+
+    flushLogging();
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,451 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "clock.h"
+#include "counter.h"
+#include "heap_stats.h"
+#include "poll_scheduler.h"
+#include "matrix_config.h"
+#include "animations/animation_manager.h"
+
+// The firmware only logs errors in this build, the results are logged here
+#define LOG_TAG "soak"
+#define LOG_LOCAL_LEVEL LOG_LEVEL_INFO
+#include "logger.h"
+
+// Soak run configuration
+#define SOAK_DEFAULT_DAYS 30                // Simulated days when none are given
+#define SOAK_STEP 100                       // Virtual time per loop iteration, matches REFRESH_INTERVAL in main.h
+#define SOAK_START_MILLIS 4208567296ULL     // One day before a 32-bit millis() wraps
+#define SOAK_SAMPLE_INTERVAL 3600000UL      // Virtual time between two heap samples
+#define SOAK_WARMUP_SAMPLES 24              // Samples before the heap has settled, not checked for growth
+#define SOAK_GROWTH_BYTES 2048              // Allowed growth of the byte figures after the warm-up
+#define SOAK_GROWTH_BLOCKS 16               // Allowed growth of the live blocks after the warm-up
+#define SOAK_GROWTH_FRAGMENTATION 5         // Allowed growth of the fragmentation in percentage points
+#define SOAK_MAX_UPDATE_GAP 1200000UL       // Longest connected time without a counter update outcome
+
+// Stand-in bridge configuration
+#define SOAK_PORT 18080                     // Matches COUNTER_API_BASE in env:native_soak
+#define SOAK_MAX_CONNECTIONS 4              // The firmware opens at most two
+#define SOAK_REQUEST_MAX 1024               // Longest request headers
+#define SOAK_RESPONSE_MAX 768               // Longest response
+#define SOAK_COUNTER_START 1000             // Follower count at the start
+#define SOAK_COUNTER_INTERVAL 600000UL      // Virtual time between two follower count changes
+#define SOAK_EPOCH 1767225600UL             // Unix time shown for virtual time 0, 2026-01-01
+
+// Simulated faults
+#define SOAK_FAIL_500_PERCENT 5             // Metrics requests answered with a server error
+#define SOAK_FAIL_429_PERCENT 3             // Metrics requests answered with Retry-After
+#define SOAK_FAIL_MALFORMED_PERCENT 3       // Metrics requests answered with truncated JSON
+#define SOAK_FAIL_DROP_PERCENT 4            // Requests answered by closing the connection
+#define SOAK_FAIL_HANG_PERCENT 2            // Requests never answered, the firmware times out
+#define SOAK_STREAM_PERCENT 30              // Stream requests answered with one event
+#define SOAK_WIFI_DROP_PERCENT 10           // Chance of a WiFi drop per simulated hour
+#define SOAK_WIFI_DROP_MAX 1800000UL        // Longest WiFi outage
+
+/**
+ * @brief Connection of the firmware to the stand-in bridge
+ */
+struct BridgeConnection {
+    int fd;                             // Socket, -1 if the slot is free
+    bool hung;                          // Request is ignored until the firmware gives up
+    size_t length;                      // Bytes in request
+    char request[SOAK_REQUEST_MAX];     // Request headers received so far
+};
+
+// Global animation manager instance, main.cpp is not part of host builds
+AnimationManager animationManager;
+
+// Time of the whole simulation, advanced one step per loop iteration
+static VirtualClock virtualClock;
+
+// Stand-in bridge
+static int listenSocket = -1;
+static BridgeConnection connections[SOAK_MAX_CONNECTIONS];
+static uint32_t faultState = 1;     // xorshift32 state, separate from random() used by the firmware
+
+/**
+ * @brief Next number of the fault sequence
+ * @param range Number of possible values
+ * @return Value from 0 to range - 1
+ */
+static uint32_t soakRandom(uint32_t range) {
+    faultState ^= faultState << 13;
+    faultState ^= faultState >> 17;
+    faultState ^= faultState << 5;
+    return faultState % range;
+}
+
+/**
+ * @brief Close a bridge connection, simulates the server or the link going away
+ * @param connection Connection to close
+ */
+static void closeConnection(BridgeConnection& connection) {
+    if (connection.fd >= 0) {
+        close(connection.fd);
+        connection.fd = -1;
+    }
+}
+
+/**
+ * @brief Start listening for the firmware
+ * @return False if the port is not available
+ */
+static bool startBridge() {
+    for (int i = 0; i < SOAK_MAX_CONNECTIONS; i++) {
+        connections[i].fd = -1;
+    }
+
+    listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0) {
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(SOAK_PORT);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listenSocket, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listenSocket, 4) != 0) {
+        return false;
+    }
+    fcntl(listenSocket, F_SETFL, fcntl(listenSocket, F_GETFL, 0) | O_NONBLOCK);
+    return true;
+}
+
+/**
+ * @brief Format the current metrics like the bridge does
+ * @param json Output buffer
+ * @param size Size of json
+ * @param etag Output buffer for the entity tag
+ * @param etagSize Size of etag
+ * @return Seconds until the follower count changes
+ */
+static unsigned long formatMetrics(char* json, size_t size, char* etag, size_t etagSize) {
+    uint64_t now = clockMicros() / 1000;
+    uint64_t steps = now / SOAK_COUNTER_INTERVAL;
+    unsigned long followers = SOAK_COUNTER_START + (unsigned long)steps;
+
+    time_t updated = SOAK_EPOCH + (time_t)(steps * SOAK_COUNTER_INTERVAL / 1000);
+    struct tm fields;
+    gmtime_r(&updated, &fields);
+    char lastUpdated[24];
+    strftime(lastUpdated, sizeof(lastUpdated), "%Y-%m-%d %H:%M:%S", &fields);
+
+    snprintf(json, size,
+             "{\"username\": \"soak\", \"followers_count\": %lu, \"posts_count\": 42, "
+             "\"recent_posts_count\": 0, \"last_updated\": \"%s\"}",
+             followers, lastUpdated);
+    snprintf(etag, etagSize, "\"%08lx\"", followers);
+    return (unsigned long)((SOAK_COUNTER_INTERVAL - now % SOAK_COUNTER_INTERVAL) / 1000);
+}
+
+/**
+ * @brief Answer a complete request, possibly with a simulated fault
+ * @param connection Connection the request arrived on
+ * @return False if the connection has to be closed afterwards
+ */
+static bool answerRequest(BridgeConnection& connection) {
+    char json[256];
+    char etag[16];
+    unsigned long maxAge = formatMetrics(json, sizeof(json), etag, sizeof(etag));
+    char response[SOAK_RESPONSE_MAX];
+    int length;
+    bool keepAlive = true;
+
+    uint32_t roll = soakRandom(100);
+    if (roll < SOAK_FAIL_DROP_PERCENT) {
+        return false;
+    }
+    if (roll < SOAK_FAIL_DROP_PERCENT + SOAK_FAIL_HANG_PERCENT) {
+        connection.hung = true;
+        return true;
+    }
+    roll -= SOAK_FAIL_DROP_PERCENT + SOAK_FAIL_HANG_PERCENT;
+
+    if (strncmp(connection.request, "GET /api/instagram/metrics/stream", 33) == 0) {
+        // One event, then the bridge goes away like after a restart
+        if (roll < SOAK_STREAM_PERCENT) {
+            length = snprintf(response, sizeof(response),
+                              "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nConnection: close\r\n\r\n"
+                              "retry: 5000\n\nevent: metrics\ndata: %s\n\n", json);
+            keepAlive = false;
+        } else {
+            length = snprintf(response, sizeof(response), "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+        }
+    } else if (roll < SOAK_FAIL_500_PERCENT) {
+        length = snprintf(response, sizeof(response), "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\n\r\n");
+    } else if (roll < SOAK_FAIL_500_PERCENT + SOAK_FAIL_429_PERCENT) {
+        length = snprintf(response, sizeof(response),
+                          "HTTP/1.1 429 Too Many Requests\r\nRetry-After: 120\r\nContent-Length: 0\r\n\r\n");
+    } else if (roll < SOAK_FAIL_500_PERCENT + SOAK_FAIL_429_PERCENT + SOAK_FAIL_MALFORMED_PERCENT) {
+        json[strlen(json) / 2] = '\0';
+        length = snprintf(response, sizeof(response),
+                          "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %u\r\n\r\n%s",
+                          (unsigned)strlen(json), json);
+    } else {
+        // Conditional GET like the real bridge
+        const char* conditional = strcasestr(connection.request, "If-None-Match:");
+        if (conditional != nullptr && strstr(conditional, etag) != nullptr) {
+            length = snprintf(response, sizeof(response),
+                              "HTTP/1.1 304 Not Modified\r\nETag: %s\r\nCache-Control: max-age=%lu\r\n\r\n",
+                              etag, maxAge);
+        } else {
+            length = snprintf(response, sizeof(response),
+                              "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nETag: %s\r\n"
+                              "Cache-Control: max-age=%lu\r\nContent-Length: %u\r\n\r\n%s",
+                              etag, maxAge, (unsigned)strlen(json), json);
+        }
+    }
+
+    // Loopback sockets take a response of this size in one call
+    if (send(connection.fd, response, length, MSG_NOSIGNAL) != length) {
+        return false;
+    }
+    return keepAlive;
+}
+
+/**
+ * @brief Accept connections and answer requests, never blocks
+ */
+static void serviceBridge() {
+    // One system call when nothing happens, which is almost every iteration
+    struct pollfd fds[SOAK_MAX_CONNECTIONS + 1];
+    int count = 0;
+    fds[count++] = {listenSocket, POLLIN, 0};
+    for (int i = 0; i < SOAK_MAX_CONNECTIONS; i++) {
+        if (connections[i].fd >= 0) {
+            fds[count++] = {connections[i].fd, POLLIN, 0};
+        }
+    }
+    if (poll(fds, count, 0) <= 0) {
+        return;
+    }
+
+    int fd = accept(listenSocket, nullptr, nullptr);
+    if (fd >= 0) {
+        BridgeConnection* slot = nullptr;
+        for (int i = 0; i < SOAK_MAX_CONNECTIONS && slot == nullptr; i++) {
+            if (connections[i].fd < 0) {
+                slot = &connections[i];
+            }
+        }
+        if (slot == nullptr) {
+            close(fd);
+        } else {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+            slot->fd = fd;
+            slot->hung = false;
+            slot->length = 0;
+        }
+    }
+
+    for (int i = 0; i < SOAK_MAX_CONNECTIONS; i++) {
+        BridgeConnection& connection = connections[i];
+        if (connection.fd < 0) {
+            continue;
+        }
+
+        ssize_t received = recv(connection.fd, connection.request + connection.length,
+                                sizeof(connection.request) - 1 - connection.length, 0);
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            closeConnection(connection);
+            continue;
+        }
+        if (received < 0 || connection.hung) {
+            continue;
+        }
+
+        connection.length += received;
+        connection.request[connection.length] = '\0';
+        if (strstr(connection.request, "\r\n\r\n") == nullptr) {
+            if (connection.length == sizeof(connection.request) - 1) {
+                closeConnection(connection);
+            }
+            continue;
+        }
+
+        if (!answerRequest(connection)) {
+            closeConnection(connection);
+        }
+        connection.length = 0;
+    }
+}
+
+/**
+ * @brief Check that a heap figure stops growing once the warm-up is over
+ *
+ * Bounded usage reaches its highest value early, a leak or growing
+ * fragmentation keeps setting new highs. The highest value of the second
+ * half of the run is compared with the highest value of the first half.
+ *
+ * @param name Figure name for the log
+ * @param samples Hourly samples
+ * @param field Figure to check
+ * @param tolerance Allowed growth
+ * @return False if the figure grew by more than the tolerance
+ */
+template <typename T>
+static bool checkBounded(const char* name, const std::vector<HeapStats>& samples, T HeapStats::*field,
+                         uint32_t tolerance) {
+    size_t middle = (SOAK_WARMUP_SAMPLES + samples.size()) / 2;
+    uint32_t firstHalf = 0;
+    uint32_t secondHalf = 0;
+    for (size_t i = SOAK_WARMUP_SAMPLES; i < samples.size(); i++) {
+        uint32_t value = samples[i].*field;
+        if (i < middle) {
+            firstHalf = max(firstHalf, value);
+        } else {
+            secondHalf = max(secondHalf, value);
+        }
+    }
+
+    if (secondHalf > firstHalf + tolerance) {
+        LOG_ERROR("%s keeps growing: %lu after the warm-up, %lu at the end",
+                  name, (unsigned long)firstHalf, (unsigned long)secondHalf);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Run the firmware's loops for weeks of virtual time and check the heap
+ *
+ * Usage: program [days]
+ *
+ * Every iteration advances virtual time by one frame, runs the counter
+ * part of the network task against a stand-in bridge on localhost and
+ * renders a frame. The bridge injects server errors, throttling, broken
+ * JSON, dropped and hanging connections, the WiFi link drops every few
+ * hours. The exit code is 1 if a heap figure keeps growing or counter
+ * updates stall.
+ */
+int main(int argc, char** argv) {
+    unsigned long days = argc > 1 ? strtoul(argv[1], nullptr, 10) : SOAK_DEFAULT_DAYS;
+    uint64_t steps = (uint64_t)days * 86400000UL / SOAK_STEP;
+
+    virtualClock.setMicros(SOAK_START_MILLIS * 1000);
+    setClock(&virtualClock);
+    Serial.begin(115200);
+    initLogging();
+
+    if (!startBridge()) {
+        LOG_ERROR("Cannot listen on port %d", SOAK_PORT);
+        return 1;
+    }
+
+    initMatrix();
+    animationManager.init();
+    initCounter();
+    WiFi.setStatus(WL_CONNECTED);
+
+    // Allocated up front so the samples do not show up in the heap figures
+    std::vector<HeapStats> samples;
+    samples.reserve(days * 86400000UL / SOAK_SAMPLE_INTERVAL + 1);
+
+    uint32_t wifiDownUntil = 0;
+    unsigned long wifiDrops = 0;
+    uint32_t lastOutcomes = 0;
+    unsigned long updateGap = 0;
+    unsigned long maxUpdateGap = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    LOG_INFO("Simulating %lu days, millis() wraps on day 1", days);
+    for (uint64_t step = 1; step <= steps; step++) {
+        virtualClock.advanceMillis(SOAK_STEP);
+        uint64_t elapsed = step * SOAK_STEP;
+
+        // The link goes down now and then, open connections die with it
+        bool connected = WiFi.status() == WL_CONNECTED;
+        if (connected && elapsed % SOAK_SAMPLE_INTERVAL == 0 && soakRandom(100) < SOAK_WIFI_DROP_PERCENT) {
+            WiFi.setStatus(WL_CONNECTION_LOST);
+            wifiDownUntil = clockMillis() + SOAK_STEP + soakRandom(SOAK_WIFI_DROP_MAX);
+            wifiDrops++;
+            for (int i = 0; i < SOAK_MAX_CONNECTIONS; i++) {
+                closeConnection(connections[i]);
+            }
+        } else if (!connected && (int32_t)(clockMillis() - wifiDownUntil) >= 0) {
+            WiFi.setStatus(WL_CONNECTED);
+        }
+        connected = WiFi.status() == WL_CONNECTED;
+
+        // Counter part of the network task
+        if (connected) {
+            serviceBridge();
+            updateCounterStream();
+            checkCounterUpdateTime();
+            if (getAPIRequestState() == API_REQUEST_COMPLETE) {
+                processAsyncCounterFetch();
+            }
+        }
+        serviceCounterStore();
+
+        // Render task
+        animationManager.update(getCounterValue());
+        updateStatusIndicator(connected, isLastRequestSuccessful(), !isCounterFresh());
+
+        // Polling has to go on no matter what failed before
+        uint32_t outcomes = getFetchStats().successCount + getFetchStats().failureCount;
+        if (outcomes != lastOutcomes) {
+            lastOutcomes = outcomes;
+            updateGap = 0;
+        } else if (connected) {
+            updateGap += SOAK_STEP;
+            maxUpdateGap = max(maxUpdateGap, updateGap);
+        }
+
+        if (elapsed % SOAK_SAMPLE_INTERVAL == 0) {
+            HeapStats stats;
+            readHeapStats(stats);
+            samples.push_back(stats);
+
+            if (elapsed % 86400000UL == 0) {
+                LOG_INFO("Day %lu: %lu B used, %lu B peak, %lu blocks, %lu B free, %u%% fragmented",
+                         (unsigned long)(elapsed / 86400000UL), (unsigned long)stats.usedBytes,
+                         (unsigned long)stats.peakUsedBytes, (unsigned long)stats.liveBlocks,
+                         (unsigned long)stats.freeBytes, (unsigned)stats.fragmentation);
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const FetchStats& fetchStats = getFetchStats();
+    HeapStats stats;
+    readHeapStats(stats);
+    LOG_INFO("Simulated %lu days in %.1f s, %lu updates, %lu failures, %lu WiFi drops",
+             days, seconds, (unsigned long)fetchStats.successCount, (unsigned long)fetchStats.failureCount, wifiDrops);
+    LOG_INFO("%lu allocations, %.1f per simulated hour, longest update gap %lu s",
+             (unsigned long)stats.allocationCount, samples.empty() ? 0.0 : (double)stats.allocationCount / samples.size(),
+             maxUpdateGap / 1000);
+
+    bool passed = true;
+    if (samples.size() < SOAK_WARMUP_SAMPLES + 2) {
+        LOG_WARN("Run too short to check heap growth, simulate at least 2 days");
+    } else {
+        passed &= checkBounded("Used bytes", samples, &HeapStats::usedBytes, SOAK_GROWTH_BYTES);
+        passed &= checkBounded("Peak used bytes", samples, &HeapStats::peakUsedBytes, SOAK_GROWTH_BYTES);
+        passed &= checkBounded("Live blocks", samples, &HeapStats::liveBlocks, SOAK_GROWTH_BLOCKS);
+        passed &= checkBounded("Fragmentation", samples, &HeapStats::fragmentation, SOAK_GROWTH_FRAGMENTATION);
+    }
+    if (maxUpdateGap > SOAK_MAX_UPDATE_GAP) {
+        LOG_ERROR("Counter updates stalled for %lu s", maxUpdateGap / 1000);
+        passed = false;
+    }
+    if (passed) {
+        LOG_INFO("Heap and update rate stayed bounded");
+    }
+
+    flushLogging();
+    return passed ? 0 : 1;
+}
@@ -1,6 +1,9 @@
-from flask import Flask, jsonify, request, g
+from flask import Flask, Response, jsonify, request, g
+from werkzeug.serving import WSGIRequestHandler
 import time
-from datetime import datetime
+import hashlib
+import json
+from datetime import datetime, timezone
 import os
 import sys
 
@@ -17,6 +20,10 @@ app = Flask(__name__)
 # Instagram API Configuration
 CREDENTIALS_FILE = os.path.join(current_dir, "instagram_credentials.csv")
 MAX_AGE_HOURS = 0.25  # Maximum age of cached data in hours before refreshing
+ERROR_RETRY_AFTER_SECONDS = 60  # Retry-After sent to devices when a request fails
+STREAM_CHECK_SECONDS = 5  # How often streams look for changed metrics
+STREAM_KEEPALIVE_SECONDS = 15  # Idle streams send a comment at least this often
+STREAM_RETRY_MS = 5000  # Reconnect delay suggested to stream clients
 
 # Initialize the Instagram wrapper with credentials from CSV
 insta_api = InstaWrapper(csv_file=CREDENTIALS_FILE)
@@ -37,6 +44,72 @@ def close_db(e=None):
     if db is not None:
         db.close()
 
+def metrics_etag(username, followers_count, posts_count, recent_posts_count, last_updated):
+    """Build an entity tag that changes whenever the returned metrics change."""
+    content = f"{username}|{followers_count}|{posts_count}|{recent_posts_count}|{last_updated}"
+    return hashlib.sha1(content.encode('utf-8')).hexdigest()[:16]
+
+def load_metrics(db, username):
+    """
+    Return the metrics of a profile as a dict, refreshing data older than
+    MAX_AGE_HOURS from Instagram. Returns None if the profile does not exist.
+    """
+    # Try to get the latest metrics from the database first
+    latest_metrics = db.get_latest_metrics(username)
+    
+    # If we have recent data (less than MAX_AGE_HOURS old), use it
+    if latest_metrics:
+        followers_count, posts_count, recent_posts_count, collection_date = latest_metrics
+        last_updated = collection_date
+        
+        # Check if data is older than configured hours and needs refresh
+        last_update_time = datetime.strptime(collection_date, '%Y-%m-%d %H:%M:%S')
+        time_diff = (datetime.now() - last_update_time).total_seconds() / 3600
+        
+        if time_diff > MAX_AGE_HOURS:
+            # Data is older than MAX_AGE_HOURS, fetch new data
+            refresh_data = True
+            app.logger.info(f"Data is {time_diff:.2f} hours old (max: {MAX_AGE_HOURS}h), refreshing...")
+        else:
+            refresh_data = False
+            app.logger.debug(f"Using cached data, last updated at {last_updated}")
+    else:
+        # No data in database, need to fetch
+        refresh_data = True
+    
+    # If we need fresh data, fetch it from Instagram
+    if refresh_data:
+        app.logger.info(f"Fetching fresh data for {username} from Instagram API...")
+        stats = insta_api.get_profile_stats(username)
+        
+        if stats["exists"]:
+            followers_count = stats["followers"]
+            posts_count = stats["posts"]
+            # We don't have recent posts count from the API
+            recent_posts_count = 0
+            
+            # Store the fresh data in the database
+            timestamp = datetime.now().strftime('%Y-%m-%d %H:%M:%S')
+            db.store_metrics(
+                username=username,
+                followers_count=followers_count,
+                posts_count=posts_count,
+                recent_posts_count=recent_posts_count,
+                timestamp=timestamp
+            )
+            last_updated = timestamp
+        elif not latest_metrics:
+            # Profile doesn't exist and we don't have cached data
+            return None
+    
+    return {
+        "username": username,
+        "followers_count": followers_count,
+        "posts_count": posts_count,
+        "recent_posts_count": recent_posts_count,
+        "last_updated": last_updated
+    }
+
 @app.route('/api/instagram/metrics', methods=['GET'])
 def get_instagram_metrics():
     """
@@ -48,77 +121,87 @@ def get_instagram_metrics():
     
     try:
         # Get a thread-safe database connection for this request
-        db = get_db()
+        metrics = load_metrics(get_db(), username)
+        if metrics is None:
+            return jsonify({
+                "error": "Profile not found",
+                "username": username
+            }), 404
         
-        # Try to get the latest metrics from the database first
-        latest_metrics = db.get_latest_metrics(username)
-        
-        # If we have recent data (less than MAX_AGE_HOURS old), use it
-        if latest_metrics:
-            followers_count, posts_count, recent_posts_count, collection_date = latest_metrics
-            last_updated = collection_date
-            
-            # Check if data is older than configured hours and needs refresh
-            last_update_time = datetime.strptime(collection_date, '%Y-%m-%d %H:%M:%S')
-            time_diff = (datetime.now() - last_update_time).total_seconds() / 3600
-            
-            if time_diff > MAX_AGE_HOURS:
-                # Data is older than MAX_AGE_HOURS, fetch new data
-                refresh_data = True
-                app.logger.info(f"Data is {time_diff:.2f} hours old (max: {MAX_AGE_HOURS}h), refreshing...")
-            else:
-                refresh_data = False
-                app.logger.info(f"Using cached data, last updated at {last_updated}")
-        else:
-            # No data in database, need to fetch
-            refresh_data = True
+        # Return formatted response
+        response = jsonify(metrics)
         
-        # If we need fresh data, fetch it from Instagram
-        if refresh_data:
-            app.logger.info(f"Fetching fresh data for {username} from Instagram API...")
-            stats = insta_api.get_profile_stats(username)
-            
-            if stats["exists"]:
-                followers_count = stats["followers"]
-                posts_count = stats["posts"]
-                # We don't have recent posts count from the API
-                recent_posts_count = 0
-                
-                # Store the fresh data in the database
-                timestamp = datetime.now().strftime('%Y-%m-%d %H:%M:%S')
-                db.store_metrics(
-                    username=username,
-                    followers_count=followers_count,
-                    posts_count=posts_count,
-                    recent_posts_count=recent_posts_count,
-                    timestamp=timestamp
-                )
-                last_updated = timestamp
-            else:
-                # If profile doesn't exist and we don't have cached data
-                if not latest_metrics:
-                    return jsonify({
-                        "error": "Profile not found",
-                        "username": username
-                    }), 404
+        # Devices send If-None-Match / If-Modified-Since and get a bodyless 304
+        # as long as the metrics have not changed
+        last_updated = metrics["last_updated"]
+        response.set_etag(metrics_etag(username, metrics["followers_count"], metrics["posts_count"],
+                                       metrics["recent_posts_count"], last_updated))
+        last_update_time = datetime.strptime(last_updated, '%Y-%m-%d %H:%M:%S')
+        response.last_modified = last_update_time.astimezone(timezone.utc)
         
-        # Return formatted response
-        return jsonify({
-            "username": username,
-            "followers_count": followers_count,
-            "posts_count": posts_count,
-            "recent_posts_count": recent_posts_count,
-            "last_updated": last_updated
-        })
+        # Tell devices how long the data stays valid, so they poll again
+        # right after the next refresh instead of on a fixed interval
+        age_seconds = (datetime.now() - last_update_time).total_seconds()
+        response.cache_control.max_age = max(0, int(MAX_AGE_HOURS * 3600 - age_seconds))
+        return response.make_conditional(request)
         
     except Exception as e:
         app.logger.error(f"Error fetching Instagram metrics: {e}")
-        return jsonify({
+        response = jsonify({
             "error": str(e),
             "username": username
-        }), 500
+        })
+        response.status_code = 500
+        response.headers['Retry-After'] = str(ERROR_RETRY_AFTER_SECONDS)
+        return response
+
+@app.route('/api/instagram/metrics/stream', methods=['GET'])
+def stream_instagram_metrics():
+    """
+    Push Instagram metrics as server-sent events
+    Devices keep this stream open and fall back to polling when it drops.
+    Every change is sent as a "metrics" event with the same JSON object the
+    polling endpoint returns, comments keep idle connections alive.
+    """
+    app.logger.info(f"Device subscribed to Instagram metrics stream at {datetime.now()} and arguments: {request.args}")
+    username = request.args.get('username', 'mein.kreis.pinneberg')
+    
+    def generate():
+        # The stream outlives the request context, so it uses its own connection
+        db = InstagramDatabase(db_path=DB_PATH)
+        last_sent = None
+        last_write = 0
+        
+        try:
+            yield f"retry: {STREAM_RETRY_MS}\n\n"
+            while True:
+                try:
+                    metrics = load_metrics(db, username)
+                except Exception as e:
+                    app.logger.error(f"Error fetching Instagram metrics for stream: {e}")
+                    metrics = None
+                
+                if metrics is not None and metrics != last_sent:
+                    yield f"event: metrics\ndata: {json.dumps(metrics)}\n\n"
+                    last_sent = metrics
+                    last_write = time.time()
+                elif time.time() - last_write >= STREAM_KEEPALIVE_SECONDS:
+                    yield ": keepalive\n\n"
+                    last_write = time.time()
+                
+                time.sleep(STREAM_CHECK_SECONDS)
+        finally:
+            db.close()
+            app.logger.info(f"Instagram metrics stream for {username} closed")
+    
+    response = Response(generate(), mimetype='text/event-stream')
+    response.headers['Cache-Control'] = 'no-cache'
+    return response
 
 
 if __name__ == '__main__':
+    # Speak HTTP/1.1 so the devices can keep their connection open between polls
+    WSGIRequestHandler.protocol_version = "HTTP/1.1"
+
     # Run the server on all interfaces (0.0.0.0) on port 5000
     app.run(host='0.0.0.0', port=5000, debug=True)
\ No newline at end of file
@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+"""
+Turn the tokenized serial log of the firmware back into text.
+
+With LOG_TOKENIZED=1 (env:esp32_tokenized in platformio.ini) the firmware
+does not format log lines. Each line is sent as a frame holding the
+address of its format string followed by the raw arguments, see
+LogEncoder in src/logger.h. The format strings only exist in the flash
+image, so this script looks them up in the ELF file of the same build:
+
+    python scripts/log_decoder.py .pio/build/esp32_tokenized/firmware.elf --port /dev/ttyUSB0
+    python scripts/log_decoder.py .pio/build/esp32_tokenized/firmware.elf capture.bin
+
+Frames are COBS encoded and delimited by zero bytes. Anything that is not
+a valid frame (ROM boot messages, output of a plain text build) is passed
+through unchanged. Reading from a serial port needs pyserial, files and
+stdin only need the standard library.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SHT_PROGBITS = 1
+SHF_ALLOC = 0x2
+
+# printf conversion: flags, width, precision, length modifier, conversion
+CONVERSION = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|z|t|L)?([diouxXeEfFgGaAcspn%])')
+
+
+class ElfStrings:
+    """Reads null terminated strings at load addresses of an ELF file."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF':
+            raise ValueError(f'{path} is not an ELF file')
+
+        is_64 = self.data[4] == 2
+        endian = '<' if self.data[5] == 1 else '>'
+        if is_64:
+            shoff, = struct.unpack_from(endian + 'Q', self.data, 0x28)
+            shentsize, shnum = struct.unpack_from(endian + 'HH', self.data, 0x3a)
+            section = endian + 'IIQQQQIIQQ'
+        else:
+            shoff, = struct.unpack_from(endian + 'I', self.data, 0x20)
+            shentsize, shnum = struct.unpack_from(endian + 'HH', self.data, 0x2e)
+            section = endian + 'IIIIIIIIII'
+
+        # Sections loaded into memory with contents in the file, that is where string literals live
+        self.sections = []
+        for i in range(shnum):
+            fields = struct.unpack_from(section, self.data, shoff + i * shentsize)
+            sh_type, sh_flags, sh_addr, sh_offset, sh_size = fields[1:6]
+            if sh_type == SHT_PROGBITS and sh_flags & SHF_ALLOC and sh_addr != 0:
+                self.sections.append((sh_addr, sh_offset, sh_size))
+        self.cache = {}
+
+    def string_at(self, address):
+        """Return the string at a load address, None if there is none."""
+        if address in self.cache:
+            return self.cache[address]
+        text = None
+        for sh_addr, sh_offset, sh_size in self.sections:
+            if sh_addr <= address < sh_addr + sh_size:
+                start = sh_offset + address - sh_addr
+                end = self.data.find(b'\0', start, sh_offset + sh_size)
+                if end >= 0:
+                    try:
+                        text = self.data[start:end].decode('utf-8')
+                    except UnicodeDecodeError:
+                        text = None
+                break
+        self.cache[address] = text
+        return text
+
+
+def cobs_decode(chunk):
+    """Undo the COBS encoding of a frame without its zero delimiters, None if invalid."""
+    out = bytearray()
+    i = 0
+    while i < len(chunk):
+        code = chunk[i]
+        if code == 0 or i + code > len(chunk):
+            return None
+        out += chunk[i + 1:i + code]
+        i += code
+        if code < 0xff and i < len(chunk):
+            out.append(0)
+    return bytes(out)
+
+
+class ArgumentReader:
+    """Reads the arguments of a frame in the order LogEncoder wrote them."""
+
+    def __init__(self, data):
+        self.data = data
+        self.position = 0
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            if self.position >= len(self.data):
+                raise EOFError
+            byte = self.data[self.position]
+            self.position += 1
+            value |= (byte & 0x7f) << shift
+            shift += 7
+            if byte < 0x80:
+                return value
+
+    def signed(self, wide):
+        value = self.varint()
+        # Negative values of 32-bit types are sent as their 32-bit pattern
+        bits = 64 if wide or value >= 1 << 32 else 32
+        if value >= 1 << (bits - 1):
+            value -= 1 << bits
+        return value
+
+    def double(self):
+        if self.position + 8 > len(self.data):
+            raise EOFError
+        value, = struct.unpack_from('<d', self.data, self.position)
+        self.position += 8
+        return value
+
+    def string(self):
+        length = self.varint()
+        text = self.data[self.position:self.position + length]
+        self.position += length
+        return text.decode('utf-8', errors='replace')
+
+
+def format_line(fmt, arguments):
+    """Format a line like printf would, reading each argument from the frame."""
+    out = []
+    last = 0
+    try:
+        for match in CONVERSION.finditer(fmt):
+            out.append(fmt[last:match.start()])
+            last = match.end()
+            flags, width, precision, length, conversion = match.groups()
+            if conversion == '%':
+                out.append('%')
+                continue
+            if width == '*':
+                width = str(arguments.signed(False))
+            if precision == '*':
+                precision = str(arguments.signed(False))
+
+            if conversion in 'di':
+                value = arguments.signed(length in ('ll', 'j'))
+            elif conversion in 'ouxXc':
+                value = arguments.varint()
+            elif conversion in 'eEfFgGaA':
+                value = arguments.double()
+                conversion = 'e' if conversion in 'aA' else conversion
+            elif conversion == 's':
+                value = arguments.string()
+            elif conversion == 'p':
+                value = arguments.varint()
+                conversion = 'x'
+                flags += '#'
+            else:
+                continue
+
+            spec = '%' + flags + (width or '') + ('.' + precision if precision is not None else '') + conversion
+            out.append(spec % value)
+    except EOFError:
+        return ''.join(out) + ' [truncated]\n'
+    out.append(fmt[last:])
+    return ''.join(out)
+
+
+def decode_chunk(chunk, strings):
+    """Turn one zero delimited chunk into text, raw bytes if it is not a frame."""
+    frame = cobs_decode(chunk)
+    if frame is not None and len(frame) >= 4:
+        token, = struct.unpack_from('<I', frame, 0)
+        fmt = strings.string_at(token)
+        if fmt is not None:
+            return format_line(fmt, ArgumentReader(frame[4:]))
+    return chunk.decode('utf-8', errors='replace')
+
+
+def decode_stream(blocks, strings, output):
+    """Decode a stream given as an iterable of byte blocks."""
+    pending = bytearray()
+    for data in blocks:
+        pending += data
+        while True:
+            end = pending.find(b'\0')
+            if end < 0:
+                break
+            if end > 0:
+                output.write(decode_chunk(bytes(pending[:end]), strings))
+                output.flush()
+            del pending[:end + 1]
+    if pending:
+        output.write(decode_chunk(bytes(pending), strings))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode the tokenized serial log of the firmware.')
+    parser.add_argument('elf', help='firmware.elf of the running build')
+    parser.add_argument('input', nargs='?', help='captured log, stdin if omitted')
+    parser.add_argument('--port', help='read from this serial port instead')
+    parser.add_argument('--baud', type=int, default=115200, help='serial port speed (default: 115200)')
+    args = parser.parse_args()
+
+    strings = ElfStrings(args.elf)
+
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            try:
+                # Runs until interrupted, reads return nothing while the device is quiet
+                decode_stream(iter(lambda: port.read(256), None), strings, sys.stdout)
+            except KeyboardInterrupt:
+                pass
+    elif args.input:
+        with open(args.input, 'rb') as f:
+            decode_stream(iter(lambda: f.read(4096), b''), strings, sys.stdout)
+    else:
+        decode_stream(iter(lambda: sys.stdin.buffer.read1(4096), b''), strings, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
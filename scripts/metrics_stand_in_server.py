@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""
+Local stand-in for the metrics bridge, using only the standard library.
+
+Serves the same endpoints as instagram_api_server.py with a fake follower
+count that grows every --interval seconds, so the firmware's polling,
+conditional GET and push stream can be tested without Instagram access:
+
+    GET /api/instagram/metrics          JSON, ETag, Last-Modified, max-age, 304
+    GET /api/instagram/metrics/stream   server-sent events, chunked encoding
+
+Point COUNTER_API_BASE in src/counter.h at this host.
+"""
+
+import argparse
+import hashlib
+import json
+import time
+from datetime import datetime, timezone
+from email.utils import format_datetime
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+class FakeMetrics:
+    """Follower count that increases on a fixed interval."""
+
+    def __init__(self, username, start, interval):
+        self.username = username
+        self.start_count = start
+        self.interval = interval
+        self.started = time.time()
+
+    def snapshot(self):
+        """Return the current metrics and the seconds until they change."""
+        elapsed = time.time() - self.started
+        steps = int(elapsed // self.interval)
+        updated = self.started + steps * self.interval
+        metrics = {
+            "username": self.username,
+            "followers_count": self.start_count + steps,
+            "posts_count": 42,
+            "recent_posts_count": 0,
+            "last_updated": datetime.fromtimestamp(updated).strftime('%Y-%m-%d %H:%M:%S')
+        }
+        return metrics, updated, self.interval - (elapsed - steps * self.interval)
+
+
+class StandInHandler(BaseHTTPRequestHandler):
+    """Request handler speaking HTTP/1.1 with keep-alive, like the real bridge."""
+
+    protocol_version = "HTTP/1.1"
+    metrics = None
+    keepalive_seconds = 15
+
+    def do_GET(self):
+        if self.path.startswith('/api/instagram/metrics/stream'):
+            self.send_stream()
+        elif self.path.startswith('/api/instagram/metrics'):
+            self.send_metrics()
+        else:
+            self.send_error(404)
+
+    def send_metrics(self):
+        metrics, updated, remaining = self.metrics.snapshot()
+        etag = '"' + hashlib.sha1(json.dumps(metrics, sort_keys=True).encode()).hexdigest()[:16] + '"'
+
+        self.send_response(304 if self.headers.get('If-None-Match') == etag else 200)
+        self.send_header('ETag', etag)
+        self.send_header('Last-Modified', format_datetime(datetime.fromtimestamp(updated, timezone.utc), usegmt=True))
+        self.send_header('Cache-Control', f'max-age={int(remaining)}')
+
+        if self.headers.get('If-None-Match') == etag:
+            self.end_headers()
+            return
+
+        body = json.dumps(metrics).encode()
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def send_stream(self):
+        self.send_response(200)
+        self.send_header('Content-Type', 'text/event-stream')
+        self.send_header('Cache-Control', 'no-cache')
+        self.send_header('Transfer-Encoding', 'chunked')
+        self.end_headers()
+
+        last_sent = None
+        last_write = 0
+        try:
+            self.write_chunk("retry: 5000\n\n")
+            while True:
+                metrics, _, _ = self.metrics.snapshot()
+                if metrics != last_sent:
+                    self.write_chunk(f"event: metrics\ndata: {json.dumps(metrics)}\n\n")
+                    last_sent = metrics
+                    last_write = time.time()
+                elif time.time() - last_write >= self.keepalive_seconds:
+                    self.write_chunk(": keepalive\n\n")
+                    last_write = time.time()
+                time.sleep(0.5)
+        except (BrokenPipeError, ConnectionResetError):
+            pass
+        self.close_connection = True
+
+    def write_chunk(self, text):
+        data = text.encode()
+        self.wfile.write(f"{len(data):x}\r\n".encode() + data + b"\r\n")
+        self.wfile.flush()
+
+    def log_message(self, format, *args):
+        print(f"{self.address_string()} - {format % args}", flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Local stand-in for the metrics bridge")
+    parser.add_argument('--port', type=int, default=5000, help="port to listen on")
+    parser.add_argument('--username', default='mein.kreis.pinneberg', help="username to report")
+    parser.add_argument('--start', type=int, default=1000, help="initial follower count")
+    parser.add_argument('--interval', type=float, default=30, help="seconds between follower changes")
+    args = parser.parse_args()
+
+    StandInHandler.metrics = FakeMetrics(args.username, args.start, args.interval)
+    server = ThreadingHTTPServer(('0.0.0.0', args.port), StandInHandler)
+    server.daemon_threads = True
+    print(f"Metrics stand-in listening on port {args.port}", flush=True)
+    server.serve_forever()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""
+Convert the captive portal sources in portal/ into src/portal_assets.h.
+
+Static assets are gzip-compressed, the firmware sends them unchanged with
+Content-Encoding: gzip. Templates (*.html files containing {{name}}
+placeholders) are stored as plain strings, the firmware streams them
+through a template writer that fills in the placeholders.
+
+Run again after changing anything in portal/:
+
+    python scripts/portal_assets.py [portal_dir] [output_header]
+"""
+
+import gzip
+import os
+import re
+import sys
+
+CONTENT_TYPES = {
+    '.html': 'text/html',
+    '.css': 'text/css',
+    '.js': 'application/javascript',
+    '.svg': 'image/svg+xml',
+}
+
+
+def symbol_name(filename):
+    """Turn a file name like style.css into portal_style_css."""
+    return 'portal_' + re.sub(r'[^0-9a-zA-Z]', '_', filename).lower()
+
+
+def c_string(text):
+    """Format text as a C string literal, one source line per input line."""
+    lines = []
+    for line in text.splitlines(keepends=True):
+        escaped = line.replace('\\', '\\\\').replace('"', '\\"').replace('\n', '\\n')
+        lines.append(f'    "{escaped}"')
+    return '\n'.join(lines) if lines else '    ""'
+
+
+def c_bytes(data):
+    """Format data as the body of a C byte array, 16 bytes per line."""
+    rows = []
+    for i in range(0, len(data), 16):
+        rows.append('    ' + ', '.join(f'0x{b:02x}' for b in data[i:i + 16]))
+    return ',\n'.join(rows)
+
+
+def main():
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    portal_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(script_dir, '..', 'portal')
+    output = sys.argv[2] if len(sys.argv) > 2 else os.path.join(script_dir, '..', 'src', 'portal_assets.h')
+
+    parts = [
+        '// This file is automatically generated by scripts/portal_assets.py from portal/, do not edit.',
+        '#ifndef PORTAL_ASSETS_H',
+        '#define PORTAL_ASSETS_H',
+        '',
+        '#include <stdint.h>',
+        '#include <stddef.h>',
+    ]
+
+    for filename in sorted(os.listdir(portal_dir)):
+        extension = os.path.splitext(filename)[1]
+        if extension not in CONTENT_TYPES:
+            continue
+
+        with open(os.path.join(portal_dir, filename), 'rb') as source:
+            data = source.read()
+        name = symbol_name(filename)
+        text = data.decode('utf-8')
+
+        parts.append('')
+        if extension == '.html' and '{{' in text:
+            parts.append(f'// {filename}, template with {{{{name}}}} placeholders')
+            parts.append(f'const char {name}[] =\n{c_string(text)};')
+        else:
+            # mtime=0 keeps the output identical between runs
+            compressed = gzip.compress(data, compresslevel=9, mtime=0)
+            parts.append(f'// {filename}, {len(data)} bytes gzip-compressed to {len(compressed)} bytes')
+            parts.append(f'const char {name}_type[] = "{CONTENT_TYPES[extension]}";')
+            parts.append(f'const size_t {name}_gz_len = {len(compressed)};')
+            parts.append(f'const uint8_t {name}_gz[{len(compressed)}] = {{\n{c_bytes(compressed)}\n}};')
+
+    parts.append('')
+    parts.append('#endif // PORTAL_ASSETS_H')
+
+    with open(output, 'w') as header:
+        header.write('\n'.join(parts) + '\n')
+    print(f"Wrote {output}")
+
+
+if __name__ == '__main__':
+    main()
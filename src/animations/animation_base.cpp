@@ -1,13 +1,20 @@
 #include "animation_base.h"
+#include "dirty_region.h"
+#include "clock.h"
 
 /**
  * @brief Constructor with configurable duration
  * @param durationMs Animation duration in milliseconds
  */
 AnimationBase::AnimationBase(unsigned long durationMs) : 
-    startTime(millis()), 
+    startTime(clockMillis()), 
     duration(durationMs),
-    firstDraw(true) {
+    firstDraw(true),
+    counterDrawn(false),
+    drawnX(0),
+    drawnY(0),
+    drawnTextSize(0),
+    drawnColor(0) {
 }
 
 /**
@@ -15,15 +22,16 @@ AnimationBase::AnimationBase(unsigned long durationMs) :
  * @return True if animation duration has elapsed
  */
 bool AnimationBase::isComplete() {
-    return (millis() - startTime) >= duration;
+    return (clockMillis() - startTime) >= duration;
 }
 
 /**
  * @brief Reset the animation timer
  */
 void AnimationBase::reset() {
-    startTime = millis();
+    startTime = clockMillis();
     firstDraw = true;
+    counterDrawn = false;
 }
 
 /**
@@ -32,4 +40,55 @@ void AnimationBase::reset() {
  */
 void AnimationBase::setDuration(unsigned long durationMs) {
     duration = durationMs;
+}
+
+/**
+ * @brief Draw the counter digits, repainting only what changed
+ * @param counterStr Zero-padded counter string with COUNTER_DIGITS digits
+ * @param x X-position of the first digit
+ * @param y Y-position of the digits
+ * @param textSize Size of the text
+ * @param color Color to use for drawing
+ * @return True if any pixels were repainted
+ */
+bool AnimationBase::renderCounter(const char* counterStr, int16_t x, int16_t y, uint8_t textSize, uint16_t color) {
+    const int16_t digitWidth = 5 * textSize;
+    const int16_t digitHeight = 8 * textSize;
+    const int16_t digitSpacing = 1;
+    
+    // Anything but a value change invalidates the whole counter
+    bool fullRepaint = !counterDrawn || dirtyRegion.isInvalidated() ||
+                       x != drawnX || y != drawnY ||
+                       textSize != drawnTextSize || color != drawnColor;
+    
+    if (fullRepaint) {
+        // Wipe whatever was drawn last frame, including other animations
+        dirtyRegion.clearDrawn();
+    }
+    
+    bool repainted = false;
+    for (uint8_t i = 0; i < COUNTER_DIGITS; i++) {
+        if (!fullRepaint && counterStr[i] == drawnDigits[i]) {
+            continue;
+        }
+        
+        DirtyRect digitRect = {(int16_t)(x + i * (digitWidth + digitSpacing)), y, digitWidth, digitHeight};
+        if (fullRepaint) {
+            dirtyRegion.markDrawn(digitRect);
+        } else {
+            dirtyRegion.clearRect(digitRect);
+        }
+        
+        drawDigit(counterStr[i], digitRect.x, digitRect.y, textSize, color);
+        drawnDigits[i] = counterStr[i];
+        repainted = true;
+    }
+    
+    counterDrawn = true;
+    drawnX = x;
+    drawnY = y;
+    drawnTextSize = textSize;
+    drawnColor = color;
+    
+    return repainted;
 }
\ No newline at end of file
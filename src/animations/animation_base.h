@@ -2,6 +2,7 @@
 #define ANIMATION_BASE_H
 
 #include <Arduino.h>
+#include "counter.h"
 
 // Counter display color
 #define COUNTER_COLOR 0x4A1F // Purple-blue color in RGB565 format
@@ -25,7 +26,7 @@ public:
     /**
      * @brief Draw the counter animation
      * @param counter Current counter value to display
-     * @return True if animation needs to be refreshed
+     * @return True if any pixels were repainted
      */
     virtual bool draw(unsigned long counter) = 0;
     
@@ -47,9 +48,33 @@ public:
     void setDuration(unsigned long durationMs);
 
 protected:
-    unsigned long startTime;      // Animation start timestamp
+    uint32_t startTime;           // Animation start timestamp
     unsigned long duration;       // Animation duration in milliseconds
     bool firstDraw;              // Flag for first draw call
+    
+    /**
+     * @brief Draw the counter digits, repainting only what changed
+     * 
+     * Clears the areas drawn in the previous frame through the dirty region
+     * tracker. If only the counter value changed, just the changed digits
+     * are cleared and redrawn.
+     * 
+     * @param counterStr Zero-padded counter string with COUNTER_DIGITS digits
+     * @param x X-position of the first digit
+     * @param y Y-position of the digits
+     * @param textSize Size of the text
+     * @param color Color to use for drawing
+     * @return True if any pixels were repainted
+     */
+    bool renderCounter(const char* counterStr, int16_t x, int16_t y, uint8_t textSize, uint16_t color);
+
+private:
+    bool counterDrawn;                      // Digits below are currently on screen
+    char drawnDigits[COUNTER_DIGITS];       // Digits drawn in the last repaint
+    int16_t drawnX;                         // X-position of the last repaint
+    int16_t drawnY;                         // Y-position of the last repaint
+    uint8_t drawnTextSize;                  // Text size of the last repaint
+    uint16_t drawnColor;                    // Color of the last repaint
 };
 
 #endif // ANIMATION_BASE_H
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "animation_benchmark.h"
+#include "dirty_region.h"
+#include "fnv1a.h"
+#include "glyph_cache.h"
+
+#define LOG_TAG "benchmark"
+#include "../logger.h"
+
+/**
+ * @brief Draw an animation for a number of frames and measure it
+ * @param animation Fresh instance, reset before the first frame
+ * @param style Style of the instance
+ * @param frames Number of frames to draw
+ * @param afterFrame Advances time and hashes the frame, called after every frame
+ * @param result Filled with the measurements
+ */
+template <typename T>
+static void benchmarkFrames(T& animation, AnimationStyle style, uint32_t frames,
+                            AnimationBenchmarkFrameHook afterFrame, AnimationBenchmarkResult& result) {
+    animation.reset();
+    dirtyRegion.invalidate();
+
+    result = AnimationBenchmarkResult();
+    uint32_t startPixels = dirtyRegion.getClearedPixelCount() + getBlittedPixelCount();
+    uint32_t runHash = FNV1A_SEED;
+    bool hashed = false;
+    unsigned long counter = ANIMATION_BENCHMARK_COUNTER;
+
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        if (frame > 0 && frame % ANIMATION_BENCHMARK_STEP == 0) {
+            counter++;
+        }
+
+        // Restart like the animation manager does when a style is the only one enabled
+        if (animation.isComplete()) {
+            animation.reset();
+        }
+
+        uint32_t start = readCycleCount();
+        bool repainted = animation.draw(counter);
+        uint32_t cycles = readCycleCount() - start;
+
+        result.frames++;
+        result.totalCycles += cycles;
+        result.frameCycles.record(cycles);
+        if (repainted) {
+            result.repaintedFrames++;
+        }
+
+        uint32_t frameHash = afterFrame(style, frame);
+        if (frameHash != 0) {
+            runHash = fnv1a(runHash, &frameHash, sizeof(frameHash));
+            hashed = true;
+        }
+    }
+
+    result.pixelsWritten = dirtyRegion.getClearedPixelCount() + getBlittedPixelCount() - startPixels;
+    result.frameHash = hashed ? runHash : 0;
+}
+
+/**
+ * @brief Benchmarks a fresh instance of the visited animation type
+ */
+struct BenchmarkVisitor {
+    AnimationStyle style;                   // Style being benchmarked
+    uint32_t frames;                        // Number of frames to draw
+    AnimationBenchmarkFrameHook afterFrame; // Called after every frame
+    AnimationBenchmarkResult* result;       // Filled with the measurements
+
+    template <typename T>
+    void visitType() {
+        // Same starting point on every run, the animations pick positions and colors with random()
+        randomSeed(ANIMATION_BENCHMARK_SEED);
+        T animation = AnimationTraits<T>::create();
+        benchmarkFrames(animation, style, frames, afterFrame, *result);
+    }
+};
+
+/**
+ * @brief Draw one animation style for a number of frames and measure it
+ * @param style Style to benchmark
+ * @param frames Number of frames to draw
+ * @param afterFrame Advances time and hashes the frame, called after every frame
+ * @param result Filled with the measurements
+ * @return False if the style is invalid
+ */
+bool runAnimationBenchmark(AnimationStyle style, uint32_t frames, AnimationBenchmarkFrameHook afterFrame,
+                           AnimationBenchmarkResult& result) {
+    // Every style is benchmarked, enabled or not, on its own instance on the stack
+    BenchmarkVisitor visitor = {style, frames, afterFrame, &result};
+    return AnimationTypeSwitch<AllAnimations>::visit(style, visitor);
+}
+
+/**
+ * @brief Log the measurements of a style
+ * @param style Benchmarked style
+ * @param result Measurements returned by runAnimationBenchmark()
+ */
+void logAnimationBenchmark(AnimationStyle style, const AnimationBenchmarkResult& result) {
+    if (result.frames == 0) {
+        return;
+    }
+
+    // Two lines, one would not fit into LOG_LINE_MAX
+    const char* name = AnimationManager::getStyleName(style);
+    double cyclesPerMicrosecond = FrameProfiler::cyclesPerMicrosecond();
+    LOG_INFO("%s: %lu frames, mean %.2f us, p50 %.2f us, p99 %.2f us, max %.2f us",
+             name,
+             (unsigned long)result.frames,
+             result.totalCycles / cyclesPerMicrosecond / result.frames,
+             result.frameCycles.percentile(50) / cyclesPerMicrosecond,
+             result.frameCycles.percentile(99) / cyclesPerMicrosecond,
+             result.frameCycles.getMax() / cyclesPerMicrosecond);
+    LOG_INFO("%s: %lu pixels (%.1f per frame), %lu repainted, hash %08lx",
+             name,
+             (unsigned long)result.pixelsWritten,
+             (double)result.pixelsWritten / result.frames,
+             (unsigned long)result.repaintedFrames,
+             (unsigned long)result.frameHash);
+}
+
+/**
+ * @brief Wait one frame interval between benchmark frames
+ * @param style Style being benchmarked
+ * @param frame Index of the frame just drawn
+ * @return 0, the panel cannot be read back
+ */
+static uint32_t waitForNextFrame(AnimationStyle style, uint32_t frame) {
+    delay(ANIMATION_BENCHMARK_INTERVAL);
+    return 0;
+}
+
+/**
+ * @brief Benchmark every style at the normal frame rate and log the results
+ */
+void runAnimationBenchmarks() {
+    LOG_INFO("Benchmarking %d styles, %d frames each", STYLE_COUNT, ANIMATION_BENCHMARK_FRAMES);
+
+    for (int i = 0; i < STYLE_COUNT; i++) {
+        AnimationStyle style = static_cast<AnimationStyle>(i);
+        AnimationBenchmarkResult result;
+        if (runAnimationBenchmark(style, ANIMATION_BENCHMARK_FRAMES, waitForNextFrame, result)) {
+            logAnimationBenchmark(style, result);
+        }
+    }
+
+    // Leave a clean screen for the normal animations
+    dirtyRegion.invalidate();
+}
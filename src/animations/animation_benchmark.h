@@ -0,0 +1,75 @@
+#ifndef ANIMATION_BENCHMARK_H
+#define ANIMATION_BENCHMARK_H
+
+#include <Arduino.h>
+#include "animation_manager.h"
+#include "profiler.h"
+
+// Benchmark configuration
+#ifndef ANIMATION_BENCHMARK
+#define ANIMATION_BENCHMARK 0             // Set to 1 to run the benchmark at boot, see env:esp32_benchmark
+#endif
+#define ANIMATION_BENCHMARK_FRAMES 300    // Frames per style, 30 seconds at the normal frame rate
+#define ANIMATION_BENCHMARK_INTERVAL 100  // Time per frame in milliseconds, matches REFRESH_INTERVAL
+#define ANIMATION_BENCHMARK_SEED 1        // random() seed at the start of every style
+#define ANIMATION_BENCHMARK_COUNTER 12345 // Counter value of the first frame
+#define ANIMATION_BENCHMARK_STEP 50       // Frames between two counter increments
+
+/**
+ * @brief Cost of one animation style over a benchmark run
+ */
+struct AnimationBenchmarkResult {
+    uint32_t frames;                // Frames drawn
+    uint32_t repaintedFrames;       // Frames in which draw() changed any pixels
+    uint32_t pixelsWritten;         // Pixels cleared plus pixels drawn
+    uint64_t totalCycles;           // Time spent in draw(), see readCycleCount()
+    StageHistogram frameCycles;     // Time per frame, see readCycleCount()
+    uint32_t frameHash;             // FNV-1a over all frame hashes, 0 without a frame hook
+};
+
+/**
+ * @brief Called after every benchmark frame
+ *
+ * Has to advance millis() by one frame interval, the animations are
+ * timed by it. Host builds also hash the framebuffer here.
+ *
+ * @param style Style being benchmarked
+ * @param frame Index of the frame just drawn
+ * @return Hash of the frame, 0 if the framebuffer cannot be read back
+ */
+typedef uint32_t (*AnimationBenchmarkFrameHook)(AnimationStyle style, uint32_t frame);
+
+/**
+ * @brief Draw one animation style for a number of frames and measure it
+ *
+ * A fresh instance of the style is drawn on a cleared screen with a fixed
+ * random() seed and counter sequence, so the same code produces the same
+ * frames on every run. Styles disabled in animation_config.h are
+ * benchmarked as well.
+ *
+ * @param style Style to benchmark
+ * @param frames Number of frames to draw
+ * @param afterFrame Advances time and hashes the frame, called after every frame
+ * @param result Filled with the measurements
+ * @return False if the style is invalid
+ */
+bool runAnimationBenchmark(AnimationStyle style, uint32_t frames, AnimationBenchmarkFrameHook afterFrame,
+                           AnimationBenchmarkResult& result);
+
+/**
+ * @brief Log the measurements of a style
+ * @param style Benchmarked style
+ * @param result Measurements returned by runAnimationBenchmark()
+ */
+void logAnimationBenchmark(AnimationStyle style, const AnimationBenchmarkResult& result);
+
+/**
+ * @brief Benchmark every style at the normal frame rate and log the results
+ *
+ * Blocks for ANIMATION_BENCHMARK_FRAMES frames per style. The panel
+ * cannot be read back, so frame hashes are only checked by the native
+ * benchmark.
+ */
+void runAnimationBenchmarks();
+
+#endif // ANIMATION_BENCHMARK_H
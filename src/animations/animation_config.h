@@ -9,8 +9,8 @@
  * - Set the duration for each animation (in milliseconds)
  * 
  * When an animation is disabled:
- * - It will not be initialized
- * - It will not consume memory
+ * - It is left out of EnabledAnimations in animation_registry.h
+ * - It is never instantiated, so it costs neither flash nor RAM
  * - It will be skipped in the animation rotation
  */
 
@@ -22,12 +22,6 @@
 #define ENABLE_COLOR_TRANSITION    1   // Counter with color transitions
 #define ENABLE_BOUNCING_COUNTER    1   // Bouncing counter animation
 
-// Internal macros for enable checks (don't modify)
-#define ANIM_ENABLED_SIMPLE_COUNTER      ENABLE_SIMPLE_COUNTER
-#define ANIM_ENABLED_RANDOM_POSITION     ENABLE_RANDOM_POSITION
-#define ANIM_ENABLED_COLOR_TRANSITION    ENABLE_COLOR_TRANSITION
-#define ANIM_ENABLED_BOUNCING_COUNTER    ENABLE_BOUNCING_COUNTER
-
 // -----------------------------------------------------
 // Animation Duration Configuration (milliseconds)
 // -----------------------------------------------------
@@ -1,27 +1,50 @@
 #include "animation_manager.h"
 #include <Arduino.h>
 
+#define LOG_TAG "animation"
+#include "../logger.h"
+
 /**
- * @brief Constructor
+ * @brief Draws a frame of the visited animation unless its cycle is over
  */
-AnimationManager::AnimationManager() : currentStyle(STYLE_SIMPLE_COUNTER) {
-    // Initialize array with nullptrs
-    for (int i = 0; i < STYLE_COUNT; i++) {
-        animations[i] = nullptr;
+struct FrameVisitor {
+    unsigned long counter;    // Counter value to display
+    bool complete;            // Cycle was over, nothing was drawn
+    bool repainted;           // Pixels were repainted
+
+    template <typename T>
+    void operator()(T& animation) {
+        complete = animation.isComplete();
+        repainted = !complete && animation.draw(counter);
     }
-}
+};
 
 /**
- * @brief Destructor
+ * @brief Restarts the visited animation
  */
-AnimationManager::~AnimationManager() {
-    // Clean up any allocated animations
-    for (int i = 0; i < STYLE_COUNT; i++) {
-        if (animations[i] != nullptr) {
-            delete animations[i];
-            animations[i] = nullptr;
-        }
+struct ResetVisitor {
+    template <typename T>
+    void operator()(T& animation) {
+        animation.reset();
+    }
+};
+
+/**
+ * @brief Sets the duration of the visited animation
+ */
+struct DurationVisitor {
+    unsigned long durationMs;   // New duration in milliseconds
+
+    template <typename T>
+    void operator()(T& animation) {
+        animation.setDuration(durationMs);
     }
+};
+
+/**
+ * @brief Constructor
+ */
+AnimationManager::AnimationManager() : currentStyle(AnimationSet<EnabledAnimations>::first()) {
 }
 
 /**
@@ -30,19 +53,21 @@ AnimationManager::~AnimationManager() {
  * @return True if the animation is enabled
  */
 bool AnimationManager::isAnimationEnabled(AnimationStyle style) {
-    // This implementation is kept for backward compatibility but isn't used
-    // by the ANIM_ENABLED macro anymore
+    return AnimationSet<EnabledAnimations>::contains(style);
+}
+
+/**
+ * @brief Get the name of an animation style
+ * @param style The animation style
+ * @return Short lowercase name, "unknown" for invalid styles
+ */
+const char* AnimationManager::getStyleName(AnimationStyle style) {
     switch (style) {
-        case STYLE_SIMPLE_COUNTER:
-            return ENABLE_SIMPLE_COUNTER;
-        case STYLE_RANDOM_POSITION:
-            return ENABLE_RANDOM_POSITION;
-        case STYLE_COLOR_TRANSITION:
-            return ENABLE_COLOR_TRANSITION;
-        case STYLE_BOUNCING_COUNTER:
-            return ENABLE_BOUNCING_COUNTER;
-        default:
-            return false;
+        case STYLE_SIMPLE_COUNTER:   return "simple_counter";
+        case STYLE_RANDOM_POSITION:  return "random_position";
+        case STYLE_COLOR_TRANSITION: return "color_transition";
+        case STYLE_BOUNCING_COUNTER: return "bouncing_counter";
+        default:                     return "unknown";
     }
 }
 
@@ -50,37 +75,17 @@ bool AnimationManager::isAnimationEnabled(AnimationStyle style) {
  * @brief Initialize the animation manager
  */
 void AnimationManager::init() {
-    // Create animation instances only for enabled animations with duration from config
-    if (ANIM_ENABLED(STYLE_SIMPLE_COUNTER) && animations[STYLE_SIMPLE_COUNTER] == nullptr) {
-        animations[STYLE_SIMPLE_COUNTER] = new SimpleCounterAnimation(DURATION_SIMPLE_COUNTER);
-    }
-    
-    if (ANIM_ENABLED(STYLE_RANDOM_POSITION) && animations[STYLE_RANDOM_POSITION] == nullptr) {
-        animations[STYLE_RANDOM_POSITION] = new RandomPositionAnimation(DURATION_RANDOM_POSITION);
-    }
-    
-    if (ANIM_ENABLED(STYLE_COLOR_TRANSITION) && animations[STYLE_COLOR_TRANSITION] == nullptr) {
-        animations[STYLE_COLOR_TRANSITION] = new ColorTransitionAnimation(DURATION_COLOR_TRANSITION, DURATION_COLOR_TRANSITION);
-    }
-    
-    if (ANIM_ENABLED(STYLE_BOUNCING_COUNTER) && animations[STYLE_BOUNCING_COUNTER] == nullptr) {
-        animations[STYLE_BOUNCING_COUNTER] = new BouncingCounterAnimation(DURATION_BOUNCING_COUNTER);
-    }
+    // The instances exist since static initialization, start their cycles now
+    ResetVisitor resetVisitor;
+    animations.visitAll(resetVisitor);
     
     // Initialize with the first enabled style
-    bool foundEnabled = false;
-    for (int i = 0; i < STYLE_COUNT; i++) {
-        if (ANIM_ENABLED(static_cast<AnimationStyle>(i)) && animations[i] != nullptr) {
-            currentStyle = static_cast<AnimationStyle>(i);
-            foundEnabled = true;
-            break;
-        }
-    }
+    currentStyle = AnimationSet<EnabledAnimations>::first();
     
-    if (!foundEnabled) {
-        Serial.println("Warning: No animations are enabled!");
+    if (currentStyle == STYLE_COUNT) {
+        LOG_WARN("No animations are enabled!");
     } else {
-        Serial.println("Animation manager initialized");
+        LOG_INFO("Animation manager initialized");
     }
 }
 
@@ -97,8 +102,8 @@ AnimationStyle AnimationManager::findNextEnabledAnimation(AnimationStyle startSt
         // Move to the next style (wrapping around if necessary)
         style = static_cast<AnimationStyle>((style + 1) % STYLE_COUNT);
         
-        // Return this style if it's enabled and initialized
-        if (ANIM_ENABLED(style) && animations[style] != nullptr) {
+        // Return this style if it's enabled
+        if (isAnimationEnabled(style)) {
             return style;
         }
     }
@@ -114,21 +119,20 @@ AnimationStyle AnimationManager::findNextEnabledAnimation(AnimationStyle startSt
  * @return True if animation was refreshed
  */
 bool AnimationManager::update(unsigned long counter) {
-    // Check for null pointer
-    if (animations[currentStyle] == nullptr) {
-        Serial.printf("Error: Animation style %d not initialized\n", currentStyle);
+    FrameVisitor frameVisitor = {counter, false, false};
+    if (!animations.visit(currentStyle, frameVisitor)) {
+        LOG_ERROR("Animation style %d not initialized", currentStyle);
         return false;
     }
     
-    // Check if current animation is complete
-    if (animations[currentStyle]->isComplete()) {
-        Serial.printf("Animation style %d completed, switching to next\n", currentStyle);
+    // Switch once the current animation is complete
+    if (frameVisitor.complete) {
+        LOG_INFO("Animation style %d completed, switching to next", currentStyle);
         nextAnimation();
         return true; // Force refresh when switching animations
     }
     
-    // Draw the current animation
-    return animations[currentStyle]->draw(counter);
+    return frameVisitor.repainted;
 }
 
 /**
@@ -137,24 +141,20 @@ bool AnimationManager::update(unsigned long counter) {
  */
 void AnimationManager::setAnimationStyle(AnimationStyle style) {
     if (style < 0 || style >= STYLE_COUNT) {
-        Serial.printf("Invalid animation style: %d\n", style);
+        LOG_WARN("Invalid animation style: %d", style);
         return;
     }
     
-    if (!ANIM_ENABLED(style)) {
-        Serial.printf("Animation style %d is disabled in configuration\n", style);
-        return;
-    }
-    
-    if (animations[style] == nullptr) {
-        Serial.printf("Animation style %d not initialized\n", style);
+    if (!isAnimationEnabled(style)) {
+        LOG_WARN("Animation style %d is disabled in configuration", style);
         return;
     }
     
     currentStyle = style;
-    animations[style]->reset(); // Reset the animation timer
+    ResetVisitor resetVisitor;
+    animations.visit(style, resetVisitor); // Reset the animation timer
     
-    Serial.printf("Switched to animation style: %d\n", style);
+    LOG_INFO("Switched to animation style: %d", style);
 }
 
 /**
@@ -172,22 +172,18 @@ AnimationStyle AnimationManager::getCurrentStyle() const {
  */
 void AnimationManager::setAnimationDuration(AnimationStyle style, unsigned long durationMs) {
     if (style < 0 || style >= STYLE_COUNT) {
-        Serial.printf("Invalid animation style: %d\n", style);
-        return;
-    }
-    
-    if (!ANIM_ENABLED(style)) {
-        Serial.printf("Animation style %d is disabled in configuration\n", style);
+        LOG_WARN("Invalid animation style: %d", style);
         return;
     }
     
-    if (animations[style] == nullptr) {
-        Serial.printf("Animation style %d not initialized\n", style);
+    if (!isAnimationEnabled(style)) {
+        LOG_WARN("Animation style %d is disabled in configuration", style);
         return;
     }
     
-    animations[style]->setDuration(durationMs);
-    Serial.printf("Set duration for style %d to %lu ms\n", style, durationMs);
+    DurationVisitor durationVisitor = {durationMs};
+    animations.visit(style, durationVisitor);
+    LOG_INFO("Set duration for style %d to %lu ms", style, durationMs);
 }
 
 /**
@@ -199,8 +195,9 @@ void AnimationManager::nextAnimation() {
     
     // If we couldn't find another enabled animation, just stay on the current one
     if (nextStyle == currentStyle) {
-        animations[currentStyle]->reset(); // Reset the current animation
-        Serial.println("No other enabled animations found, resetting current");
+        ResetVisitor resetVisitor;
+        animations.visit(currentStyle, resetVisitor); // Reset the current animation
+        LOG_DEBUG("No other enabled animations found, resetting current");
     } else {
         // Set the next style
         setAnimationStyle(nextStyle);
@@ -1,33 +1,13 @@
 #ifndef ANIMATION_MANAGER_H
 #define ANIMATION_MANAGER_H
 
-#include "animation_base.h"
-#include "simple_counter_animation.h"
-#include "random_position_animation.h"
-#include "color_transition_animation.h"
-#include "bouncing_counter_animation.h"
-#include "animation_config.h"
-
-// Animation styles enumeration
-enum AnimationStyle {
-    STYLE_SIMPLE_COUNTER = 0,
-    STYLE_RANDOM_POSITION,
-    STYLE_COLOR_TRANSITION,
-    STYLE_BOUNCING_COUNTER,
-    
-    STYLE_COUNT  // Always keep this as last item for tracking the total count
-};
-
-// Helper macro to check if an animation is enabled
-#define ANIM_ENABLED(style) ( \
-    ((style) == STYLE_SIMPLE_COUNTER    ? ANIM_ENABLED_SIMPLE_COUNTER    : \
-    ((style) == STYLE_RANDOM_POSITION   ? ANIM_ENABLED_RANDOM_POSITION   : \
-    ((style) == STYLE_COLOR_TRANSITION  ? ANIM_ENABLED_COLOR_TRANSITION  : \
-    ((style) == STYLE_BOUNCING_COUNTER  ? ANIM_ENABLED_BOUNCING_COUNTER  : 0)))) \
-)
+#include "animation_registry.h"
 
 /**
  * @brief Manages animation styles and transitions
+ *
+ * Only the styles in EnabledAnimations exist, each as a member of the
+ * global manager. Calls to the current style are dispatched statically.
  */
 class AnimationManager {
 public:
@@ -36,11 +16,6 @@ public:
      */
     AnimationManager();
     
-    /**
-     * @brief Destructor
-     */
-    ~AnimationManager();
-    
     /**
      * @brief Initialize the animation manager
      */
@@ -79,9 +54,16 @@ public:
      */
     static bool isAnimationEnabled(AnimationStyle style);
 
+    /**
+     * @brief Get the name of an animation style
+     * @param style The animation style
+     * @return Short lowercase name, "unknown" for invalid styles
+     */
+    static const char* getStyleName(AnimationStyle style);
+
 private:
-    AnimationBase* animations[STYLE_COUNT];  // Array of animation instances
-    AnimationStyle currentStyle;             // Current active animation style
+    AnimationSet<EnabledAnimations> animations;  // Instances of the enabled styles
+    AnimationStyle currentStyle;                 // Current active animation style
     
     /**
      * @brief Switch to the next animation style
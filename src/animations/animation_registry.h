@@ -0,0 +1,237 @@
+#ifndef ANIMATION_REGISTRY_H
+#define ANIMATION_REGISTRY_H
+
+#include <type_traits>
+#include "simple_counter_animation.h"
+#include "random_position_animation.h"
+#include "color_transition_animation.h"
+#include "bouncing_counter_animation.h"
+#include "animation_config.h"
+
+// Animation styles enumeration
+enum AnimationStyle {
+    STYLE_SIMPLE_COUNTER = 0,
+    STYLE_RANDOM_POSITION,
+    STYLE_COLOR_TRANSITION,
+    STYLE_BOUNCING_COUNTER,
+
+    STYLE_COUNT  // Always keep this as last item for tracking the total count
+};
+
+/**
+ * @brief Compile-time description of an animation type
+ *
+ * Specialized once per animation class: its style, whether it is enabled
+ * in animation_config.h and how it is constructed with its configured
+ * duration.
+ */
+template <typename T>
+struct AnimationTraits;
+
+template <>
+struct AnimationTraits<SimpleCounterAnimation> {
+    static const AnimationStyle style = STYLE_SIMPLE_COUNTER;
+    static const bool enabled = ENABLE_SIMPLE_COUNTER;
+    static SimpleCounterAnimation create() {
+        return SimpleCounterAnimation(DURATION_SIMPLE_COUNTER);
+    }
+};
+
+template <>
+struct AnimationTraits<RandomPositionAnimation> {
+    static const AnimationStyle style = STYLE_RANDOM_POSITION;
+    static const bool enabled = ENABLE_RANDOM_POSITION;
+    static RandomPositionAnimation create() {
+        return RandomPositionAnimation(DURATION_RANDOM_POSITION);
+    }
+};
+
+template <>
+struct AnimationTraits<ColorTransitionAnimation> {
+    static const AnimationStyle style = STYLE_COLOR_TRANSITION;
+    static const bool enabled = ENABLE_COLOR_TRANSITION;
+    static ColorTransitionAnimation create() {
+        return ColorTransitionAnimation(DURATION_COLOR_TRANSITION, DURATION_COLOR_TRANSITION);
+    }
+};
+
+template <>
+struct AnimationTraits<BouncingCounterAnimation> {
+    static const AnimationStyle style = STYLE_BOUNCING_COUNTER;
+    static const bool enabled = ENABLE_BOUNCING_COUNTER;
+    static BouncingCounterAnimation create() {
+        return BouncingCounterAnimation(DURATION_BOUNCING_COUNTER);
+    }
+};
+
+/**
+ * @brief Compile-time list of animation types
+ */
+template <typename... Types>
+struct AnimationList {
+};
+
+/**
+ * @brief List with one more type at the front
+ */
+template <typename T, typename List>
+struct PrependAnimation;
+
+template <typename T, typename... Types>
+struct PrependAnimation<T, AnimationList<Types...>> {
+    typedef AnimationList<T, Types...> type;
+};
+
+/**
+ * @brief List of the types enabled in animation_config.h, order is kept
+ */
+template <typename List>
+struct EnabledAnimationsOf;
+
+template <>
+struct EnabledAnimationsOf<AnimationList<>> {
+    typedef AnimationList<> type;
+};
+
+template <typename Head, typename... Tail>
+struct EnabledAnimationsOf<AnimationList<Head, Tail...>> {
+    typedef typename EnabledAnimationsOf<AnimationList<Tail...>>::type Rest;
+    typedef typename std::conditional<AnimationTraits<Head>::enabled,
+                                      typename PrependAnimation<Head, Rest>::type,
+                                      Rest>::type type;
+};
+
+// Every animation type, in the order of AnimationStyle
+typedef AnimationList<SimpleCounterAnimation,
+                      RandomPositionAnimation,
+                      ColorTransitionAnimation,
+                      BouncingCounterAnimation> AllAnimations;
+
+// Types the animation manager instantiates, a disabled type is not named anywhere in the firmware
+typedef EnabledAnimationsOf<AllAnimations>::type EnabledAnimations;
+
+/**
+ * @brief One instance of every type in a list, selected by style
+ *
+ * The instances are plain members, so a global set lives in static
+ * storage. visit() compiles to a chain of compares ending in direct
+ * calls on the concrete type, there is no pointer table and no virtual
+ * call. A visitor is any object with a template operator()(T&).
+ */
+template <typename List>
+class AnimationSet;
+
+template <>
+class AnimationSet<AnimationList<>> {
+public:
+    static constexpr bool contains(AnimationStyle style) {
+        return false;
+    }
+
+    static constexpr AnimationStyle first() {
+        return STYLE_COUNT;
+    }
+
+    template <typename Visitor>
+    bool visit(AnimationStyle style, Visitor& visitor) {
+        return false;
+    }
+
+    template <typename Visitor>
+    void visitAll(Visitor& visitor) {
+    }
+};
+
+template <typename Head, typename... Tail>
+class AnimationSet<AnimationList<Head, Tail...>> {
+public:
+    /**
+     * @brief Constructor, creates every instance with its configured duration
+     */
+    AnimationSet() :
+        head(AnimationTraits<Head>::create()) {
+    }
+
+    /**
+     * @brief Check if the set has an instance of a style
+     * @param style Style to look for
+     * @return True if the style is in the list
+     */
+    static constexpr bool contains(AnimationStyle style) {
+        return style == AnimationTraits<Head>::style || AnimationSet<AnimationList<Tail...>>::contains(style);
+    }
+
+    /**
+     * @brief Get the style of the first instance
+     * @return First style, STYLE_COUNT for an empty set
+     */
+    static constexpr AnimationStyle first() {
+        return AnimationTraits<Head>::style;
+    }
+
+    /**
+     * @brief Call the visitor with the instance of a style
+     * @param style Style of the instance
+     * @param visitor Called with the concrete instance
+     * @return False if the set has no instance of the style
+     */
+    template <typename Visitor>
+    bool visit(AnimationStyle style, Visitor& visitor) {
+        if (style == AnimationTraits<Head>::style) {
+            visitor(head);
+            return true;
+        }
+        return tail.visit(style, visitor);
+    }
+
+    /**
+     * @brief Call the visitor with every instance
+     * @param visitor Called with each concrete instance in list order
+     */
+    template <typename Visitor>
+    void visitAll(Visitor& visitor) {
+        visitor(head);
+        tail.visitAll(visitor);
+    }
+
+private:
+    Head head;                                      // Instance of the first type
+    AnimationSet<AnimationList<Tail...>> tail;      // Instances of the other types
+};
+
+/**
+ * @brief Call visitor.template visitType<T>() for the type of a style
+ *
+ * For code that needs a fresh instance instead of the shared one, such
+ * as the benchmark.
+ */
+template <typename List>
+struct AnimationTypeSwitch;
+
+template <>
+struct AnimationTypeSwitch<AnimationList<>> {
+    template <typename Visitor>
+    static bool visit(AnimationStyle style, Visitor& visitor) {
+        return false;
+    }
+};
+
+template <typename Head, typename... Tail>
+struct AnimationTypeSwitch<AnimationList<Head, Tail...>> {
+    /**
+     * @brief Call the visitor with the type of a style
+     * @param style Style to look for
+     * @param visitor Object with a template visitType<T>()
+     * @return False if the list has no type of the style
+     */
+    template <typename Visitor>
+    static bool visit(AnimationStyle style, Visitor& visitor) {
+        if (style == AnimationTraits<Head>::style) {
+            visitor.template visitType<Head>();
+            return true;
+        }
+        return AnimationTypeSwitch<AnimationList<Tail...>>::visit(style, visitor);
+    }
+};
+
+#endif // ANIMATION_REGISTRY_H
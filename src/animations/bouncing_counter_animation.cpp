@@ -32,9 +32,6 @@ bool BouncingCounterAnimation::draw(unsigned long counter) {
         firstDraw = false;
     }
     
-    // Clear the display for the next frame
-    matrix->fillScreen(0);
-    
     // Convert the counter to a string with leading zeros
     char counterStr[20];
     sprintf(counterStr, "%0*lu", COUNTER_DIGITS, counter);
@@ -74,14 +71,8 @@ bool BouncingCounterAnimation::draw(unsigned long counter) {
         counterColor = colorWheel(random(0, 256)); // Change color on bounce
     }
     
-    // Draw each digit
-    for(uint8_t i = 0; i < COUNTER_DIGITS; i++) {
-        int16_t digitX = posX + i * (digitWidth + digitSpacing);
-        drawDigit(counterStr[i], digitX, posY, textSize, counterColor);
-    }
-    
-    // Always return true to refresh the display for the animation
-    return true;
+    // Draw the digits, the previous position is cleared by the dirty region tracker
+    return renderCounter(counterStr, posX, posY, textSize, counterColor);
 }
 
 /**
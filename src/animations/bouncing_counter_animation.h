@@ -6,7 +6,7 @@
 /**
  * @brief Animation that makes the counter bounce from edge to edge like a screensaver
  */
-class BouncingCounterAnimation : public AnimationBase {
+class BouncingCounterAnimation final : public AnimationBase {
 public:
     /**
      * @brief Constructor with configurable duration and color
@@ -18,7 +18,7 @@ public:
     /**
      * @brief Draw the bouncing counter animation
      * @param counter Current counter value to display
-     * @return True if animation needs to be refreshed
+     * @return True if any pixels were repainted
      */
     virtual bool draw(unsigned long counter) override;
     
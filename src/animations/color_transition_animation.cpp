@@ -2,6 +2,7 @@
 #include "matrix_config.h"
 #include "counter.h"
 #include "color_utils.h"
+#include "clock.h"
 
 /**
  * @brief Constructor with configurable duration
@@ -41,14 +42,8 @@ bool ColorTransitionAnimation::draw(unsigned long counter) {
     int16_t startX = (PANE_WIDTH - totalWidth) / 2;
     int16_t startY = (PANE_HEIGHT - (8 * textSize)) / 2;
     
-    // Draw each digit with the current transition color
-    for(uint8_t i = 0; i < COUNTER_DIGITS; i++) {
-        int16_t digitX = startX + i * (digitWidth + digitSpacing);
-        drawDigit(counterStr[i], digitX, startY, textSize, currentColor);
-    }
-    
-    // Animation needs to refresh on each frame to update the color
-    return true;
+    // Draw the digits, repaints only while the color is still changing
+    return renderCounter(counterStr, startX, startY, textSize, currentColor);
 }
 
 /**
@@ -86,7 +81,7 @@ uint16_t ColorTransitionAnimation::generateRandomColor() {
  * @return Current interpolated color
  */
 uint16_t ColorTransitionAnimation::getCurrentColor() {
-    unsigned long elapsed = millis() - startTime;
+    uint32_t elapsed = clockMillis() - startTime;
     
     // Use a shorter duration for the color transition if specified
     unsigned long effectiveDuration = (colorTransitionDuration > 0 && colorTransitionDuration < duration) 
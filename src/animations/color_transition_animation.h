@@ -6,7 +6,7 @@
 /**
  * @brief Animation that displays the counter with a continuous color transition
  */
-class ColorTransitionAnimation : public AnimationBase {
+class ColorTransitionAnimation final : public AnimationBase {
 public:
     /**
      * @brief Constructor with configurable duration
@@ -18,7 +18,7 @@ public:
     /**
      * @brief Draw the counter with color transition
      * @param counter Current counter value to display
-     * @return True if animation needs to be refreshed
+     * @return True if any pixels were repainted
      */
     virtual bool draw(unsigned long counter) override;
     
@@ -3,6 +3,9 @@
 #include "counter.h"
 #include "color_utils.h"
 
+#define LOG_TAG "animation"
+#include "../logger.h"
+
 /**
  * @brief Constructor with configurable duration and color
  * @param durationMs Animation duration in milliseconds
@@ -48,16 +51,10 @@ bool RandomPositionAnimation::draw(unsigned long counter) {
     if (firstDraw) {
         setRandomPosition(totalWidth, totalHeight);
         firstDraw = false;
-        return true;
-    }
-    
-    // Draw each digit at the random position
-    for(uint8_t i = 0; i < COUNTER_DIGITS; i++) {
-        int16_t digitX = posX + i * (digitWidth + digitSpacing);
-        drawDigit(counterStr[i], digitX, posY, textSize, counterColor);
     }
     
-    return false;
+    // Draw the digits at the random position, only repaints on changes
+    return renderCounter(counterStr, posX, posY, textSize, counterColor);
 }
 
 /**
@@ -83,7 +80,7 @@ void RandomPositionAnimation::setRandomPosition(uint16_t counterWidth, uint16_t
         posY = 0;
     }
     
-    Serial.printf("Set random counter position to: (%d, %d)\n", posX, posY);
+    LOG_DEBUG("Set random counter position to: (%d, %d)", posX, posY);
 }
 
 /**
@@ -6,7 +6,7 @@
 /**
  * @brief Animation that displays counter at random positions
  */
-class RandomPositionAnimation : public AnimationBase {
+class RandomPositionAnimation final : public AnimationBase {
 public:
     /**
      * @brief Constructor with configurable duration and color
@@ -18,7 +18,7 @@ public:
     /**
      * @brief Draw the counter at a random position
      * @param counter Current counter value to display
-     * @return True if animation needs to be refreshed
+     * @return True if any pixels were repainted
      */
     virtual bool draw(unsigned long counter) override;
 
@@ -45,19 +45,9 @@ bool SimpleCounterAnimation::draw(unsigned long counter) {
     int16_t startX = (PANE_WIDTH - totalWidth) / 2;
     int16_t startY = (PANE_HEIGHT - (8 * textSize)) / 2;
     
-    // Draw each digit
-    for(uint8_t i = 0; i < COUNTER_DIGITS; i++) {
-        int16_t digitX = startX + i * (digitWidth + digitSpacing);
-        drawDigit(counterStr[i], digitX, startY, textSize, counterColor);
-    }
-    
-    // Animation only needs to refresh on first draw then stays static
-    if (firstDraw) {
-        firstDraw = false;
-        return true;
-    }
-    
-    return false;
+    // Draw the digits, static frames leave the panel untouched
+    firstDraw = false;
+    return renderCounter(counterStr, startX, startY, textSize, counterColor);
 }
 
 /**
@@ -6,7 +6,7 @@
 /**
  * @brief Simple animation that centers the counter on screen
  */
-class SimpleCounterAnimation : public AnimationBase {
+class SimpleCounterAnimation final : public AnimationBase {
 public:
     /**
      * @brief Constructor with configurable duration and color
@@ -18,7 +18,7 @@ public:
     /**
      * @brief Draw the simple counter animation
      * @param counter Current counter value to display
-     * @return True if animation needs to be refreshed
+     * @return True if any pixels were repainted
      */
     virtual bool draw(unsigned long counter) override;
     
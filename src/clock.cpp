@@ -0,0 +1,132 @@
+#include "clock.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_timer.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+// Time source replaced by setClock(), nullptr for the system clock so the
+// time can be read before any constructor has run
+static Clock* activeClock = nullptr;
+
+/**
+ * @brief Read the hardware clock
+ * @return Microseconds since boot
+ */
+static uint64_t systemMicros() {
+#ifdef ARDUINO
+    return esp_timer_get_time();
+#else
+    static const std::chrono::steady_clock::time_point boot = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - boot).count();
+#endif
+}
+
+/**
+ * @brief Get the current time
+ * @return Microseconds since boot, never decreases
+ */
+uint64_t SystemClock::nowMicros() {
+    return systemMicros();
+}
+
+/**
+ * @brief Wait, other tasks run meanwhile except for the sub-millisecond rest
+ * @param us Microseconds to wait
+ */
+void SystemClock::sleepMicros(uint64_t us) {
+#ifdef ARDUINO
+    delay(us / 1000);
+    delayMicroseconds(us % 1000);
+#else
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+#endif
+}
+
+/**
+ * @brief Constructor
+ * @param startMicros Initial time in microseconds
+ */
+VirtualClock::VirtualClock(uint64_t startMicros) :
+    now(startMicros) {
+}
+
+/**
+ * @brief Get the current time
+ * @return Microseconds set by the owner of the clock
+ */
+uint64_t VirtualClock::nowMicros() {
+    return now.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Advance the time instead of waiting
+ * @param us Microseconds to advance
+ */
+void VirtualClock::sleepMicros(uint64_t us) {
+    advanceMicros(us);
+}
+
+/**
+ * @brief Advance the time
+ * @param us Microseconds to advance
+ */
+void VirtualClock::advanceMicros(uint64_t us) {
+    now.fetch_add(us, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Advance the time
+ * @param ms Milliseconds to advance
+ */
+void VirtualClock::advanceMillis(uint32_t ms) {
+    advanceMicros((uint64_t)ms * 1000);
+}
+
+/**
+ * @brief Jump to a point in time, may go backwards
+ * @param us New time in microseconds
+ */
+void VirtualClock::setMicros(uint64_t us) {
+    now.store(us, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Replace the time source, call before any task reads the time
+ * @param clock New clock, nullptr restores the system clock
+ */
+void setClock(Clock* clock) {
+    activeClock = clock;
+}
+
+/**
+ * @brief Get the current time of the active clock
+ * @return Microseconds since boot
+ */
+uint64_t clockMicros() {
+    return activeClock != nullptr ? activeClock->nowMicros() : systemMicros();
+}
+
+/**
+ * @brief Get the current time of the active clock, drop-in for millis()
+ * @return Milliseconds since boot, wraps after 49.7 days like millis() on the device,
+ *         also on 64-bit hosts
+ */
+uint32_t clockMillis() {
+    return (uint32_t)(clockMicros() / 1000);
+}
+
+/**
+ * @brief Wait on the active clock, a virtual clock just advances
+ * @param us Microseconds to wait
+ */
+void clockSleepMicros(uint64_t us) {
+    if (activeClock != nullptr) {
+        activeClock->sleepMicros(us);
+    } else {
+        SystemClock().sleepMicros(us);
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief Time source of the firmware
+ *
+ * Everything that schedules or times out reads the time through
+ * clockMicros()/clockMillis() instead of millis(), so tests and host
+ * simulations can replace the clock with a VirtualClock and run days of
+ * polling, rotation and timeouts in a fraction of a second.
+ *
+ * Millisecond timestamps are kept in uint32_t, never unsigned long, so
+ * they wrap on a 64-bit host exactly as on the device.
+ */
+class Clock {
+public:
+    virtual ~Clock() {
+    }
+
+    /**
+     * @brief Get the current time
+     * @return Microseconds since boot, never decreases
+     */
+    virtual uint64_t nowMicros() = 0;
+
+    /**
+     * @brief Wait, or let time pass on a virtual clock
+     * @param us Microseconds to wait
+     */
+    virtual void sleepMicros(uint64_t us) = 0;
+};
+
+/**
+ * @brief Hardware clock, esp_timer on the device and the monotonic clock on the host
+ */
+class SystemClock : public Clock {
+public:
+    uint64_t nowMicros() override;
+    void sleepMicros(uint64_t us) override;
+};
+
+/**
+ * @brief Clock that only moves when told to
+ *
+ * Safe to read from any task while one task advances it.
+ */
+class VirtualClock : public Clock {
+public:
+    /**
+     * @brief Constructor
+     * @param startMicros Initial time in microseconds
+     */
+    explicit VirtualClock(uint64_t startMicros = 0);
+
+    uint64_t nowMicros() override;
+
+    /**
+     * @brief Advance the time instead of waiting
+     * @param us Microseconds to advance
+     */
+    void sleepMicros(uint64_t us) override;
+
+    /**
+     * @brief Advance the time
+     * @param us Microseconds to advance
+     */
+    void advanceMicros(uint64_t us);
+
+    /**
+     * @brief Advance the time
+     * @param ms Milliseconds to advance
+     */
+    void advanceMillis(uint32_t ms);
+
+    /**
+     * @brief Jump to a point in time, may go backwards
+     * @param us New time in microseconds
+     */
+    void setMicros(uint64_t us);
+
+private:
+    std::atomic<uint64_t> now;    // Current time in microseconds
+};
+
+/**
+ * @brief Replace the time source, call before any task reads the time
+ * @param clock New clock, nullptr restores the system clock
+ */
+void setClock(Clock* clock);
+
+/**
+ * @brief Get the current time of the active clock
+ * @return Microseconds since boot
+ */
+uint64_t clockMicros();
+
+/**
+ * @brief Get the current time of the active clock, drop-in for millis()
+ * @return Milliseconds since boot, wraps after 49.7 days like millis() on the device,
+ *         also on 64-bit hosts
+ */
+uint32_t clockMillis();
+
+/**
+ * @brief Wait on the active clock, a virtual clock just advances
+ * @param us Microseconds to wait
+ */
+void clockSleepMicros(uint64_t us);
+
+#endif // CLOCK_H
@@ -1,5 +1,20 @@
 #include "color_utils.h"
 
+/**
+ * @brief Pack a color into RGB565 like MatrixPanel_I2S_DMA::color565()
+ *
+ * Does not need the panel, so colors can be picked before initMatrix(),
+ * e.g. by the animations constructed during static initialization.
+ *
+ * @param r Red component (0-255)
+ * @param g Green component (0-255)
+ * @param b Blue component (0-255)
+ * @return 16-bit color value
+ */
+static uint16_t packColor565(uint8_t r, uint8_t g, uint8_t b) {
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
 /**
  * @brief Generate a color based on wheel position (0-255)
  * 
@@ -11,12 +26,12 @@
  */
 uint16_t colorWheel(uint8_t pos) {
     if(pos < 85) {
-        return matrix->color565(pos * 3, 255 - pos * 3, 0);
+        return packColor565(pos * 3, 255 - pos * 3, 0);
     } else if(pos < 170) {
         pos -= 85;
-        return matrix->color565(255 - pos * 3, 0, pos * 3);
+        return packColor565(255 - pos * 3, 0, pos * 3);
     } else {
         pos -= 170;
-        return matrix->color565(0, pos * 3, 255 - pos * 3);
+        return packColor565(0, pos * 3, 255 - pos * 3);
     }
 }
\ No newline at end of file
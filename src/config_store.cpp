@@ -0,0 +1,290 @@
+#include "config_store.h"
+#include <SPIFFS.h>
+#include <stddef.h>
+#include "fnv1a.h"
+
+#define LOG_TAG "config"
+#include "logger.h"
+
+// Marks a configuration file written by this firmware
+static const uint32_t DEVICE_CONFIG_MAGIC = 0x43464731; // "CFG1"
+
+// Global configuration store instance
+ConfigStore configStore;
+
+/**
+ * @brief Read one line of a text file, without line end and surrounding whitespace
+ * @param file Open file
+ * @param line Buffer for the line, longer lines are cut off
+ * @param size Size of the buffer
+ * @return False at the end of the file
+ */
+static bool readTextLine(File& file, char* line, size_t size) {
+    int c = file.read();
+    if (c < 0) {
+        return false;
+    }
+
+    size_t length = 0;
+    while (c >= 0 && c != '\n') {
+        if (length < size - 1) {
+            line[length++] = (char)c;
+        }
+        c = file.read();
+    }
+
+    while (length > 0 && isspace((unsigned char)line[length - 1])) {
+        length--;
+    }
+    line[length] = '\0';
+
+    size_t start = 0;
+    while (isspace((unsigned char)line[start])) {
+        start++;
+    }
+    memmove(line, line + start, length - start + 1);
+    return true;
+}
+
+/**
+ * @brief Constructor, starts with an empty configuration
+ */
+ConfigStore::ConfigStore() {
+    memset(&config, 0, sizeof(config));
+    seal(config);
+}
+
+/**
+ * @brief Load the configuration, SPIFFS must be mounted
+ * @return True if a stored configuration was found or imported
+ */
+bool ConfigStore::begin() {
+    DeviceConfig loaded;
+
+    if (readFile(CONFIG_FILE, loaded)) {
+        config = loaded;
+    } else if (readFile(CONFIG_TEMP_FILE, loaded)) {
+        // Power was lost after the old file was removed, finish the write
+        LOG_INFO("Recovered configuration from temp file");
+        config = loaded;
+        SPIFFS.rename(CONFIG_TEMP_FILE, CONFIG_FILE);
+    } else if (importText(loaded)) {
+        config = loaded;
+        if (!writeFile(config)) {
+            LOG_ERROR("Failed to write configuration file");
+        }
+    } else {
+        LOG_WARN("No configuration found");
+        return false;
+    }
+
+    LOG_INFO("Configuration loaded: %u WiFi networks", (unsigned)config.networkCount);
+    return true;
+}
+
+/**
+ * @brief Get the loaded configuration
+ * @return Configuration in RAM
+ */
+const DeviceConfig& ConfigStore::get() const {
+    return config;
+}
+
+/**
+ * @brief Store a network as the preferred one
+ * @param ssid Network SSID
+ * @param password Network password
+ * @return True if the new configuration was written
+ */
+bool ConfigStore::addNetwork(const char* ssid, const char* password) {
+    DeviceConfig newConfig;
+    memset(&newConfig, 0, sizeof(newConfig));
+
+    if (!appendNetwork(newConfig, ssid, password)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < config.networkCount; i++) {
+        if (strcmp(config.networks[i].ssid, ssid) != 0) {
+            appendNetwork(newConfig, config.networks[i].ssid, config.networks[i].password);
+        }
+    }
+    seal(newConfig);
+
+    if (!writeFile(newConfig)) {
+        return false;
+    }
+    config = newConfig;
+    return true;
+}
+
+/**
+ * @brief Read and check a configuration file
+ * @param path File to read
+ * @param loaded Read configuration
+ * @return True if the file holds a valid configuration of this version
+ */
+bool ConfigStore::readFile(const char* path, DeviceConfig& loaded) {
+    if (!SPIFFS.exists(path)) {
+        return false;
+    }
+
+    File file = SPIFFS.open(path, "r");
+    if (!file) {
+        return false;
+    }
+    memset(&loaded, 0, sizeof(loaded));
+    size_t length = file.read(reinterpret_cast<uint8_t*>(&loaded), sizeof(loaded));
+    file.close();
+
+    if (length < offsetof(DeviceConfig, networkCount) || loaded.magic != DEVICE_CONFIG_MAGIC) {
+        LOG_WARN("Invalid configuration file %s", path);
+        return false;
+    }
+
+    // Older layouts would be migrated here
+    if (loaded.version != CONFIG_VERSION || loaded.size != sizeof(DeviceConfig)) {
+        LOG_WARN("Unsupported configuration version %u in %s", loaded.version, path);
+        return false;
+    }
+
+    if (length != sizeof(loaded) || loaded.checksum != checksumOf(loaded) ||
+        loaded.networkCount > WIFI_NETWORKS_MAX) {
+        LOG_WARN("Corrupted configuration file %s", path);
+        return false;
+    }
+
+    // Never trust strings from flash to be terminated
+    for (uint32_t i = 0; i < loaded.networkCount; i++) {
+        loaded.networks[i].ssid[WIFI_SSID_MAX - 1] = '\0';
+        loaded.networks[i].password[WIFI_PASSWORD_MAX - 1] = '\0';
+    }
+    return true;
+}
+
+/**
+ * @brief Replace the configuration file
+ * @param newConfig Configuration to write, must be sealed
+ * @return True if the new configuration is in place
+ */
+bool ConfigStore::writeFile(const DeviceConfig& newConfig) {
+    File file = SPIFFS.open(CONFIG_TEMP_FILE, "w");
+    if (!file) {
+        LOG_ERROR("Failed to open configuration temp file");
+        return false;
+    }
+    size_t written = file.write(reinterpret_cast<const uint8_t*>(&newConfig), sizeof(newConfig));
+    file.close();
+
+    if (written != sizeof(newConfig)) {
+        LOG_ERROR("Failed to write configuration temp file");
+        SPIFFS.remove(CONFIG_TEMP_FILE);
+        return false;
+    }
+
+    // SPIFFS cannot rename onto an existing file, begin() recovers from the temp file
+    if (SPIFFS.exists(CONFIG_FILE)) {
+        SPIFFS.remove(CONFIG_FILE);
+    }
+    if (!SPIFFS.rename(CONFIG_TEMP_FILE, CONFIG_FILE)) {
+        LOG_ERROR("Failed to replace configuration file");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Import networks from the legacy text file
+ * @param imported Configuration to fill
+ * @return True if at least one network was imported
+ */
+bool ConfigStore::importText(DeviceConfig& imported) {
+    memset(&imported, 0, sizeof(imported));
+
+    File textFile = SPIFFS.open(CONFIG_TEXT_FILE, "r");
+    if (!textFile) {
+        LOG_WARN("Failed to open WiFi config file");
+        return false;
+    }
+
+    // One SSID:PASSWORD entry per line, or the legacy format with the
+    // SSID on the first line and the password on the second
+    char line[WIFI_SSID_MAX + WIFI_PASSWORD_MAX];
+    char legacySsid[WIFI_SSID_MAX] = "";
+    bool firstLine = true;
+
+    while (readTextLine(textFile, line, sizeof(line))) {
+        if (legacySsid[0] != '\0') {
+            if (line[0] == '\0') {
+                LOG_WARN("WiFi config file format is invalid");
+            } else {
+                appendNetwork(imported, legacySsid, line);
+            }
+            break;
+        }
+
+        if (line[0] == '\0') continue;
+
+        char* delimiter = strchr(line, ':');
+        if (delimiter == nullptr) {
+            if (firstLine) {
+                snprintf(legacySsid, sizeof(legacySsid), "%s", line);
+                firstLine = false;
+            } else {
+                LOG_WARN("Invalid format in WiFi config (expected SSID:PASSWORD)");
+            }
+            continue;
+        }
+
+        firstLine = false;
+        *delimiter = '\0';
+        appendNetwork(imported, line, delimiter + 1);
+    }
+    textFile.close();
+
+    seal(imported);
+    LOG_INFO("Imported %u WiFi networks from %s", (unsigned)imported.networkCount, CONFIG_TEXT_FILE);
+    return imported.networkCount > 0;
+}
+
+/**
+ * @brief Append a network to a configuration
+ * @param target Configuration to extend
+ * @param ssid Network SSID
+ * @param password Network password
+ * @return True if the network was added
+ */
+bool ConfigStore::appendNetwork(DeviceConfig& target, const char* ssid, const char* password) {
+    if (ssid[0] == '\0' || strlen(ssid) >= WIFI_SSID_MAX || strlen(password) >= WIFI_PASSWORD_MAX) {
+        LOG_WARN("Invalid WiFi network, skipped");
+        return false;
+    }
+    if (target.networkCount >= WIFI_NETWORKS_MAX) {
+        LOG_WARN("More than %d WiFi networks, skipped %s", WIFI_NETWORKS_MAX, ssid);
+        return false;
+    }
+
+    WiFiCredentials& network = target.networks[target.networkCount++];
+    snprintf(network.ssid, sizeof(network.ssid), "%s", ssid);
+    snprintf(network.password, sizeof(network.password), "%s", password);
+    return true;
+}
+
+/**
+ * @brief Fill in header and checksum of a configuration
+ * @param target Configuration to seal
+ */
+void ConfigStore::seal(DeviceConfig& target) {
+    target.magic = DEVICE_CONFIG_MAGIC;
+    target.version = CONFIG_VERSION;
+    target.size = sizeof(DeviceConfig);
+    target.checksum = checksumOf(target);
+}
+
+/**
+ * @brief Compute the checksum of a configuration
+ * @param source Configuration to checksum
+ * @return FNV-1a hash of all fields before the checksum
+ */
+uint32_t ConfigStore::checksumOf(const DeviceConfig& source) {
+    return fnv1a(FNV1A_SEED, &source, offsetof(DeviceConfig, checksum));
+}
@@ -0,0 +1,128 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+
+// Configuration files in SPIFFS
+#define CONFIG_FILE "/config.bin"                  // Typed configuration
+#define CONFIG_TEMP_FILE "/config.tmp"             // New configuration until it replaces CONFIG_FILE
+#define CONFIG_TEXT_FILE "/wifi_config.txt"        // Imported when there is no valid CONFIG_FILE
+#define CONFIG_VERSION 1                           // Layout version of DeviceConfig
+
+// Field sizes (including the terminating null)
+#define WIFI_SSID_MAX 33                           // Maximum SSID length
+#define WIFI_PASSWORD_MAX 65                       // Maximum password length
+#define WIFI_NETWORKS_MAX 8                        // Maximum number of configured networks
+
+/**
+ * @brief Credentials of one configured network
+ */
+struct WiFiCredentials {
+    char ssid[WIFI_SSID_MAX];                      // Network SSID
+    char password[WIFI_PASSWORD_MAX];              // Network password
+};
+
+/**
+ * @brief Device configuration as stored in CONFIG_FILE
+ */
+struct DeviceConfig {
+    uint32_t magic;                                // Marks a configuration file
+    uint16_t version;                              // CONFIG_VERSION when written
+    uint16_t size;                                 // sizeof(DeviceConfig) when written
+    uint32_t networkCount;                         // Used entries in networks
+    WiFiCredentials networks[WIFI_NETWORKS_MAX];   // Configured networks, preferred first
+    uint32_t checksum;                             // Checksum of the fields above
+};
+
+/**
+ * @brief Loads the device configuration once at boot and keeps it in RAM
+ *
+ * Readers get a reference to the loaded struct and never touch the
+ * filesystem or the heap. Changes are written to CONFIG_TEMP_FILE first,
+ * which then replaces CONFIG_FILE. If power is lost in between, the
+ * next boot picks up the complete temp file. Without a valid
+ * configuration file the legacy text file CONFIG_TEXT_FILE is imported.
+ */
+class ConfigStore {
+public:
+    /**
+     * @brief Constructor, starts with an empty configuration
+     */
+    ConfigStore();
+
+    /**
+     * @brief Load the configuration, SPIFFS must be mounted
+     * @return True if a stored configuration was found or imported
+     */
+    bool begin();
+
+    /**
+     * @brief Get the loaded configuration
+     * @return Configuration in RAM
+     */
+    const DeviceConfig& get() const;
+
+    /**
+     * @brief Store a network as the preferred one
+     *
+     * An existing entry with the same SSID is replaced, the other
+     * networks are kept behind it as long as they fit.
+     *
+     * @param ssid Network SSID
+     * @param password Network password
+     * @return True if the new configuration was written
+     */
+    bool addNetwork(const char* ssid, const char* password);
+
+private:
+    DeviceConfig config;            // Loaded configuration
+
+    /**
+     * @brief Read and check a configuration file
+     * @param path File to read
+     * @param loaded Read configuration
+     * @return True if the file holds a valid configuration of this version
+     */
+    static bool readFile(const char* path, DeviceConfig& loaded);
+
+    /**
+     * @brief Replace the configuration file
+     * @param newConfig Configuration to write, must be sealed
+     * @return True if the new configuration is in place
+     */
+    static bool writeFile(const DeviceConfig& newConfig);
+
+    /**
+     * @brief Import networks from the legacy text file
+     * @param imported Configuration to fill
+     * @return True if at least one network was imported
+     */
+    static bool importText(DeviceConfig& imported);
+
+    /**
+     * @brief Append a network to a configuration
+     * @param target Configuration to extend
+     * @param ssid Network SSID
+     * @param password Network password
+     * @return True if the network was added
+     */
+    static bool appendNetwork(DeviceConfig& target, const char* ssid, const char* password);
+
+    /**
+     * @brief Fill in header and checksum of a configuration
+     * @param target Configuration to seal
+     */
+    static void seal(DeviceConfig& target);
+
+    /**
+     * @brief Compute the checksum of a configuration
+     * @param source Configuration to checksum
+     * @return FNV-1a hash of all fields before the checksum
+     */
+    static uint32_t checksumOf(const DeviceConfig& source);
+};
+
+// Global configuration store instance
+extern ConfigStore configStore;
+
+#endif // CONFIG_STORE_H
@@ -1,39 +1,102 @@
 #include "counter.h"
 #include "matrix_config.h"
 #include "color_utils.h"
+#include "dirty_region.h"
+#include "glyph_cache.h"
+#include "http_fetch.h"
+#include "metrics_json_scanner.h"
+#include "poll_scheduler.h"
+#include "sse_parser.h"
+#include "counter_store.h"
+#include "clock.h"
 #include <WiFi.h>
-#include <HTTPClient.h>
-#include <ArduinoJson.h>
+
+#define LOG_TAG "counter"
+#include "logger.h"
 
 // Private counter variables
 static unsigned long counter = 0;
 static unsigned long prevCounter = 0; // Track previous value for comparison
-static unsigned long lastCounterUpdate = 0;
-static const char* API_ENDPOINT = "http://172.16.10.190:5000/api/instagram/metrics";
+static const char* API_ENDPOINT = COUNTER_API_BASE "/api/instagram/metrics";
+static const char* API_STREAM_ENDPOINT = COUNTER_API_BASE "/api/instagram/metrics/stream";
 static bool lastRequestSuccessful = false; // Track if the last API request was successful
+static FetchStats fetchStats = {}; // Outcomes and phase latencies of the updates
+static uint32_t parseMicros = 0; // Time spent scanning the current response body
+static bool counterFresh = false; // Counter was confirmed by the API since boot
+static char counterLastUpdated[METRICS_TIMESTAMP_MAX] = ""; // Server timestamp of the counter
+
+// Last good value, shown right after boot until the API answers
+static CounterStore counterStore;
+
+// Non-blocking API client, used by both the async and the blocking fetch
+static HttpFetch apiFetch;
+static const unsigned long API_REQUEST_TIMEOUT = 45000; // Request timeout in milliseconds
 
-// Async API variables
-static HTTPClient asyncHttp;
-static APIRequestState apiRequestState = API_IDLE;
-static unsigned long apiRequestStartTime = 0;
+// Extracts the response fields while the body is being received
+static MetricsJsonScanner metricsScanner;
+
+// Decides when the next API poll is due
+static PollScheduler pollScheduler;
+
+// Push updates over server-sent events, polling is the fallback
+static HttpFetch streamFetch;
+static SseParser streamParser;
+static MetricsJsonScanner streamScanner;
+static bool streamLive = false; // Stream is open and delivering
+static bool streamWaiting = false; // Waiting before reopening
+static uint32_t streamLastActivity = 0; // Last byte or start of the attempt
+static uint32_t streamClosedAt = 0; // Time the stream was closed
+static unsigned long streamWaitDelay = 0; // Delay before reopening
+static unsigned long streamRetryDelay = COUNTER_STREAM_RETRY_MIN; // Next delay after a failed attempt
 
 // Counter display color
 static const uint16_t COUNTER_COLOR = 0x4A1F; // Purple-blue color in RGB565 format
 
+// Forward declarations of the shared response handlers
+static bool handleCounterResponse();
+static void acceptCounterValue(unsigned long value, const char* lastUpdated);
+static void markCounterFresh();
+static void recordRequestResult(bool success);
+static void scanResponseBody(const char* data, size_t length, void* context);
+static void feedCounterStream(const char* data, size_t length, void* context);
+static void handleStreamEvent(const char* event, const char* data, void* context);
+static void closeCounterStream(uint32_t now);
+
 /**
- * @brief Initialize the counter
+ * @brief Initialize the counter with the last stored value, does not block on the network
  */
 void initCounter() {
     counter = 0;
     prevCounter = 0;
-    lastCounterUpdate = millis();
     lastRequestSuccessful = false;
+    counterFresh = false;
+    counterLastUpdated[0] = '\0';
     
-    // Try to get initial value from API
-    if(WiFi.status() == WL_CONNECTED) {
-        fetchCounterFromAPI();
+    // Show the last known value right away, it is marked stale until confirmed
+    if (counterStore.load(counter, counterLastUpdated, sizeof(counterLastUpdated))) {
+        prevCounter = counter;
+        LOG_INFO("Restored follower count %lu (Last updated: %s)", counter, counterLastUpdated);
+    } else {
+        LOG_INFO("No stored follower count");
+    }
+    
+    // The first poll is due immediately, the network task runs it in the background
+    pollScheduler.reset(clockMillis());
+    
+    if (!apiFetch.begin(API_ENDPOINT)) {
+        LOG_WARN("Invalid API endpoint: %s", API_ENDPOINT);
     }
-    displayCounter();
+    apiFetch.setTimeout(API_REQUEST_TIMEOUT);
+    apiFetch.setBodyHandler(scanResponseBody, nullptr);
+    
+    // The stream stays open indefinitely, liveness is checked in updateCounterStream()
+    if (!streamFetch.begin(API_STREAM_ENDPOINT)) {
+        LOG_WARN("Invalid API stream endpoint: %s", API_STREAM_ENDPOINT);
+    }
+    streamFetch.setTimeout(0);
+    streamFetch.setAcceptType("text/event-stream");
+    streamFetch.setBodyHandler(feedCounterStream, nullptr);
+    streamParser.setHandler(handleStreamEvent, nullptr);
 }
 
 /**
@@ -41,141 +104,215 @@ void initCounter() {
  * @return True if successful
  */
 bool fetchCounterFromAPI() {
+    // Check if WiFi is connected
+    if(WiFi.status() != WL_CONNECTED) {
+        LOG_WARN("WiFi not connected, can't update follower count (status %d)", (int)WiFi.status());
+        return false;
+    }
+    
+    LOG_DEBUG("Fetching follower count from %s", API_ENDPOINT);
+    
+    // Only one request at a time
+    if (!apiFetch.start()) {
+        LOG_DEBUG("API request already in progress");
+        return false;
+    }
+    metricsScanner.reset();
+    parseMicros = 0;
+    
+    // Drive the non-blocking request to completion
+    while (apiFetch.poll() != API_REQUEST_COMPLETE) {
+        clockSleepMicros(1000);
+    }
+    
+    return handleCounterResponse();
+}
+
+/**
+ * @brief Evaluate the completed API request and update the counter
+ * @return True if the counter is up to date with the API
+ */
+static bool handleCounterResponse() {
     bool success = false;
+    int httpResponseCode = apiFetch.getResponseCode();
     
-    // Check if WiFi is connected
-    if(WiFi.status() == WL_CONNECTED) {
-        HTTPClient http;
-        
-        Serial.println("Fetching follower count from API...");
-        Serial.print("API Endpoint: ");
-        Serial.println(API_ENDPOINT);
-        
-        // Set HTTP request timeout to 30 seconds
-        http.setTimeout(45000);
-        
-        // Start HTTP connection
-        http.begin(API_ENDPOINT);
-        
-        // Make GET request
-        int httpResponseCode = http.GET();
-        
-        Serial.print("HTTP Response Code: ");
-        Serial.println(httpResponseCode);
-        
-        // Handle error codes
-        if(httpResponseCode < 0) {
-            logHttpError(httpResponseCode);
-        }
-        
-        if(httpResponseCode == 200) {
-            // Successful response
-            String payload = http.getString();
-            Serial.println("API Response: " + payload);
+    LOG_DEBUG("HTTP Response Code: %d", httpResponseCode);
+    
+    // Handle error codes
+    if(httpResponseCode < 0) {
+        logHttpError(httpResponseCode);
+    }
+    
+    if(httpResponseCode == 200) {
+        // The body has already been scanned while it was received
+        if(metricsScanner.isComplete() && metricsScanner.hasFollowersCount()) {
+            acceptCounterValue(metricsScanner.getFollowersCount(), metricsScanner.getLastUpdated());
             
-            // Parse JSON response
-            DynamicJsonDocument doc(1024);
-            DeserializationError error = deserializeJson(doc, payload);
+            LOG_INFO("Updated follower count for %s: %lu (Last updated: %s)",
+                metricsScanner.getUsername(), counter, metricsScanner.getLastUpdated());
             
-            if(!error) {
-                // Extract follower count
-                unsigned long followers = doc["followers_count"];
-                counter = followers;
+            // Following polls only transfer the body if the data changed
+            apiFetch.useResponseValidators();
                 
-                String username = doc["username"].as<String>();
-                String lastUpdated = doc["last_updated"].as<String>();
-                
-                Serial.printf("Updated follower count for %s: %lu (Last updated: %s)\n", 
-                    username.c_str(), counter, lastUpdated.c_str());
-                    
-                success = true;
-                lastRequestSuccessful = true;
+            success = true;
+        } else {
+            if(metricsScanner.hasError()) {
+                LOG_WARN("JSON parsing error: invalid JSON");
+            } else if(!metricsScanner.isComplete()) {
+                LOG_WARN("JSON parsing error: incomplete JSON");
             } else {
-                Serial.print("JSON parsing error: ");
-                Serial.println(error.c_str());
-                lastRequestSuccessful = false;
+                LOG_WARN("JSON parsing error: followers_count missing");
             }
-        } else {
-            Serial.print("HTTP Error: ");
-            Serial.println(httpResponseCode);
-            lastRequestSuccessful = false;
+            apiFetch.clearValidators();
         }
-        
-        http.end();
-        Serial.println("HTTP connection closed");
-        
-        // Update the status indicator with WiFi connected and the API request status
-        updateStatusIndicator(true, lastRequestSuccessful);
+    } else if(httpResponseCode == 304) {
+        // Data has not changed since the last accepted response, nothing to parse
+        LOG_DEBUG("Follower count not modified: %lu", counter);
+        markCounterFresh();
+        success = true;
     } else {
-        Serial.println("WiFi not connected, can't update follower count");
-        Serial.print("WiFi status: ");
-        Serial.println(WiFi.status());
-        
-        // WiFi is not connected, set status indicator to disconnected
-        updateStatusIndicator(false, false);
+        LOG_WARN("HTTP Error: %d", httpResponseCode);
+    }
+    recordRequestResult(success);
+    
+    // Phase latencies, phases that did not happen are left out
+    const HttpFetchTiming& timing = apiFetch.getTiming();
+    if (timing.resolve > 0) {
+        fetchStats.resolve.record(timing.resolve);
+    }
+    if (timing.connect > 0) {
+        fetchStats.connect.record(timing.connect);
+    }
+    if (httpResponseCode > 0) {
+        fetchStats.firstByte.record(timing.firstByte);
     }
+    if (httpResponseCode == 200) {
+        fetchStats.parse.record(parseMicros);
+    }
+    
+    // Time the next poll from the outcome and the server's hints
+    uint32_t now = clockMillis();
+    if(success) {
+        pollScheduler.onSuccess(now, apiFetch.getMaxAge(),
+            httpResponseCode == 200 ? metricsScanner.getLastUpdated() : nullptr);
+    } else {
+        pollScheduler.onFailure(now, apiFetch.getRetryAfter());
+    }
+    LOG_DEBUG("Next counter poll in %lu s (%u failures in a row)",
+        pollScheduler.getTimeUntilDue(now) / 1000, pollScheduler.getFailureCount());
+    
+    // Finish the request, the connection stays open for the next poll if possible
+    apiFetch.end();
+    LOG_DEBUG("API connection: %lu reuses, %lu reconnects, %lu connects",
+        (unsigned long)apiFetch.getReuseCount(), (unsigned long)apiFetch.getReconnectCount(),
+        (unsigned long)apiFetch.getConnectCount());
     
     return success;
 }
 
+/**
+ * @brief Take over a follower count received from the API
+ * @param value New follower count
+ * @param lastUpdated Server timestamp of the value
+ */
+static void acceptCounterValue(unsigned long value, const char* lastUpdated) {
+    // Store the previous counter value
+    prevCounter = counter;
+    counter = value;
+    snprintf(counterLastUpdated, sizeof(counterLastUpdated), "%s", lastUpdated);
+    markCounterFresh();
+    
+    // Keep it for the next boot, flash writes are coalesced by the store
+    counterStore.update(value, lastUpdated, clockMillis());
+}
+
+/**
+ * @brief Remember the outcome of a counter update
+ * @param success True if the update delivered a valid counter
+ */
+static void recordRequestResult(bool success) {
+    lastRequestSuccessful = success;
+    if (success) {
+        fetchStats.successCount++;
+    } else {
+        fetchStats.failureCount++;
+    }
+}
+
+/**
+ * @brief Mark the counter as confirmed by the API
+ */
+static void markCounterFresh() {
+    // Boot to first confirmed value, the key number after a power outage
+    if (!counterFresh) {
+        LOG_INFO("First counter update %lu ms after boot", (unsigned long)clockMillis());
+    }
+    counterFresh = true;
+}
+
+/**
+ * @brief Feed received body bytes to the response scanner
+ * @param data Received body bytes
+ * @param length Number of bytes
+ * @param context Unused
+ */
+static void scanResponseBody(const char* data, size_t length, void* context) {
+    uint64_t startMicros = clockMicros();
+    metricsScanner.feed(data, length);
+    parseMicros += clockMicros() - startMicros;
+}
+
 /**
  * @brief Log HTTP error codes with descriptions
  * @param httpResponseCode The error code to log
  */
 void logHttpError(int httpResponseCode) {
     switch(httpResponseCode) {
-        case HTTPC_ERROR_CONNECTION_REFUSED:
-            Serial.println("Error: Server refused connection");
+        case HTTP_FETCH_ERROR_CONNECTION_REFUSED:
+            LOG_WARN("Server refused connection");
             break;
-        case HTTPC_ERROR_SEND_HEADER_FAILED:
-            Serial.println("Error: Failed to send headers");
+        case HTTP_FETCH_ERROR_SEND_FAILED:
+            LOG_WARN("Failed to send request");
             break;
-        case HTTPC_ERROR_SEND_PAYLOAD_FAILED:
-            Serial.println("Error: Failed to send payload");
+        case HTTP_FETCH_ERROR_NOT_CONNECTED:
+            LOG_WARN("Not connected to server");
             break;
-        case HTTPC_ERROR_NOT_CONNECTED:
-            Serial.println("Error: Not connected to server");
+        case HTTP_FETCH_ERROR_CONNECTION_LOST:
+            LOG_WARN("Connection lost");
             break;
-        case HTTPC_ERROR_CONNECTION_LOST:
-            Serial.println("Error: Connection lost");
+        case HTTP_FETCH_ERROR_NO_HTTP_SERVER:
+            LOG_WARN("Not an HTTP server");
             break;
-        case HTTPC_ERROR_NO_STREAM:
-            Serial.println("Error: No data stream");
+        case HTTP_FETCH_ERROR_TOO_LARGE:
+            LOG_WARN("Response too large");
             break;
-        case HTTPC_ERROR_NO_HTTP_SERVER:
-            Serial.println("Error: Not an HTTP server");
+        case HTTP_FETCH_ERROR_ENCODING:
+            LOG_WARN("Transfer encoding error");
             break;
-        case HTTPC_ERROR_TOO_LESS_RAM:
-            Serial.println("Error: Not enough RAM");
+        case HTTP_FETCH_ERROR_READ_TIMEOUT:
+            LOG_WARN("Read timeout");
             break;
-        case HTTPC_ERROR_ENCODING:
-            Serial.println("Error: Transfer encoding error");
+        case HTTP_FETCH_ERROR_RESOLVE_FAILED:
+            LOG_WARN("Host name lookup failed");
             break;
-        case HTTPC_ERROR_STREAM_WRITE:
-            Serial.println("Error: Stream write error");
-            break;
-        case HTTPC_ERROR_READ_TIMEOUT:
-            Serial.println("Error: Read timeout");
+        case HTTP_FETCH_ERROR_INVALID_URL:
+            LOG_WARN("Invalid URL");
             break;
         default:
-            Serial.print("Unknown error: ");
-            Serial.println(httpResponseCode);
+            LOG_WARN("Unknown error: %d", httpResponseCode);
             break;
     }
 }
 
 /**
- * @brief Update the counter if enough time has passed
+ * @brief Update the counter if the next poll is due
  * @return True if counter was updated
  */
 bool updateCounter() {
-    unsigned long currentMillis = millis();
+    uint32_t currentMillis = clockMillis();
     
     // Check if it's time to update the counter
-    if (currentMillis - lastCounterUpdate >= COUNTER_UPDATE_INTERVAL) {
-        // Save the last update time
-        lastCounterUpdate = currentMillis;
-        
+    if (pollScheduler.isDue(currentMillis)) {
         // Store the previous counter value for comparison
         prevCounter = counter;
         
@@ -184,9 +321,9 @@ bool updateCounter() {
         
         // Debug info
         if(updated) {
-            Serial.printf("Counter updated from API to: %lu at time %lu ms\n", counter, currentMillis);
+            LOG_INFO("Counter updated from API to: %lu at time %lu ms", counter, (unsigned long)currentMillis);
         } else {
-            Serial.println("Failed to update counter from API, using previous value");
+            LOG_WARN("Failed to update counter from API, using previous value");
         }
         
         return updated;
@@ -204,6 +341,14 @@ bool updateCounter() {
  * @param color Color to use for drawing
  */
 void drawDigit(char digit, int16_t x, int16_t y, uint8_t textSize, uint16_t color) {
+    // Fast path: blit the pre-rasterized glyph
+    const uint32_t* glyphRows = glyphCache.getDigitRows(digit, textSize);
+    if (glyphRows != nullptr) {
+        blitGlyph(glyphRows, x, y, textSize, color);
+        return;
+    }
+    
+    // Fall back to the GFX font renderer for anything not cached
     matrix->setCursor(x, y);
     matrix->setTextColor(color);
     matrix->setTextSize(textSize);
@@ -239,6 +384,10 @@ void displayCounter() {
         int16_t digitX = startX + i * (digitWidth + digitSpacing);
         drawDigit(counterStr[i], digitX, startY, textSize, COUNTER_COLOR);
     }
+    
+    // Remember the drawn area so the first animation frame clears it
+    DirtyRect counterRect = {startX, startY, (int16_t)totalWidth, (int16_t)(8 * textSize)};
+    dirtyRegion.markDrawn(counterRect);
 }
 
 /**
@@ -257,6 +406,47 @@ bool isLastRequestSuccessful() {
     return lastRequestSuccessful;
 }
 
+/**
+ * @brief Check if the counter was confirmed by the API since boot
+ * @return False while only the stored value from the last run is known
+ */
+bool isCounterFresh() {
+    return counterFresh;
+}
+
+/**
+ * @brief Get the server timestamp of the current counter value
+ * @return last_updated field of the value, empty if not known
+ */
+const char* getCounterLastUpdated() {
+    return counterLastUpdated;
+}
+
+/**
+ * @brief Write the last good value to flash if a coalesced write is due
+ */
+void serviceCounterStore() {
+    counterStore.service(clockMillis());
+}
+
+/**
+ * @brief Get keep-alive statistics of the API connection
+ * @param reuses Number of requests sent over an already open connection
+ * @param reconnects Number of kept-alive connections that had to be reopened
+ */
+void getApiConnectionStats(uint32_t& reuses, uint32_t& reconnects) {
+    reuses = apiFetch.getReuseCount();
+    reconnects = apiFetch.getReconnectCount();
+}
+
+/**
+ * @brief Get outcome and latency statistics of the counter updates
+ * @return Statistics since boot, updated by the network task
+ */
+const FetchStats& getFetchStats() {
+    return fetchStats;
+}
+
 /**
  * @brief Display an SVG icon on the matrix
  * @param iconData Array containing the SVG icon data (24x24 pixels)
@@ -304,59 +494,47 @@ void displayIcon(const uint8_t* iconData, uint16_t primaryColor, uint16_t second
  */
 bool startAsyncCounterFetch() {
     // Only start a new request if we're not already processing one
-    if (apiRequestState != API_IDLE) {
+    if (apiFetch.getState() != API_IDLE) {
         return false;
     }
     
     // Check if WiFi is connected
     if (WiFi.status() == WL_CONNECTED) {
-        Serial.println("Starting async follower count fetch...");
+        LOG_DEBUG("Starting async follower count fetch...");
         
-        // Set HTTP request timeout
-        asyncHttp.setTimeout(45000);
-        
-        // Start HTTP connection
-        asyncHttp.begin(API_ENDPOINT);
-        
-        // Begin the async request (non-blocking)
-        asyncHttp.sendRequest("GET");
+        // Only formats the request, all network work happens in getAPIRequestState()
+        if (!apiFetch.start()) {
+            LOG_WARN("Failed to start async API request");
+            return false;
+        }
+        metricsScanner.reset();
+        parseMicros = 0;
         
-        // Update state and timestamp
-        apiRequestState = API_REQUEST_PENDING;
-        apiRequestStartTime = millis();
-        Serial.println("Async API request started");
+        LOG_DEBUG("Async API request started");
         return true;
     } else {
-        Serial.println("WiFi not connected, can't start async counter fetch");
+        LOG_WARN("WiFi not connected, can't start async counter fetch");
         return false;
     }
 }
 
 /**
- * @brief Check if an async fetch is in progress
+ * @brief Advance an in-progress fetch by one non-blocking step
  * @return Current state of the API request
  */
 APIRequestState getAPIRequestState() {
-    // If we have a pending request, check if it has completed
-    if (apiRequestState == API_REQUEST_PENDING) {
-        // Check if the request has completed
-        // Since HTTPClient doesn't have built-in async completion detection,
-        // we need to poll for readyState or connection availability
-        int connectionState = asyncHttp.connected();
-        if (connectionState == false) {
-            // Connection closed, request is likely complete
-            Serial.println("Async API request completed");
-            apiRequestState = API_REQUEST_COMPLETE;
-        }
-        // Timeout check - abandon request if it takes too long
-        else if (millis() - apiRequestStartTime > 60000) {  // 60 seconds timeout
-            Serial.println("Async API request timed out");
-            asyncHttp.end();
-            apiRequestState = API_IDLE;
+    APIRequestState previousState = apiFetch.getState();
+    APIRequestState state = apiFetch.poll();
+    
+    if (state == API_REQUEST_COMPLETE && previousState != API_REQUEST_COMPLETE) {
+        if (apiFetch.getResponseCode() == HTTP_FETCH_ERROR_READ_TIMEOUT) {
+            LOG_WARN("Async API request timed out");
+        } else {
+            LOG_DEBUG("Async API request completed");
         }
     }
     
-    return apiRequestState;
+    return state;
 }
 
 /**
@@ -365,95 +543,161 @@ APIRequestState getAPIRequestState() {
  */
 bool processAsyncCounterFetch() {
     // Only process if we have a completed request
-    if (apiRequestState != API_REQUEST_COMPLETE) {
+    if (apiFetch.getState() != API_REQUEST_COMPLETE) {
         return false;
     }
     
-    bool success = false;
-    
-    // Get the response code - use a direct method because getResponse doesn't exist
-    int httpResponseCode = asyncHttp.GET(); // This returns the response code for the current connection
-    Serial.print("HTTP Response Code: ");
-    Serial.println(httpResponseCode);
-    
-    // Handle error codes
-    if (httpResponseCode < 0) {
-        logHttpError(httpResponseCode);
-    }
-    
-    if (httpResponseCode == 200) {
-        // Successful response
-        String payload = asyncHttp.getString();
-        Serial.println("API Response: " + payload);
-        
-        // Parse JSON response
-        DynamicJsonDocument doc(1024);
-        DeserializationError error = deserializeJson(doc, payload);
-        
-        if (!error) {
-            // Store the previous counter value
-            prevCounter = counter;
-            
-            // Extract follower count
-            unsigned long followers = doc["followers_count"];
-            counter = followers;
-            
-            String username = doc["username"].as<String>();
-            String lastUpdated = doc["last_updated"].as<String>();
-            
-            Serial.printf("Updated follower count for %s: %lu (Last updated: %s)\n", 
-                username.c_str(), counter, lastUpdated.c_str());
-                
-            success = true;
-            lastRequestSuccessful = true;
-        } else {
-            Serial.print("JSON parsing error: ");
-            Serial.println(error.c_str());
-            lastRequestSuccessful = false;
-        }
-    } else {
-        Serial.print("HTTP Error: ");
-        Serial.println(httpResponseCode);
-        lastRequestSuccessful = false;
-    }
-    
-    // Clean up and update state
-    asyncHttp.end();
-    apiRequestState = API_IDLE;
-    Serial.println("Async HTTP connection closed");
-    
-    // Update the status indicator with WiFi connected and the API request status
-    updateStatusIndicator(true, lastRequestSuccessful);
-    
-    return success;
+    return handleCounterResponse();
 }
 
 /**
- * @brief Check if it's time to update the counter and start async request if needed
+ * @brief Check if the next poll is due and start async request if needed
  * @return True if a new fetch was initiated
  */
 bool checkCounterUpdateTime() {
-    unsigned long currentMillis = millis();
+    uint32_t currentMillis = clockMillis();
+    
+    // Updates arrive over the stream while it is open
+    if (streamLive) {
+        return false;
+    }
     
     // Check if it's time to update the counter and we're not already fetching
-    if ((currentMillis - lastCounterUpdate >= COUNTER_UPDATE_INTERVAL) && 
-        (apiRequestState == API_IDLE)) {
-        
-        // Save the last update time
-        lastCounterUpdate = currentMillis;
-        
-        // Start async fetch
+    if (pollScheduler.isDue(currentMillis) && (apiFetch.getState() == API_IDLE)) {
+        // Start async fetch, the response handler schedules the next one
         bool started = startAsyncCounterFetch();
         
         // Debug info
         if (started) {
-            Serial.println("Started async counter update");
+            LOG_DEBUG("Started async counter update");
         } else {
-            Serial.println("Failed to start async counter update");
+            LOG_WARN("Failed to start async counter update");
+            pollScheduler.onFailure(currentMillis, -1);
         }
         
         return started;
     }
     
     return false;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Keep the push update stream open and apply its events
+ */
+void updateCounterStream() {
+    uint32_t now = clockMillis();
+    
+    if (streamFetch.getState() == API_IDLE) {
+        // Wait before reopening a stream that failed or dropped
+        if (streamWaiting && now - streamClosedAt < streamWaitDelay) {
+            return;
+        }
+        streamWaiting = false;
+        
+        if (streamFetch.start()) {
+            streamParser.reset();
+            streamLastActivity = now;
+            LOG_DEBUG("Opening counter update stream...");
+        }
+        return;
+    }
+    
+    APIRequestState state = streamFetch.poll();
+    
+    if (state == API_READING_BODY && streamFetch.getResponseCode() == 200) {
+        if (!streamLive) {
+            streamLive = true;
+            streamRetryDelay = COUNTER_STREAM_RETRY_MIN;
+            LOG_INFO("Counter update stream open, polling paused");
+        }
+        
+        // The server sends keep-alive comments, silence means a dead connection
+        if (now - streamLastActivity < COUNTER_STREAM_IDLE_TIMEOUT) {
+            return;
+        }
+        LOG_WARN("Counter update stream idle");
+    } else if (state != API_REQUEST_COMPLETE) {
+        // Still connecting or reading an error response
+        if (now - streamLastActivity < COUNTER_STREAM_IDLE_TIMEOUT) {
+            return;
+        }
+        LOG_WARN("Counter update stream timed out");
+    } else {
+        int code = streamFetch.getResponseCode();
+        LOG_WARN("Counter update stream ended: %d", code);
+        if (code < 0) {
+            logHttpError(code);
+        }
+    }
+    
+    closeCounterStream(now);
+}
+
+/**
+ * @brief Check if counter updates currently arrive over the push stream
+ * @return True while the stream is open
+ */
+bool isCounterStreamLive() {
+    return streamLive;
+}
+
+/**
+ * @brief Close the stream, fall back to polling and plan the next attempt
+ * @param now Current time in milliseconds
+ */
+static void closeCounterStream(uint32_t now) {
+    streamFetch.stop();
+    
+    if (streamLive) {
+        // Updates may have been missed, poll right away
+        streamLive = false;
+        pollScheduler.reset(now);
+        streamWaitDelay = COUNTER_STREAM_RETRY_MIN;
+        LOG_INFO("Counter update stream closed, polling resumed");
+    } else {
+        // The bridge may not support streaming at all, back off
+        streamWaitDelay = streamRetryDelay;
+        streamRetryDelay = min<unsigned long>(streamRetryDelay * 2, COUNTER_STREAM_RETRY_MAX);
+    }
+    
+    // Honor the reconnect delay requested by the server
+    streamWaitDelay = max(streamWaitDelay, streamParser.getRetry());
+    streamClosedAt = now;
+    streamWaiting = true;
+}
+
+/**
+ * @brief Feed received stream bytes to the event parser
+ * @param data Received body bytes
+ * @param length Number of bytes
+ * @param context Unused
+ */
+static void feedCounterStream(const char* data, size_t length, void* context) {
+    streamLastActivity = clockMillis();
+    streamParser.feed(data, length);
+}
+
+/**
+ * @brief Apply a metrics event received over the stream
+ * @param event Event type
+ * @param data Event data, the same JSON object the polling endpoint returns
+ * @param context Unused
+ */
+static void handleStreamEvent(const char* event, const char* data, void* context) {
+    if (strcmp(event, "metrics") != 0) {
+        return;
+    }
+    
+    streamScanner.reset();
+    streamScanner.feed(data, strlen(data));
+    if (!streamScanner.isComplete() || !streamScanner.hasFollowersCount()) {
+        LOG_WARN("Ignoring malformed counter stream event");
+        return;
+    }
+    
+    acceptCounterValue(streamScanner.getFollowersCount(), streamScanner.getLastUpdated());
+    recordRequestResult(true);
+    
+    LOG_INFO("Stream update for %s: %lu (Last updated: %s)",
+        streamScanner.getUsername(), counter, streamScanner.getLastUpdated());
+}
@@ -2,21 +2,35 @@
 #define COUNTER_H
 
 #include <Arduino.h>
+#include "http_fetch.h"
+#include "profiler.h"
 
 // Counter configuration
-#define COUNTER_UPDATE_INTERVAL 10000  // 10 seconds in milliseconds
 #define COUNTER_DIGITS 5               // Number of digits to display
+#ifndef COUNTER_API_BASE
+#define COUNTER_API_BASE "http://172.16.10.190:5000" // Metrics bridge, the soak test points it at a local stand-in
+#endif
 
-// API request state enumeration
-enum APIRequestState {
-    API_IDLE,           // No active request
-    API_REQUEST_PENDING, // Request has been initiated
-    API_REQUEST_COMPLETE // Request has been completed
+// Push update stream configuration
+#define COUNTER_STREAM_IDLE_TIMEOUT 45000  // Reopen the stream if nothing arrives for this long
+#define COUNTER_STREAM_RETRY_MIN 5000      // Reopen delay after a working stream dropped
+#define COUNTER_STREAM_RETRY_MAX 300000    // Upper limit of the reopen delay
+
+/**
+ * @brief Outcome and latency statistics of the counter updates since boot
+ */
+struct FetchStats {
+    uint32_t successCount;        // Polls and stream events that delivered a valid counter
+    uint32_t failureCount;        // Polls that failed or returned no valid counter
+    StageHistogram resolve;       // Host name lookup in microseconds
+    StageHistogram connect;       // TCP handshake in microseconds
+    StageHistogram firstByte;     // Request sent until the first response byte in microseconds
+    StageHistogram parse;         // Scanning the response body in microseconds
 };
 
 // Function declarations
 /**
- * @brief Initialize the counter
+ * @brief Initialize the counter with the last stored value, does not block on the network
  */
 void initCounter();
 
@@ -28,7 +42,7 @@ void initCounter();
 bool startAsyncCounterFetch();
 
 /**
- * @brief Check if an async fetch is in progress
+ * @brief Advance an in-progress fetch by one non-blocking step
  * @return Current state of the API request
  */
 APIRequestState getAPIRequestState();
@@ -52,11 +66,26 @@ bool fetchCounterFromAPI();
 void logHttpError(int httpResponseCode);
 
 /**
- * @brief Check if it's time to update the counter and start async request if needed
+ * @brief Check if the next poll is due and start async request if needed
  * @return True if a new fetch was initiated
  */
 bool checkCounterUpdateTime();
 
+/**
+ * @brief Keep the push update stream open and apply its events
+ * 
+ * Never blocks. While the stream works, checkCounterUpdateTime() does
+ * not poll. When it drops, polling resumes right away and the stream is
+ * reopened with an increasing delay.
+ */
+void updateCounterStream();
+
+/**
+ * @brief Check if counter updates currently arrive over the push stream
+ * @return True while the stream is open
+ */
+bool isCounterStreamLive();
+
 /**
  * @brief Draw a single digit with the specified color
  * @param digit The digit character to draw (0-9)
@@ -94,4 +123,34 @@ unsigned long getCounterValue();
  */
 bool isLastRequestSuccessful();
 
+/**
+ * @brief Check if the counter was confirmed by the API since boot
+ * @return False while only the stored value from the last run is known
+ */
+bool isCounterFresh();
+
+/**
+ * @brief Get the server timestamp of the current counter value
+ * @return last_updated field of the value, empty if not known
+ */
+const char* getCounterLastUpdated();
+
+/**
+ * @brief Write the last good value to flash if a coalesced write is due
+ */
+void serviceCounterStore();
+
+/**
+ * @brief Get keep-alive statistics of the API connection
+ * @param reuses Number of requests sent over an already open connection
+ * @param reconnects Number of kept-alive connections that had to be reopened
+ */
+void getApiConnectionStats(uint32_t& reuses, uint32_t& reconnects);
+
+/**
+ * @brief Get outcome and latency statistics of the counter updates
+ * @return Statistics since boot, updated by the network task
+ */
+const FetchStats& getFetchStats();
+
 #endif // COUNTER_H
\ No newline at end of file
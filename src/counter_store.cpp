@@ -0,0 +1,164 @@
+#include "counter_store.h"
+#include <Preferences.h>
+#include <stddef.h>
+#include "fnv1a.h"
+
+#ifdef ARDUINO
+#include <esp_attr.h>
+#else
+#define RTC_NOINIT_ATTR
+#endif
+
+// Marks a record written by this firmware
+static const uint32_t STORED_COUNTER_MAGIC = 0x43544E31; // "CTN1"
+
+// Survives software resets and crashes, but not power loss
+RTC_NOINIT_ATTR static StoredCounter rtcCounter;
+
+/**
+ * @brief Constructor
+ */
+CounterStore::CounterStore() :
+    dirty(false),
+    flashValid(false),
+    flashValue(0),
+    written(false),
+    lastWriteTime(0),
+    writeCount(0) {
+    memset(&pending, 0, sizeof(pending));
+}
+
+/**
+ * @brief Load the most recent stored value
+ * @param value Loaded follower count
+ * @param lastUpdated Buffer for the server timestamp of the value
+ * @param lastUpdatedSize Size of the timestamp buffer
+ * @return True if a stored value was found
+ */
+bool CounterStore::load(unsigned long& value, char* lastUpdated, size_t lastUpdatedSize) {
+    StoredCounter flashCounter;
+    Preferences preferences;
+
+    memset(&flashCounter, 0, sizeof(flashCounter));
+    if (preferences.begin(COUNTER_STORE_NAMESPACE, true)) {
+        if (preferences.getBytes(COUNTER_STORE_KEY, &flashCounter, sizeof(flashCounter)) == sizeof(flashCounter) &&
+            isValid(flashCounter)) {
+            flashValid = true;
+            flashValue = flashCounter.value;
+        }
+        preferences.end();
+    }
+
+    // The RTC copy is never older than the one in flash
+    const StoredCounter* source = nullptr;
+    if (isValid(rtcCounter)) {
+        source = &rtcCounter;
+    } else if (flashValid) {
+        source = &flashCounter;
+        rtcCounter = flashCounter;
+    }
+
+    if (source == nullptr) {
+        return false;
+    }
+
+    pending = *source;
+    dirty = !flashValid || pending.value != flashValue;
+    value = source->value;
+    snprintf(lastUpdated, lastUpdatedSize, "%s", source->lastUpdated);
+    return true;
+}
+
+/**
+ * @brief Remember a new good value, flash is written later by service()
+ * @param value Follower count
+ * @param lastUpdated Server timestamp of the value, may be empty
+ * @param now Current time in milliseconds
+ */
+void CounterStore::update(unsigned long value, const char* lastUpdated, uint32_t now) {
+    pending.value = value;
+    if (lastUpdated != nullptr && lastUpdated[0] != '\0') {
+        snprintf(pending.lastUpdated, sizeof(pending.lastUpdated), "%s", lastUpdated);
+    }
+    seal(pending);
+    rtcCounter = pending;
+
+    // A new timestamp alone is not worth a flash write
+    dirty = !flashValid || pending.value != flashValue;
+    service(now);
+}
+
+/**
+ * @brief Write a pending value to flash once the write interval has passed
+ * @param now Current time in milliseconds
+ */
+void CounterStore::service(uint32_t now) {
+    if (!dirty) {
+        return;
+    }
+    if (written && now - lastWriteTime < COUNTER_STORE_WRITE_INTERVAL) {
+        return;
+    }
+
+    // Retry after a full interval if the write failed
+    lastWriteTime = now;
+    written = true;
+    if (writeFlash()) {
+        dirty = false;
+        flashValid = true;
+        flashValue = pending.value;
+        writeCount++;
+    }
+}
+
+/**
+ * @brief Get the number of flash writes since boot
+ * @return Flash write count
+ */
+uint32_t CounterStore::getWriteCount() const {
+    return writeCount;
+}
+
+/**
+ * @brief Write the pending record to NVS
+ * @return True if the record was written
+ */
+bool CounterStore::writeFlash() {
+    Preferences preferences;
+    if (!preferences.begin(COUNTER_STORE_NAMESPACE, false)) {
+        return false;
+    }
+    bool success = preferences.putBytes(COUNTER_STORE_KEY, &pending, sizeof(pending)) == sizeof(pending);
+    preferences.end();
+    return success;
+}
+
+/**
+ * @brief Fill in magic and checksum of a record
+ * @param record Record to seal
+ */
+void CounterStore::seal(StoredCounter& record) {
+    record.magic = STORED_COUNTER_MAGIC;
+    record.lastUpdated[sizeof(record.lastUpdated) - 1] = '\0';
+    record.checksum = checksumOf(record);
+}
+
+/**
+ * @brief Check magic and checksum of a record
+ * @param record Record to check
+ * @return True if the record is intact
+ */
+bool CounterStore::isValid(const StoredCounter& record) {
+    return record.magic == STORED_COUNTER_MAGIC &&
+           record.lastUpdated[sizeof(record.lastUpdated) - 1] == '\0' &&
+           record.checksum == checksumOf(record);
+}
+
+/**
+ * @brief Compute the checksum of a record
+ * @param record Record to checksum
+ * @return FNV-1a hash of all fields before the checksum
+ */
+uint32_t CounterStore::checksumOf(const StoredCounter& record) {
+    return fnv1a(FNV1A_SEED, &record, offsetof(StoredCounter, checksum));
+}
@@ -0,0 +1,101 @@
+#ifndef COUNTER_STORE_H
+#define COUNTER_STORE_H
+
+#include <Arduino.h>
+#include "metrics_json_scanner.h"
+
+// Persistence configuration
+#define COUNTER_STORE_NAMESPACE "counter"          // NVS namespace
+#define COUNTER_STORE_KEY "last"                   // NVS key of the stored record
+#define COUNTER_STORE_WRITE_INTERVAL 600000        // At most one flash write per 10 minutes
+
+/**
+ * @brief Record of the last good counter value as stored in NVS and RTC memory
+ */
+struct StoredCounter {
+    uint32_t magic;                                // Marks an initialized record
+    uint32_t value;                                // Follower count
+    char lastUpdated[METRICS_TIMESTAMP_MAX];       // Server timestamp of the value
+    uint32_t checksum;                             // Checksum of the fields above
+};
+
+/**
+ * @brief Keeps the last good counter value across resets and power cycles
+ *
+ * Every update goes to RTC memory right away, which survives resets but
+ * not power loss. Flash (NVS) is only written when the value changed and
+ * at most once per COUNTER_STORE_WRITE_INTERVAL to limit wear.
+ */
+class CounterStore {
+public:
+    /**
+     * @brief Constructor
+     */
+    CounterStore();
+
+    /**
+     * @brief Load the most recent stored value
+     * @param value Loaded follower count
+     * @param lastUpdated Buffer for the server timestamp of the value
+     * @param lastUpdatedSize Size of the timestamp buffer
+     * @return True if a stored value was found
+     */
+    bool load(unsigned long& value, char* lastUpdated, size_t lastUpdatedSize);
+
+    /**
+     * @brief Remember a new good value, flash is written later by service()
+     * @param value Follower count
+     * @param lastUpdated Server timestamp of the value, may be empty
+     * @param now Current time in milliseconds
+     */
+    void update(unsigned long value, const char* lastUpdated, uint32_t now);
+
+    /**
+     * @brief Write a pending value to flash once the write interval has passed
+     * @param now Current time in milliseconds
+     */
+    void service(uint32_t now);
+
+    /**
+     * @brief Get the number of flash writes since boot
+     * @return Flash write count
+     */
+    uint32_t getWriteCount() const;
+
+private:
+    StoredCounter pending;          // Latest value, not necessarily in flash yet
+    bool dirty;                     // pending differs from the value in flash
+    bool flashValid;                // flashValue holds the value stored in flash
+    uint32_t flashValue;            // Follower count stored in flash
+    bool written;                   // Flash was written since boot
+    uint32_t lastWriteTime;         // Time of the last flash write
+    uint32_t writeCount;            // Statistics: flash writes since boot
+
+    /**
+     * @brief Write the pending record to NVS
+     * @return True if the record was written
+     */
+    bool writeFlash();
+
+    /**
+     * @brief Fill in magic and checksum of a record
+     * @param record Record to seal
+     */
+    static void seal(StoredCounter& record);
+
+    /**
+     * @brief Check magic and checksum of a record
+     * @param record Record to check
+     * @return True if the record is intact
+     */
+    static bool isValid(const StoredCounter& record);
+
+    /**
+     * @brief Compute the checksum of a record
+     * @param record Record to checksum
+     * @return FNV-1a hash of all fields before the checksum
+     */
+    static uint32_t checksumOf(const StoredCounter& record);
+};
+
+#endif // COUNTER_STORE_H
@@ -0,0 +1,123 @@
+#include "dirty_region.h"
+#include "matrix_config.h"
+#include <Arduino.h>
+
+// Global dirty region tracker instance
+DirtyRegionTracker dirtyRegion;
+
+/**
+ * @brief Constructor, starts with the whole panel marked dirty
+ */
+DirtyRegionTracker::DirtyRegionTracker() :
+    drawnCount(0),
+    fullInvalidate(true),
+    clearedPixels(0) {
+}
+
+/**
+ * @brief Mark the whole panel dirty
+ */
+void DirtyRegionTracker::invalidate() {
+    fullInvalidate = true;
+}
+
+/**
+ * @brief Check if the whole panel has to be repainted
+ * @return True if invalidate() was called since the last clearDrawn()
+ */
+bool DirtyRegionTracker::isInvalidated() const {
+    return fullInvalidate;
+}
+
+/**
+ * @brief Clip a rectangle to the panel bounds
+ * @param rect Rectangle to clip in place
+ * @return True if anything of the rectangle is left on screen
+ */
+bool DirtyRegionTracker::clip(DirtyRect& rect) {
+    int16_t x0 = max<int16_t>(rect.x, 0);
+    int16_t y0 = max<int16_t>(rect.y, 0);
+    int16_t x1 = min<int16_t>(rect.x + rect.w, PANE_WIDTH);
+    int16_t y1 = min<int16_t>(rect.y + rect.h, PANE_HEIGHT);
+
+    if (x1 <= x0 || y1 <= y0) {
+        return false;
+    }
+
+    rect.x = x0;
+    rect.y = y0;
+    rect.w = x1 - x0;
+    rect.h = y1 - y0;
+    return true;
+}
+
+/**
+ * @brief Record a rectangle that was painted in the current frame
+ *
+ * When the list is full the rectangle is merged into the last entry,
+ * which may clear a few extra pixels later but never misses any.
+ *
+ * @param rect Painted area (clipped to the panel)
+ */
+void DirtyRegionTracker::markDrawn(const DirtyRect& rect) {
+    DirtyRect clipped = rect;
+    if (!clip(clipped)) {
+        return;
+    }
+
+    if (drawnCount < DIRTY_REGION_MAX_RECTS) {
+        drawnRects[drawnCount++] = clipped;
+        return;
+    }
+
+    // Out of slots, grow the last rectangle to the bounding box
+    DirtyRect& last = drawnRects[DIRTY_REGION_MAX_RECTS - 1];
+    int16_t x0 = min(last.x, clipped.x);
+    int16_t y0 = min(last.y, clipped.y);
+    int16_t x1 = max<int16_t>(last.x + last.w, clipped.x + clipped.w);
+    int16_t y1 = max<int16_t>(last.y + last.h, clipped.y + clipped.h);
+    last.x = x0;
+    last.y = y0;
+    last.w = x1 - x0;
+    last.h = y1 - y0;
+}
+
+/**
+ * @brief Clear every rectangle painted since the last call and forget them
+ */
+void DirtyRegionTracker::clearDrawn() {
+    if (fullInvalidate) {
+        matrix->clearScreen();
+        clearedPixels += NUM_LEDS;
+        fullInvalidate = false;
+    } else {
+        for (uint8_t i = 0; i < drawnCount; i++) {
+            matrix->fillRect(drawnRects[i].x, drawnRects[i].y, drawnRects[i].w, drawnRects[i].h, 0);
+            clearedPixels += drawnRects[i].w * drawnRects[i].h;
+        }
+    }
+
+    drawnCount = 0;
+}
+
+/**
+ * @brief Clear a single rectangle to black
+ * @param rect Area to clear (clipped to the panel)
+ */
+void DirtyRegionTracker::clearRect(const DirtyRect& rect) {
+    DirtyRect clipped = rect;
+    if (!clip(clipped)) {
+        return;
+    }
+
+    matrix->fillRect(clipped.x, clipped.y, clipped.w, clipped.h, 0);
+    clearedPixels += clipped.w * clipped.h;
+}
+
+/**
+ * @brief Get the number of pixels cleared since startup
+ * @return Cleared pixel count
+ */
+uint32_t DirtyRegionTracker::getClearedPixelCount() const {
+    return clearedPixels;
+}
\ No newline at end of file
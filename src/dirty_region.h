@@ -0,0 +1,85 @@
+#ifndef DIRTY_REGION_H
+#define DIRTY_REGION_H
+
+#include <stdint.h>
+
+// Maximum number of separate rectangles remembered per frame
+#define DIRTY_REGION_MAX_RECTS 8
+
+/**
+ * @brief Axis-aligned screen rectangle in pixels
+ */
+struct DirtyRect {
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+};
+
+/**
+ * @brief Tracks which screen areas hold drawn content
+ *
+ * Instead of clearing the whole panel every frame, animations report the
+ * rectangles they paint. Before the next repaint only those rectangles
+ * are cleared, so static frames cost no pixel writes at all.
+ */
+class DirtyRegionTracker {
+public:
+    /**
+     * @brief Constructor, starts with the whole panel marked dirty
+     */
+    DirtyRegionTracker();
+
+    /**
+     * @brief Mark the whole panel dirty
+     * The next clearDrawn() call clears the full screen.
+     */
+    void invalidate();
+
+    /**
+     * @brief Check if the whole panel has to be repainted
+     * @return True if invalidate() was called since the last clearDrawn()
+     */
+    bool isInvalidated() const;
+
+    /**
+     * @brief Record a rectangle that was painted in the current frame
+     * @param rect Painted area (clipped to the panel)
+     */
+    void markDrawn(const DirtyRect& rect);
+
+    /**
+     * @brief Clear every rectangle painted since the last call and forget them
+     */
+    void clearDrawn();
+
+    /**
+     * @brief Clear a single rectangle to black
+     * @param rect Area to clear (clipped to the panel)
+     */
+    void clearRect(const DirtyRect& rect);
+
+    /**
+     * @brief Get the number of pixels cleared since startup
+     * @return Cleared pixel count
+     */
+    uint32_t getClearedPixelCount() const;
+
+private:
+    DirtyRect drawnRects[DIRTY_REGION_MAX_RECTS];  // Areas holding drawn content
+    uint8_t drawnCount;                            // Number of valid entries in drawnRects
+    bool fullInvalidate;                           // Whole panel needs clearing
+    uint32_t clearedPixels;                        // Statistics: total cleared pixels
+
+    /**
+     * @brief Clip a rectangle to the panel bounds
+     * @param rect Rectangle to clip in place
+     * @return True if anything of the rectangle is left on screen
+     */
+    static bool clip(DirtyRect& rect);
+};
+
+// Global dirty region tracker shared by all animations
+extern DirtyRegionTracker dirtyRegion;
+
+#endif // DIRTY_REGION_H
\ No newline at end of file
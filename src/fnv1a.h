@@ -0,0 +1,32 @@
+#ifndef FNV1A_H
+#define FNV1A_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 32-bit FNV-1a parameters
+#define FNV1A_SEED 2166136261UL         // Hash of no bytes, start every hash with it
+#define FNV1A_PRIME 16777619UL
+
+/**
+ * @brief Continue a FNV-1a hash
+ *
+ * Used for record checksums, NVS keys and frame hashes. Stored checksums
+ * and the golden frames depend on the exact result, so it must not
+ * change.
+ *
+ * @param hash Hash so far, FNV1A_SEED to start
+ * @param data Bytes to add
+ * @param length Number of bytes
+ * @return Hash value
+ */
+inline uint32_t fnv1a(uint32_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
+
+#endif // FNV1A_H
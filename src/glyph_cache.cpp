@@ -0,0 +1,131 @@
+#include "glyph_cache.h"
+#include "matrix_config.h"
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+
+// Global glyph cache instance
+GlyphCache glyphCache;
+
+// Statistics: total pixels written by blitGlyph()
+static uint32_t blittedPixels = 0;
+
+/**
+ * @brief Constructor
+ */
+GlyphCache::GlyphCache() {
+    for (uint8_t i = 0; i < GLYPH_CACHE_MAX_TEXT_SIZE; i++) {
+        rasterized[i] = false;
+    }
+}
+
+/**
+ * @brief Get the packed rows of a digit glyph, rasterizing on first use
+ * @param digit The digit character ('0'-'9')
+ * @param textSize Size of the text
+ * @return GLYPH_BASE_HEIGHT row masks, or nullptr if the glyph is not cacheable
+ */
+const uint32_t* GlyphCache::getDigitRows(char digit, uint8_t textSize) {
+    if (digit < '0' || digit > '9' || textSize == 0 || textSize > GLYPH_CACHE_MAX_TEXT_SIZE) {
+        return nullptr;
+    }
+
+    if (!rasterized[textSize - 1]) {
+        rasterize(textSize);
+    }
+
+    return digitRows[textSize - 1][digit - '0'];
+}
+
+/**
+ * @brief Rasterize all digits for one text size
+ *
+ * The glyphs are rendered once by the GFX font renderer into a 1bpp
+ * canvas, so the cached masks match what matrix->print() would draw.
+ *
+ * @param textSize Size of the text
+ */
+void GlyphCache::rasterize(uint8_t textSize) {
+    GFXcanvas1 canvas(GLYPH_BASE_WIDTH, GLYPH_BASE_HEIGHT);
+
+    for (uint8_t d = 0; d < 10; d++) {
+        canvas.fillScreen(0);
+        canvas.drawChar(0, 0, '0' + d, 1, 1, 1);
+
+        for (uint8_t row = 0; row < GLYPH_BASE_HEIGHT; row++) {
+            uint32_t mask = 0;
+            for (uint8_t col = 0; col < GLYPH_BASE_WIDTH; col++) {
+                if (canvas.getPixel(col, row)) {
+                    // Repeat the font pixel textSize times horizontally
+                    mask |= ((1UL << textSize) - 1) << (col * textSize);
+                }
+            }
+            digitRows[textSize - 1][d][row] = mask;
+        }
+    }
+
+    rasterized[textSize - 1] = true;
+}
+
+/**
+ * @brief Draw a cached glyph, clipped to the panel
+ * @param rows Glyph rows returned by GlyphCache::getDigitRows()
+ * @param x X-position of the glyph
+ * @param y Y-position of the glyph
+ * @param textSize Size the glyph was rasterized for
+ * @param color Color to use for drawing
+ */
+void blitGlyph(const uint32_t* rows, int16_t x, int16_t y, uint8_t textSize, uint16_t color) {
+    const int16_t glyphWidth = GLYPH_BASE_WIDTH * textSize;
+
+    // Reject glyphs entirely off screen
+    if (x >= PANE_WIDTH || x + glyphWidth <= 0 || y >= PANE_HEIGHT || y + GLYPH_BASE_HEIGHT * textSize <= 0) {
+        return;
+    }
+
+    // Horizontal clipping is applied to the row masks
+    int16_t startX = x;
+    uint8_t leftCut = 0;
+    if (x < 0) {
+        leftCut = -x;
+        startX = 0;
+    }
+    int16_t visibleWidth = min<int16_t>(glyphWidth - leftCut, PANE_WIDTH - startX);
+    uint32_t visibleMask = (1UL << visibleWidth) - 1;
+
+    for (uint8_t row = 0; row < GLYPH_BASE_HEIGHT; row++) {
+        uint32_t mask = (rows[row] >> leftCut) & visibleMask;
+        if (mask == 0) {
+            continue;
+        }
+
+        // Vertical clipping of the textSize pixel rows this row covers
+        int16_t top = y + row * textSize;
+        int16_t bottom = top + textSize;
+        if (top < 0) {
+            top = 0;
+        }
+        if (bottom > PANE_HEIGHT) {
+            bottom = PANE_HEIGHT;
+        }
+        if (top >= bottom) {
+            continue;
+        }
+
+        // Write each run of set pixels as one rectangle
+        while (mask != 0) {
+            uint8_t runStart = __builtin_ctz(mask);
+            uint8_t runLength = __builtin_ctz(~(mask >> runStart));
+            matrix->fillRect(startX + runStart, top, runLength, bottom - top, color);
+            blittedPixels += runLength * (bottom - top);
+            mask &= ~(((1UL << runLength) - 1) << runStart);
+        }
+    }
+}
+
+/**
+ * @brief Get the number of pixels drawn by blitGlyph() since startup
+ * @return Drawn pixel count
+ */
+uint32_t getBlittedPixelCount() {
+    return blittedPixels;
+}
@@ -0,0 +1,70 @@
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <stdint.h>
+
+// Glyph geometry of the built-in 5x7 GFX font (one empty row below)
+#define GLYPH_BASE_WIDTH 5
+#define GLYPH_BASE_HEIGHT 8
+
+// Largest text size kept in the cache, bigger sizes fall back to GFX
+#define GLYPH_CACHE_MAX_TEXT_SIZE 4
+
+/**
+ * @brief Cache of pre-rasterized digit glyphs
+ *
+ * Digits '0'-'9' are rasterized once per text size into packed 1bpp rows.
+ * Each row is a bit mask (bit 0 = leftmost pixel) that is already scaled
+ * horizontally; vertically every row stands for textSize pixel rows.
+ */
+class GlyphCache {
+public:
+    /**
+     * @brief Constructor
+     */
+    GlyphCache();
+
+    /**
+     * @brief Get the packed rows of a digit glyph, rasterizing on first use
+     * @param digit The digit character ('0'-'9')
+     * @param textSize Size of the text
+     * @return GLYPH_BASE_HEIGHT row masks, or nullptr if the glyph is not cacheable
+     */
+    const uint32_t* getDigitRows(char digit, uint8_t textSize);
+
+private:
+    uint32_t digitRows[GLYPH_CACHE_MAX_TEXT_SIZE][10][GLYPH_BASE_HEIGHT];  // Packed glyph rows
+    bool rasterized[GLYPH_CACHE_MAX_TEXT_SIZE];                            // Sizes already filled in
+
+    /**
+     * @brief Rasterize all digits for one text size
+     * @param textSize Size of the text
+     */
+    void rasterize(uint8_t textSize);
+};
+
+/**
+ * @brief Draw a cached glyph, clipped to the panel
+ *
+ * Consecutive set pixels of a row are written as one rectangle of
+ * textSize rows, so a digit at size 2 takes a handful of fillRect calls
+ * instead of one call per font pixel.
+ *
+ * @param rows Glyph rows returned by GlyphCache::getDigitRows()
+ * @param x X-position of the glyph
+ * @param y Y-position of the glyph
+ * @param textSize Size the glyph was rasterized for
+ * @param color Color to use for drawing
+ */
+void blitGlyph(const uint32_t* rows, int16_t x, int16_t y, uint8_t textSize, uint16_t color);
+
+/**
+ * @brief Get the number of pixels drawn by blitGlyph() since startup
+ * @return Drawn pixel count
+ */
+uint32_t getBlittedPixelCount();
+
+// Global glyph cache instance
+extern GlyphCache glyphCache;
+
+#endif // GLYPH_CACHE_H
\ No newline at end of file
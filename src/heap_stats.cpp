@@ -0,0 +1,274 @@
+#include "heap_stats.h"
+#include "clock.h"
+
+#ifdef ARDUINO
+#include <esp_heap_caps.h>
+#else
+#include <atomic>
+#include <new>
+#endif
+
+#define LOG_TAG "heap"
+#include "logger.h"
+
+#if HEAP_REPORT_INTERVAL > 0
+// Time of the last heap report
+static uint32_t lastHeapReport = 0;
+#endif
+
+#ifndef ARDUINO
+/**
+ * @brief Header in front of every block of the host heap
+ *
+ * A free block also stores the next free block, so the smallest block
+ * holds a header and a pointer.
+ */
+struct HostBlock {
+    size_t size;                // Block size including the header
+    HostBlock* next;            // Next free block by address, only valid while free
+};
+
+// Allocation granularity, also the header size so payloads stay aligned like malloc()
+static const size_t HOST_ALIGNMENT = 16;
+static const size_t HOST_MIN_BLOCK = 2 * HOST_ALIGNMENT;
+
+// C++ allocations of the host build come from this fixed heap, like on the device
+alignas(HOST_ALIGNMENT) static uint8_t hostArena[HEAP_HOST_SIZE];
+static HostBlock* freeList = nullptr;          // Free blocks in address order
+static bool arenaReady = false;
+static std::atomic_flag arenaLock = ATOMIC_FLAG_INIT;  // Constant initialized, new may run before main()
+
+// Figures of the host heap, guarded by arenaLock
+static uint32_t allocationCount = 0;
+static uint32_t liveBlocks = 0;
+static size_t usedBytes = 0;
+static size_t peakUsedBytes = 0;
+
+/**
+ * @brief Take the host heap lock
+ */
+static void lockArena() {
+    while (arenaLock.test_and_set(std::memory_order_acquire)) {
+    }
+}
+
+/**
+ * @brief Release the host heap lock
+ */
+static void unlockArena() {
+    arenaLock.clear(std::memory_order_release);
+}
+
+/**
+ * @brief Allocate a block of the host heap, first fit
+ * @param size Requested size
+ * @return Block, nullptr if no free block is large enough
+ */
+static void* countedAlloc(size_t size) {
+    if (size > HEAP_HOST_SIZE) {
+        return nullptr;
+    }
+    size_t needed = (size + HOST_ALIGNMENT - 1) / HOST_ALIGNMENT * HOST_ALIGNMENT + HOST_ALIGNMENT;
+    needed = max(needed, HOST_MIN_BLOCK);
+
+    lockArena();
+    if (!arenaReady) {
+        freeList = reinterpret_cast<HostBlock*>(hostArena);
+        freeList->size = sizeof(hostArena);
+        freeList->next = nullptr;
+        arenaReady = true;
+    }
+
+    HostBlock** link = &freeList;
+    while (*link != nullptr && (*link)->size < needed) {
+        link = &(*link)->next;
+    }
+    HostBlock* block = *link;
+    if (block == nullptr) {
+        unlockArena();
+        return nullptr;
+    }
+
+    // Split off the rest unless it could not hold a block of its own
+    if (block->size - needed >= HOST_MIN_BLOCK) {
+        HostBlock* rest = reinterpret_cast<HostBlock*>(reinterpret_cast<uint8_t*>(block) + needed);
+        rest->size = block->size - needed;
+        rest->next = block->next;
+        block->size = needed;
+        *link = rest;
+    } else {
+        *link = block->next;
+    }
+
+    allocationCount++;
+    liveBlocks++;
+    usedBytes += block->size - HOST_ALIGNMENT;
+    peakUsedBytes = max(peakUsedBytes, usedBytes);
+    unlockArena();
+    return reinterpret_cast<uint8_t*>(block) + HOST_ALIGNMENT;
+}
+
+/**
+ * @brief Return a block to the host heap, merging it with free neighbours
+ * @param payload Block returned by countedAlloc(), may be nullptr
+ */
+static void countedFree(void* payload) {
+    if (payload == nullptr) {
+        return;
+    }
+    HostBlock* block = reinterpret_cast<HostBlock*>(static_cast<uint8_t*>(payload) - HOST_ALIGNMENT);
+
+    lockArena();
+    liveBlocks--;
+    usedBytes -= block->size - HOST_ALIGNMENT;
+
+    HostBlock* previous = nullptr;
+    HostBlock* next = freeList;
+    while (next != nullptr && next < block) {
+        previous = next;
+        next = next->next;
+    }
+
+    block->next = next;
+    if (next != nullptr && reinterpret_cast<uint8_t*>(block) + block->size == reinterpret_cast<uint8_t*>(next)) {
+        block->size += next->size;
+        block->next = next->next;
+    }
+    if (previous == nullptr) {
+        freeList = block;
+    } else if (reinterpret_cast<uint8_t*>(previous) + previous->size == reinterpret_cast<uint8_t*>(block)) {
+        previous->size += block->size;
+        previous->next = block->next;
+    } else {
+        previous->next = block;
+    }
+    unlockArena();
+}
+
+// Every C++ allocation of the host build goes through these replacements
+void* operator new(size_t size) {
+    void* block = countedAlloc(size);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* block) noexcept {
+    countedFree(block);
+}
+
+void operator delete[](void* block) noexcept {
+    countedFree(block);
+}
+
+void operator delete(void* block, size_t size) noexcept {
+    countedFree(block);
+}
+
+void operator delete[](void* block, size_t size) noexcept {
+    countedFree(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept {
+    countedFree(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept {
+    countedFree(block);
+}
+#endif
+
+/**
+ * @brief Read the current heap figures
+ * @param stats Filled with the figures
+ */
+void readHeapStats(HeapStats& stats) {
+#ifdef ARDUINO
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+    size_t total = info.total_free_bytes + info.total_allocated_bytes;
+
+    stats.allocationCount = 0;
+    stats.liveBlocks = info.allocated_blocks;
+    stats.usedBytes = info.total_allocated_bytes;
+    stats.peakUsedBytes = total - info.minimum_free_bytes;
+    stats.freeBytes = info.total_free_bytes;
+    stats.largestFreeBlock = info.largest_free_block;
+#else
+    size_t freeBytes = 0;
+    size_t largestFreeBlock = 0;
+
+    lockArena();
+    if (!arenaReady) {
+        freeBytes = largestFreeBlock = sizeof(hostArena) - HOST_ALIGNMENT;
+    }
+    for (HostBlock* block = freeList; block != nullptr; block = block->next) {
+        freeBytes += block->size - HOST_ALIGNMENT;
+        largestFreeBlock = max(largestFreeBlock, block->size - HOST_ALIGNMENT);
+    }
+    stats.allocationCount = allocationCount;
+    stats.liveBlocks = liveBlocks;
+    stats.usedBytes = usedBytes;
+    stats.peakUsedBytes = peakUsedBytes;
+    unlockArena();
+
+    stats.freeBytes = freeBytes;
+    stats.largestFreeBlock = largestFreeBlock;
+#endif
+    stats.fragmentation = stats.freeBytes > 0 ? 100 - (uint64_t)stats.largestFreeBlock * 100 / stats.freeBytes : 0;
+}
+
+#ifndef ARDUINO
+/**
+ * @brief Start a new peak, peakUsedBytes reports the highest usage from now on
+ */
+void resetHeapPeak() {
+    lockArena();
+    peakUsedBytes = usedBytes;
+    unlockArena();
+}
+#endif
+
+/**
+ * @brief Log heap figures
+ * @param stats Figures returned by readHeapStats()
+ */
+void logHeapStats(const HeapStats& stats) {
+    // Two lines, one would not fit into LOG_LINE_MAX
+    LOG_INFO("%lu B used, %lu B peak, %lu blocks, %lu allocations",
+             (unsigned long)stats.usedBytes, (unsigned long)stats.peakUsedBytes,
+             (unsigned long)stats.liveBlocks, (unsigned long)stats.allocationCount);
+    LOG_INFO("%lu B free, largest block %lu B, %u%% fragmented",
+             (unsigned long)stats.freeBytes, (unsigned long)stats.largestFreeBlock,
+             (unsigned)stats.fragmentation);
+}
+
+/**
+ * @brief Log the heap figures if HEAP_REPORT_INTERVAL has passed
+ */
+void serviceHeapReport() {
+#if HEAP_REPORT_INTERVAL > 0
+    uint32_t now = clockMillis();
+    if (now - lastHeapReport < HEAP_REPORT_INTERVAL) {
+        return;
+    }
+    lastHeapReport = now;
+
+    HeapStats stats;
+    readHeapStats(stats);
+    logHeapStats(stats);
+#endif
+}
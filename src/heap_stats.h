@@ -0,0 +1,61 @@
+#ifndef HEAP_STATS_H
+#define HEAP_STATS_H
+
+#include <Arduino.h>
+
+// Heap report configuration
+#ifndef HEAP_REPORT_INTERVAL
+#define HEAP_REPORT_INTERVAL 0          // Milliseconds between two heap reports, 0 disables them, see env:esp32_soak
+#endif
+#ifndef HEAP_HOST_SIZE
+#define HEAP_HOST_SIZE (256 * 1024)     // Heap of host builds, about the free heap of the device after boot
+#endif
+
+/**
+ * @brief Usage and fragmentation of the heap at one point in time
+ *
+ * The device reads the figures from the ESP-IDF heap. Host builds serve
+ * every C++ allocation from a fixed first-fit heap of HEAP_HOST_SIZE
+ * bytes, so a soak run on the host reports the same figures as the
+ * device, including the largest free block.
+ */
+struct HeapStats {
+    uint32_t allocationCount;     // Allocations since start, host builds only
+    uint32_t liveBlocks;          // Blocks currently allocated
+    uint32_t usedBytes;           // Bytes currently allocated
+    uint32_t peakUsedBytes;       // Highest usedBytes since start
+    uint32_t freeBytes;           // Free heap
+    uint32_t largestFreeBlock;    // Largest block that can still be allocated
+    uint8_t fragmentation;        // Percent of the free heap outside the largest block
+};
+
+/**
+ * @brief Read the current heap figures
+ * @param stats Filled with the figures
+ */
+void readHeapStats(HeapStats& stats);
+
+#ifndef ARDUINO
+/**
+ * @brief Start a new peak, peakUsedBytes reports the highest usage from now on
+ *
+ * Host builds only, the device keeps the lowest free heap since boot.
+ */
+void resetHeapPeak();
+#endif
+
+/**
+ * @brief Log heap figures
+ * @param stats Figures returned by readHeapStats()
+ */
+void logHeapStats(const HeapStats& stats);
+
+/**
+ * @brief Log the heap figures if HEAP_REPORT_INTERVAL has passed
+ *
+ * Call regularly from one task, does nothing when HEAP_REPORT_INTERVAL
+ * is 0.
+ */
+void serviceHeapReport();
+
+#endif // HEAP_STATS_H
@@ -0,0 +1,972 @@
+#include "http_fetch.h"
+#include "clock.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#include <lwip/dns.h>
+#include <lwip/tcpip.h>
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#ifdef ARDUINO
+/**
+ * @brief lwIP DNS callback, runs in the TCP/IP task
+ * @param name Host name that was looked up
+ * @param ipAddress Resolved address, nullptr if the lookup failed
+ * @param arg HttpFetch instance that started the lookup
+ */
+static void dnsFoundCallback(const char* name, const ip_addr_t* ipAddress, void* arg) {
+    HttpFetch* fetch = static_cast<HttpFetch*>(arg);
+    if (ipAddress != nullptr && IP_IS_V4(ipAddress)) {
+        fetch->onHostResolved(true, ip4_addr_get_u32(ip_2_ip4(ipAddress)));
+    } else {
+        fetch->onHostResolved(false, 0);
+    }
+}
+
+/**
+ * @brief Arguments and result of a DNS lookup started in the TCP/IP task
+ */
+struct DnsLookupCall {
+    struct tcpip_api_call_data call;   // Must be first, lwIP passes a pointer to it
+    const char* host;                  // Host name to look up
+    HttpFetch* fetch;                  // Receives the result of a lookup that goes to the network
+    ip_addr_t cached;                  // Address if the name was in the DNS cache
+    err_t result;                      // Result of dns_gethostbyname()
+};
+
+/**
+ * @brief Start a DNS lookup, runs in the TCP/IP task
+ * @param call DnsLookupCall
+ * @return ERR_OK
+ */
+static err_t startDnsLookup(struct tcpip_api_call_data* call) {
+    DnsLookupCall* lookup = reinterpret_cast<DnsLookupCall*>(call);
+    lookup->result = dns_gethostbyname(lookup->host, &lookup->cached, dnsFoundCallback, lookup->fetch);
+    return ERR_OK;
+}
+#endif
+
+/**
+ * @brief Check if a socket error only means "try again later"
+ * @return True if the last socket call would have blocked
+ */
+static bool wouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+/**
+ * @brief Read the status code of a response header block
+ * @param headers Header block starting with the status line
+ * @return Status code, 0 if the block is not an HTTP response
+ */
+static int statusOf(const char* headers) {
+    if (strncmp(headers, "HTTP/", 5) != 0) {
+        return 0;
+    }
+    const char* statusStart = strchr(headers, ' ');
+    return statusStart != nullptr ? atoi(statusStart + 1) : 0;
+}
+
+/**
+ * @brief Constructor
+ */
+HttpFetch::HttpFetch() :
+    port(80),
+    acceptType("application/json"),
+    address(0),
+    resolveQueried(false),
+    resolveDone(false),
+    resolveFailed(false),
+    sock(-1),
+    state(API_IDLE),
+    responseCode(0),
+    timeout(HTTP_FETCH_DEFAULT_TIMEOUT),
+    requestStartTime(0),
+    phaseStartTime(0),
+    requestLength(0),
+    requestSent(0),
+    headerLength(0),
+    responseStarted(false),
+    bodyLength(0),
+    contentLength(-1),
+    maxAge(-1),
+    retryAfter(-1),
+    chunked(false),
+    chunkState(CHUNK_SIZE),
+    chunkRemaining(0),
+    trailerLineStarted(false),
+    bodyHandler(nullptr),
+    bodyHandlerContext(nullptr),
+    keepAlive(false),
+    reusedConnection(false),
+    reuseCount(0),
+    reconnectCount(0),
+    connectCount(0) {
+    host[0] = '\0';
+    path[0] = '\0';
+    etag[0] = '\0';
+    lastModified[0] = '\0';
+    responseEtag[0] = '\0';
+    responseLastModified[0] = '\0';
+    headers[0] = '\0';
+    body[0] = '\0';
+    memset(&timing, 0, sizeof(timing));
+}
+
+/**
+ * @brief Destructor, closes any open connection
+ */
+HttpFetch::~HttpFetch() {
+    closeSocket();
+}
+
+/**
+ * @brief Set the URL used by the following requests
+ * @param url URL in the form http://host[:port]/path
+ * @return True if the URL could be parsed
+ */
+bool HttpFetch::begin(const char* url) {
+    const char* scheme = "http://";
+    if (strncmp(url, scheme, strlen(scheme)) != 0) {
+        return false;
+    }
+
+    const char* hostStart = url + strlen(scheme);
+    const char* hostEnd = hostStart;
+    while (*hostEnd != '\0' && *hostEnd != ':' && *hostEnd != '/') {
+        hostEnd++;
+    }
+
+    size_t hostLength = hostEnd - hostStart;
+    if (hostLength == 0 || hostLength >= sizeof(host)) {
+        return false;
+    }
+
+    // Optional port
+    uint16_t parsedPort = 80;
+    const char* pathStart = hostEnd;
+    if (*hostEnd == ':') {
+        char* portEnd;
+        long value = strtol(hostEnd + 1, &portEnd, 10);
+        if (value <= 0 || value > 65535) {
+            return false;
+        }
+        parsedPort = value;
+        pathStart = portEnd;
+    }
+
+    // Path defaults to "/"
+    if (*pathStart == '\0') {
+        pathStart = "/";
+    }
+    if (*pathStart != '/' || strlen(pathStart) >= sizeof(path)) {
+        return false;
+    }
+
+    memcpy(host, hostStart, hostLength);
+    host[hostLength] = '\0';
+    strcpy(path, pathStart);
+    port = parsedPort;
+    address.store(0, std::memory_order_relaxed);
+    resolveDone.store(false, std::memory_order_relaxed);
+    clearValidators();
+
+    return true;
+}
+
+/**
+ * @brief Set the request timeout
+ * @param timeoutMs Timeout for a whole request in milliseconds, 0 for none
+ */
+void HttpFetch::setTimeout(unsigned long timeoutMs) {
+    timeout = timeoutMs;
+}
+
+/**
+ * @brief Set the media type sent in the Accept header
+ * @param mediaType Media type, must stay valid while requests are made
+ */
+void HttpFetch::setAcceptType(const char* mediaType) {
+    acceptType = mediaType;
+}
+
+/**
+ * @brief Stream the response body to a handler instead of buffering it
+ * @param handler Callback for body bytes, nullptr to buffer the body again
+ * @param context Pointer passed to every handler call
+ */
+void HttpFetch::setBodyHandler(HttpBodyHandler handler, void* context) {
+    bodyHandler = handler;
+    bodyHandlerContext = context;
+}
+
+/**
+ * @brief Start a GET request, does not wait for any network activity
+ * @return True if the request was started
+ */
+bool HttpFetch::start() {
+    if (state != API_IDLE || host[0] == '\0') {
+        return false;
+    }
+
+    // The Host header only carries the port if it is not the default
+    char hostHeader[HTTP_FETCH_HOST_MAX + 8];
+    if (port == 80) {
+        snprintf(hostHeader, sizeof(hostHeader), "%s", host);
+    } else {
+        snprintf(hostHeader, sizeof(hostHeader), "%s:%u", host, port);
+    }
+
+    // Ask for the body only if it changed since the accepted response
+    char conditional[HTTP_FETCH_VALIDATOR_MAX + 24];
+    conditional[0] = '\0';
+    if (etag[0] != '\0') {
+        snprintf(conditional, sizeof(conditional), "If-None-Match: %s\r\n", etag);
+    } else if (lastModified[0] != '\0') {
+        snprintf(conditional, sizeof(conditional), "If-Modified-Since: %s\r\n", lastModified);
+    }
+
+    int length = snprintf(request, sizeof(request),
+                          "GET %s HTTP/1.1\r\nHost: %s\r\nAccept: %s\r\n%sConnection: keep-alive\r\n\r\n",
+                          path, hostHeader, acceptType, conditional);
+    if (length < 0 || (size_t)length >= sizeof(request)) {
+        return false;
+    }
+
+    requestLength = length;
+    requestSent = 0;
+    headerLength = 0;
+    headers[0] = '\0';
+    responseStarted = false;
+    bodyLength = 0;
+    body[0] = '\0';
+    contentLength = -1;
+    maxAge = -1;
+    retryAfter = -1;
+    chunked = false;
+    chunkState = CHUNK_SIZE;
+    chunkRemaining = 0;
+    trailerLineStarted = false;
+    responseEtag[0] = '\0';
+    responseLastModified[0] = '\0';
+    responseCode = 0;
+    keepAlive = false;
+    reusedConnection = false;
+    requestStartTime = clockMillis();
+    phaseStartTime = clockMicros();
+    memset(&timing, 0, sizeof(timing));
+
+    // Reuse the connection of the previous request if the server kept it open
+    if (sock >= 0) {
+        if (isConnectionAlive()) {
+            reusedConnection = true;
+            reuseCount++;
+            state = API_SENDING;
+            return true;
+        }
+        closeSocket();
+        reconnectCount++;
+    }
+
+    // The actual work happens in poll()
+    resolveQueried = false;
+    state = API_RESOLVING;
+    return true;
+}
+
+/**
+ * @brief Advance the request by one bounded step
+ * @return State of the request after this step
+ */
+APIRequestState HttpFetch::poll() {
+    switch (state) {
+        case API_RESOLVING:
+            stepResolve();
+            break;
+        case API_CONNECTING:
+            stepConnect();
+            break;
+        case API_SENDING:
+            stepSend();
+            break;
+        case API_READING_HEADERS:
+            stepReadHeaders();
+            break;
+        case API_READING_BODY:
+            stepReadBody();
+            break;
+        default:
+            break;
+    }
+
+    // Give up on requests that take too long in any step
+    if (timeout != 0 && state != API_IDLE && state != API_REQUEST_COMPLETE &&
+        clockMillis() - requestStartTime > timeout) {
+        finish(HTTP_FETCH_ERROR_READ_TIMEOUT);
+    }
+
+    return state;
+}
+
+/**
+ * @brief Get the current state without advancing the request
+ * @return Current request state
+ */
+APIRequestState HttpFetch::getState() const {
+    return state;
+}
+
+/**
+ * @brief Get the result of a completed request
+ * @return HTTP status code, or a negative HTTP_FETCH_ERROR_* code
+ */
+int HttpFetch::getResponseCode() const {
+    return responseCode;
+}
+
+/**
+ * @brief Get the max-age directive of the Cache-Control response header
+ * @return Freshness lifetime in seconds, -1 if not sent
+ */
+long HttpFetch::getMaxAge() const {
+    return maxAge;
+}
+
+/**
+ * @brief Get the Retry-After response header
+ * @return Delay in seconds, -1 if not sent or not in delay-seconds form
+ */
+long HttpFetch::getRetryAfter() const {
+    return retryAfter;
+}
+
+/**
+ * @brief Get the received response body (null terminated)
+ * @return Pointer to the body buffer
+ */
+const char* HttpFetch::getBody() const {
+    return body;
+}
+
+/**
+ * @brief Get the length of the received response body
+ * @return Body length in bytes, including streamed bytes
+ */
+size_t HttpFetch::getBodyLength() const {
+    return bodyLength;
+}
+
+/**
+ * @brief Get the phase durations of the last request
+ * @return Durations so far, complete once the request is complete
+ */
+const HttpFetchTiming& HttpFetch::getTiming() const {
+    return timing;
+}
+
+/**
+ * @brief Return to API_IDLE, keeping a reusable connection open
+ */
+void HttpFetch::end() {
+    // A request aborted midway leaves the connection in an unknown state
+    if (state != API_REQUEST_COMPLETE) {
+        closeSocket();
+    }
+    state = API_IDLE;
+}
+
+/**
+ * @brief Close the connection and return to API_IDLE
+ */
+void HttpFetch::stop() {
+    closeSocket();
+    state = API_IDLE;
+}
+
+/**
+ * @brief Make the following requests conditional on the last response
+ */
+void HttpFetch::useResponseValidators() {
+    strcpy(etag, responseEtag);
+    strcpy(lastModified, responseLastModified);
+}
+
+/**
+ * @brief Make the following requests unconditional again
+ */
+void HttpFetch::clearValidators() {
+    etag[0] = '\0';
+    lastModified[0] = '\0';
+}
+
+/**
+ * @brief Get the number of requests sent over an already open connection
+ * @return Connection reuse count
+ */
+uint32_t HttpFetch::getReuseCount() const {
+    return reuseCount;
+}
+
+/**
+ * @brief Get the number of kept-alive connections that had to be reopened
+ * @return Reconnect count
+ */
+uint32_t HttpFetch::getReconnectCount() const {
+    return reconnectCount;
+}
+
+/**
+ * @brief Get the number of TCP connections opened
+ * @return Connection count
+ */
+uint32_t HttpFetch::getConnectCount() const {
+    return connectCount;
+}
+
+/**
+ * @brief Store the result of an asynchronous DNS lookup
+ * @param found True if the host name was resolved
+ * @param resolvedAddress IPv4 address in network order
+ */
+void HttpFetch::onHostResolved(bool found, uint32_t resolvedAddress) {
+    if (found) {
+        address.store(resolvedAddress, std::memory_order_relaxed);
+        resolveDone.store(true, std::memory_order_release);
+    } else {
+        resolveFailed.store(true, std::memory_order_release);
+    }
+}
+
+/**
+ * @brief Resolve the host name, waiting for the DNS callback
+ */
+void HttpFetch::stepResolve() {
+    if (resolveQueried) {
+        if (resolveFailed.load(std::memory_order_acquire)) {
+            finish(HTTP_FETCH_ERROR_RESOLVE_FAILED);
+        } else if (resolveDone.load(std::memory_order_acquire)) {
+            openConnection();
+        }
+        return;
+    }
+    resolveQueried = true;
+    resolveDone.store(false, std::memory_order_relaxed);
+    resolveFailed.store(false, std::memory_order_relaxed);
+
+    // IP literals need no lookup
+    struct in_addr literal;
+    if (inet_pton(AF_INET, host, &literal) == 1) {
+        address.store(literal.s_addr, std::memory_order_relaxed);
+        openConnection();
+        return;
+    }
+
+#ifdef ARDUINO
+    // The DNS client belongs to the TCP/IP task, with or without core locking
+    DnsLookupCall lookup = {};
+    lookup.host = host;
+    lookup.fetch = this;
+    if (tcpip_api_call(startDnsLookup, &lookup.call) != ERR_OK) {
+        finish(HTTP_FETCH_ERROR_RESOLVE_FAILED);
+    } else if (lookup.result == ERR_OK) {
+        address.store(ip4_addr_get_u32(ip_2_ip4(&lookup.cached)), std::memory_order_relaxed);
+        openConnection();
+    } else if (lookup.result != ERR_INPROGRESS) {
+        finish(HTTP_FETCH_ERROR_RESOLVE_FAILED);
+    }
+    // Otherwise dnsFoundCallback() reports the result later
+#else
+    // Host builds resolve synchronously
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host, nullptr, &hints, &result) != 0 || result == nullptr) {
+        finish(HTTP_FETCH_ERROR_RESOLVE_FAILED);
+        return;
+    }
+    address.store(((struct sockaddr_in*)result->ai_addr)->sin_addr.s_addr, std::memory_order_relaxed);
+    freeaddrinfo(result);
+    openConnection();
+#endif
+}
+
+/**
+ * @brief Open a non-blocking socket and start connecting
+ */
+void HttpFetch::openConnection() {
+    endPhase(timing.resolve);
+
+    sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) {
+        finish(HTTP_FETCH_ERROR_NOT_CONNECTED);
+        return;
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+    connectCount++;
+
+    struct sockaddr_in serverAddress;
+    memset(&serverAddress, 0, sizeof(serverAddress));
+    serverAddress.sin_family = AF_INET;
+    serverAddress.sin_port = htons(port);
+    serverAddress.sin_addr.s_addr = address.load(std::memory_order_relaxed);
+
+    int result = connect(sock, (struct sockaddr*)&serverAddress, sizeof(serverAddress));
+    if (result == 0) {
+        endPhase(timing.connect);
+        state = API_SENDING;
+    } else if (errno == EINPROGRESS) {
+        state = API_CONNECTING;
+    } else {
+        finish(HTTP_FETCH_ERROR_CONNECTION_REFUSED);
+    }
+}
+
+/**
+ * @brief Check whether the non-blocking connect has finished
+ */
+void HttpFetch::stepConnect() {
+    fd_set writeSet;
+    FD_ZERO(&writeSet);
+    FD_SET(sock, &writeSet);
+    struct timeval noWait = {0, 0};
+
+    int ready = select(sock + 1, nullptr, &writeSet, nullptr, &noWait);
+    if (ready == 0) {
+        return;  // Still connecting
+    }
+    if (ready < 0) {
+        finish(HTTP_FETCH_ERROR_NOT_CONNECTED);
+        return;
+    }
+
+    int socketError = 0;
+    socklen_t errorLength = sizeof(socketError);
+    getsockopt(sock, SOL_SOCKET, SO_ERROR, &socketError, &errorLength);
+    if (socketError != 0) {
+        finish(HTTP_FETCH_ERROR_CONNECTION_REFUSED);
+        return;
+    }
+
+    endPhase(timing.connect);
+    state = API_SENDING;
+}
+
+/**
+ * @brief Send the next part of the request
+ */
+void HttpFetch::stepSend() {
+    size_t chunk = min<size_t>(requestLength - requestSent, HTTP_FETCH_IO_CHUNK);
+    ssize_t sent = send(sock, request + requestSent, chunk, MSG_NOSIGNAL);
+    if (sent < 0) {
+        if (!wouldBlock() && !retryOnNewConnection()) {
+            finish(HTTP_FETCH_ERROR_SEND_FAILED);
+        }
+        return;
+    }
+
+    requestSent += sent;
+    if (requestSent == requestLength) {
+        state = API_READING_HEADERS;
+    }
+}
+
+/**
+ * @brief Receive the next part of the response headers
+ */
+void HttpFetch::stepReadHeaders() {
+    size_t space = HTTP_FETCH_HEADER_MAX - headerLength;
+    if (space == 0) {
+        finish(HTTP_FETCH_ERROR_TOO_LARGE);
+        return;
+    }
+
+    ssize_t received = recv(sock, headers + headerLength, min<size_t>(space, HTTP_FETCH_IO_CHUNK), 0);
+    if (received < 0) {
+        if (!wouldBlock() && !retryOnNewConnection()) {
+            finish(HTTP_FETCH_ERROR_CONNECTION_LOST);
+        }
+        return;
+    }
+    if (received == 0) {
+        // Server closed the connection before the headers were complete,
+        // for a reused connection this is a normal idle close
+        if (!retryOnNewConnection()) {
+            finish(HTTP_FETCH_ERROR_CONNECTION_LOST);
+        }
+        return;
+    }
+
+    if (!responseStarted) {
+        endPhase(timing.firstByte);
+        responseStarted = true;
+    }
+    headerLength += received;
+    headers[headerLength] = '\0';
+
+    // Interim responses such as 103 Early Hints precede the final one on the
+    // same connection, drop them and keep reading
+    char* headerEnd = strstr(headers, "\r\n\r\n");
+    while (headerEnd != nullptr) {
+        int status = statusOf(headers);
+        if (status < 100 || status > 199) {
+            break;
+        }
+        size_t interimLength = headerEnd - headers + 4;
+        headerLength -= interimLength;
+        memmove(headers, headers + interimLength, headerLength + 1);
+        headerEnd = strstr(headers, "\r\n\r\n");
+    }
+    if (headerEnd == nullptr) {
+        return;  // Need more data
+    }
+
+    // Whatever follows the empty line already belongs to the body
+    size_t blockLength = headerEnd - headers + 4;
+    size_t extra = headerLength - blockLength;
+    headerEnd[2] = '\0';
+
+    if (!parseHeaders()) {
+        return;
+    }
+    if (!chunked && contentLength >= 0 && (long)extra > contentLength) {
+        finish(HTTP_FETCH_ERROR_TOO_LARGE);
+        return;
+    }
+    headerLength = blockLength;
+
+    state = API_READING_BODY;
+    if (contentLength == 0) {
+        finish(responseCode);
+    } else if (extra > 0) {
+        consumeBody(headers + blockLength, extra);
+    }
+}
+
+/**
+ * @brief Parse the complete response header block
+ * @return True if the headers describe a response we can read
+ */
+bool HttpFetch::parseHeaders() {
+    // Status line, e.g. "HTTP/1.1 200 OK", interim 1xx responses were skipped
+    int status = statusOf(headers);
+    if (status < 200 || status > 599) {
+        finish(HTTP_FETCH_ERROR_NO_HTTP_SERVER);
+        return false;
+    }
+    responseCode = status;
+
+    // HTTP/1.1 connections are persistent by default, HTTP/1.0 ones are not
+    keepAlive = strncmp(headers, "HTTP/1.1", 8) == 0;
+
+    // Responses without a body
+    if (status == 204 || status == 304) {
+        contentLength = 0;
+    }
+
+    // Header lines, each terminated by CRLF
+    char* line = strstr(headers, "\r\n");
+    while (line != nullptr && line[2] != '\0') {
+        line += 2;
+        char* lineEnd = strstr(line, "\r\n");
+        if (lineEnd != nullptr) {
+            *lineEnd = '\0';
+        }
+
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            if (contentLength != 0) {
+                contentLength = atol(line + 15);
+            }
+        } else if (strncasecmp(line, "Connection:", 11) == 0) {
+            if (strcasestr(line + 11, "close") != nullptr) {
+                keepAlive = false;
+            } else if (strcasestr(line + 11, "keep-alive") != nullptr) {
+                keepAlive = true;
+            }
+        } else if (strncasecmp(line, "Cache-Control:", 14) == 0) {
+            const char* directive = strcasestr(line + 14, "max-age=");
+            if (directive != nullptr && isdigit((unsigned char)directive[8])) {
+                maxAge = atol(directive + 8);
+            }
+        } else if (strncasecmp(line, "Retry-After:", 12) == 0) {
+            // The HTTP date form is ignored, it needs a synchronized clock
+            const char* value = line + 12;
+            while (*value == ' ' || *value == '\t') {
+                value++;
+            }
+            if (isdigit((unsigned char)*value)) {
+                retryAfter = atol(value);
+            }
+        } else if (strncasecmp(line, "ETag:", 5) == 0) {
+            copyHeaderValue(responseEtag, line + 5);
+        } else if (strncasecmp(line, "Last-Modified:", 14) == 0) {
+            copyHeaderValue(responseLastModified, line + 14);
+        } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0) {
+            if (contentLength != 0 && strcasestr(line + 18, "chunked") != nullptr) {
+                chunked = true;
+            }
+        }
+
+        if (lineEnd == nullptr) {
+            break;
+        }
+        *lineEnd = '\r';
+        line = lineEnd;
+    }
+
+    // Chunked encoding takes precedence over Content-Length
+    if (chunked) {
+        contentLength = -1;
+    }
+
+    // Only a buffered body is limited in size
+    if (bodyHandler == nullptr && contentLength > HTTP_FETCH_BODY_MAX) {
+        finish(HTTP_FETCH_ERROR_TOO_LARGE);
+        return false;
+    }
+
+    // A body delimited by closing the connection cannot share it
+    if (contentLength < 0 && !chunked) {
+        keepAlive = false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Receive the next part of the response body
+ */
+void HttpFetch::stepReadBody() {
+    size_t wanted = HTTP_FETCH_IO_CHUNK;
+    if (!chunked && contentLength >= 0) {
+        wanted = min<size_t>(contentLength - bodyLength, wanted);
+    }
+
+    ssize_t received = recv(sock, receiveBuffer, wanted, 0);
+    if (received < 0) {
+        if (!wouldBlock()) {
+            finish(HTTP_FETCH_ERROR_CONNECTION_LOST);
+        }
+        return;
+    }
+    if (received == 0) {
+        // Without Content-Length the body ends when the server closes
+        finish(contentLength < 0 && !chunked ? responseCode : HTTP_FETCH_ERROR_CONNECTION_LOST);
+        return;
+    }
+
+    consumeBody(receiveBuffer, received);
+}
+
+/**
+ * @brief Process received body bytes, removing the chunked framing
+ * @param data Bytes as received from the socket
+ * @param length Number of bytes
+ */
+void HttpFetch::consumeBody(const char* data, size_t length) {
+    if (!chunked) {
+        deliverBody(data, length);
+        if (state == API_READING_BODY && contentLength >= 0 && bodyLength == (size_t)contentLength) {
+            finish(responseCode);
+        }
+        return;
+    }
+
+    while (length > 0 && state == API_READING_BODY) {
+        if (chunkState == CHUNK_DATA) {
+            // Pass on as much of the chunk payload as we have
+            size_t payload = min<size_t>(length, chunkRemaining);
+            deliverBody(data, payload);
+            data += payload;
+            length -= payload;
+            chunkRemaining -= payload;
+            if (chunkRemaining == 0) {
+                chunkState = CHUNK_DATA_END;
+            }
+            continue;
+        }
+
+        char c = *data++;
+        length--;
+
+        switch (chunkState) {
+            case CHUNK_SIZE:
+                if (isxdigit((unsigned char)c)) {
+                    if (chunkRemaining > 0x0FFFFFFF) {
+                        finish(HTTP_FETCH_ERROR_ENCODING);
+                        return;
+                    }
+                    chunkRemaining = chunkRemaining * 16 + (isdigit((unsigned char)c) ? c - '0' : (tolower(c) - 'a' + 10));
+                } else if (c == ';') {
+                    chunkState = CHUNK_EXTENSION;
+                } else if (c == '\n') {
+                    chunkState = chunkRemaining > 0 ? CHUNK_DATA : CHUNK_TRAILER;
+                } else if (c != '\r' && c != ' ' && c != '\t') {
+                    finish(HTTP_FETCH_ERROR_ENCODING);
+                    return;
+                }
+                break;
+
+            case CHUNK_EXTENSION:
+                // Chunk extensions are ignored
+                if (c == '\n') {
+                    chunkState = chunkRemaining > 0 ? CHUNK_DATA : CHUNK_TRAILER;
+                }
+                break;
+
+            case CHUNK_DATA_END:
+                if (c == '\n') {
+                    chunkState = CHUNK_SIZE;
+                } else if (c != '\r') {
+                    finish(HTTP_FETCH_ERROR_ENCODING);
+                    return;
+                }
+                break;
+
+            case CHUNK_TRAILER:
+                // Trailer fields are ignored, an empty line ends the body
+                if (c == '\n') {
+                    if (!trailerLineStarted) {
+                        finish(responseCode);
+                        return;
+                    }
+                    trailerLineStarted = false;
+                } else if (c != '\r') {
+                    trailerLineStarted = true;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Pass decoded body bytes to the handler or the body buffer
+ * @param data Body bytes
+ * @param length Number of bytes
+ */
+void HttpFetch::deliverBody(const char* data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+
+    if (bodyHandler != nullptr) {
+        bodyLength += length;
+        bodyHandler(data, length, bodyHandlerContext);
+        return;
+    }
+
+    if (bodyLength + length > HTTP_FETCH_BODY_MAX) {
+        finish(HTTP_FETCH_ERROR_TOO_LARGE);
+        return;
+    }
+    memcpy(body + bodyLength, data, length);
+    bodyLength += length;
+    body[bodyLength] = '\0';
+}
+
+/**
+ * @brief Check if an idle kept-alive connection is still usable
+ * @return True if the server has not closed the connection
+ */
+bool HttpFetch::isConnectionAlive() {
+    char probe;
+    ssize_t received = recv(sock, &probe, 1, MSG_PEEK);
+
+    // Nothing to read is the only healthy state for an idle connection,
+    // EOF means the server closed it and stray data means it is out of sync
+    return received < 0 && wouldBlock();
+}
+
+/**
+ * @brief Resend the request on a new connection if a reused one failed
+ * @return True if the request was restarted
+ */
+bool HttpFetch::retryOnNewConnection() {
+    // Only a reused connection that failed before any response is retried
+    if (!reusedConnection || responseStarted) {
+        return false;
+    }
+
+    closeSocket();
+    reconnectCount++;
+    reusedConnection = false;
+    requestSent = 0;
+    resolveQueried = false;
+    state = API_RESOLVING;
+    return true;
+}
+
+/**
+ * @brief Copy a header value, skipping leading whitespace
+ * @param target Buffer to copy into
+ * @param value Header value after the colon
+ */
+void HttpFetch::copyHeaderValue(char (&target)[HTTP_FETCH_VALIDATOR_MAX], const char* value) {
+    while (*value == ' ' || *value == '\t') {
+        value++;
+    }
+
+    // A truncated validator would never match, so drop it instead
+    size_t length = strlen(value);
+    if (length >= HTTP_FETCH_VALIDATOR_MAX) {
+        target[0] = '\0';
+        return;
+    }
+    memcpy(target, value, length + 1);
+}
+
+/**
+ * @brief Finish the request, closing the socket unless it can be reused
+ * @param code Status code or error to report
+ */
+void HttpFetch::finish(int code) {
+    if (state == API_READING_BODY) {
+        endPhase(timing.body);
+    }
+    if (code < 0 || !keepAlive) {
+        closeSocket();
+    }
+    responseCode = code;
+    state = API_REQUEST_COMPLETE;
+}
+
+/**
+ * @brief Add the time since the last phase change to a phase
+ *
+ * A request retried on a new connection adds to the phases it repeats.
+ *
+ * @param duration Phase duration to add to
+ */
+void HttpFetch::endPhase(uint32_t& duration) {
+    uint64_t now = clockMicros();
+    duration += now - phaseStartTime;
+    phaseStartTime = now;
+}
+
+/**
+ * @brief Close the socket if open
+ */
+void HttpFetch::closeSocket() {
+    if (sock >= 0) {
+        close(sock);
+        sock = -1;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,369 @@
+#ifndef HTTP_FETCH_H
+#define HTTP_FETCH_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Buffer and timing limits
+#define HTTP_FETCH_HOST_MAX 64          // Maximum host name length
+#define HTTP_FETCH_PATH_MAX 128         // Maximum request path length
+#define HTTP_FETCH_REQUEST_MAX 384      // Maximum size of the request headers
+#define HTTP_FETCH_HEADER_MAX 768       // Maximum size of the response headers
+#define HTTP_FETCH_BODY_MAX 1024        // Maximum size of the response body
+#define HTTP_FETCH_VALIDATOR_MAX 64     // Maximum ETag / Last-Modified length
+#define HTTP_FETCH_IO_CHUNK 256         // Maximum bytes sent or received per poll() call
+#define HTTP_FETCH_DEFAULT_TIMEOUT 60000 // Request timeout in milliseconds
+
+// Error codes reported by getResponseCode() (HTTP status codes are positive)
+#define HTTP_FETCH_ERROR_CONNECTION_REFUSED  -1
+#define HTTP_FETCH_ERROR_SEND_FAILED         -2
+#define HTTP_FETCH_ERROR_NOT_CONNECTED       -4
+#define HTTP_FETCH_ERROR_CONNECTION_LOST     -5
+#define HTTP_FETCH_ERROR_NO_HTTP_SERVER      -7
+#define HTTP_FETCH_ERROR_TOO_LARGE           -8
+#define HTTP_FETCH_ERROR_ENCODING            -9
+#define HTTP_FETCH_ERROR_READ_TIMEOUT        -11
+#define HTTP_FETCH_ERROR_RESOLVE_FAILED      -12
+#define HTTP_FETCH_ERROR_INVALID_URL         -13
+
+// API request state enumeration
+enum APIRequestState {
+    API_IDLE,               // No active request
+    API_RESOLVING,          // Resolving the host name
+    API_CONNECTING,         // TCP connection is being established
+    API_SENDING,            // Request headers are being sent
+    API_READING_HEADERS,    // Waiting for and reading the response headers
+    API_READING_BODY,       // Reading the response body
+    API_REQUEST_COMPLETE    // Request has been completed (successfully or not)
+};
+
+/**
+ * @brief Time spent in each phase of the last request in microseconds
+ */
+struct HttpFetchTiming {
+    uint32_t resolve;       // Host name lookup, 0 on a reused connection
+    uint32_t connect;       // TCP handshake, 0 on a reused connection
+    uint32_t firstByte;     // Sending the request until the first response byte
+    uint32_t body;          // First response byte until the response was complete
+};
+
+/**
+ * @brief Callback receiving the response body as it arrives
+ * @param data Received body bytes (not null terminated)
+ * @param length Number of bytes
+ * @param context Pointer passed to setBodyHandler()
+ */
+typedef void (*HttpBodyHandler)(const char* data, size_t length, void* context);
+
+/**
+ * @brief Non-blocking HTTP/1.1 GET client
+ *
+ * The request is driven by calling poll() repeatedly. Each call does at
+ * most one non-blocking socket operation on HTTP_FETCH_IO_CHUNK bytes, so
+ * it returns within microseconds no matter how slow the server is. All
+ * buffers are fixed size, no heap is used per request. Bodies may be
+ * delimited by Content-Length, chunked encoding or closing the connection.
+ *
+ * Connections are kept alive between requests when the server allows it.
+ * If the server has closed an idle connection, the request is sent again
+ * on a fresh connection without reporting an error.
+ *
+ * Requests are made conditional once the caller has accepted a response
+ * with useResponseValidators(), so unchanged data costs a 304 without body.
+ */
+class HttpFetch {
+public:
+    /**
+     * @brief Constructor
+     */
+    HttpFetch();
+
+    /**
+     * @brief Destructor, closes any open connection
+     */
+    ~HttpFetch();
+
+    /**
+     * @brief Set the URL used by the following requests
+     * @param url URL in the form http://host[:port]/path
+     * @return True if the URL could be parsed
+     */
+    bool begin(const char* url);
+
+    /**
+     * @brief Set the request timeout
+     * @param timeoutMs Timeout for a whole request in milliseconds, 0 for none
+     */
+    void setTimeout(unsigned long timeoutMs);
+
+    /**
+     * @brief Set the media type sent in the Accept header
+     * @param mediaType Media type, must stay valid while requests are made
+     */
+    void setAcceptType(const char* mediaType);
+
+    /**
+     * @brief Stream the response body to a handler instead of buffering it
+     *
+     * With a handler set the body is not limited by HTTP_FETCH_BODY_MAX,
+     * getBody() stays empty and getBodyLength() counts the streamed bytes.
+     *
+     * @param handler Callback for body bytes, nullptr to buffer the body again
+     * @param context Pointer passed to every handler call
+     */
+    void setBodyHandler(HttpBodyHandler handler, void* context);
+
+    /**
+     * @brief Start a GET request, does not wait for any network activity
+     * @return True if the request was started
+     */
+    bool start();
+
+    /**
+     * @brief Advance the request by one bounded step
+     * @return State of the request after this step
+     */
+    APIRequestState poll();
+
+    /**
+     * @brief Get the current state without advancing the request
+     * @return Current request state
+     */
+    APIRequestState getState() const;
+
+    /**
+     * @brief Get the result of a completed request
+     * @return HTTP status code, or a negative HTTP_FETCH_ERROR_* code
+     */
+    int getResponseCode() const;
+
+    /**
+     * @brief Get the max-age directive of the Cache-Control response header
+     * @return Freshness lifetime in seconds, -1 if not sent
+     */
+    long getMaxAge() const;
+
+    /**
+     * @brief Get the Retry-After response header
+     * @return Delay in seconds, -1 if not sent or not in delay-seconds form
+     */
+    long getRetryAfter() const;
+
+    /**
+     * @brief Get the received response body (null terminated)
+     * @return Pointer to the body buffer
+     */
+    const char* getBody() const;
+
+    /**
+     * @brief Get the length of the received response body
+     * @return Body length in bytes, including streamed bytes
+     */
+    size_t getBodyLength() const;
+
+    /**
+     * @brief Get the phase durations of the last request
+     * @return Durations so far, complete once the request is complete
+     */
+    const HttpFetchTiming& getTiming() const;
+
+    /**
+     * @brief Return to API_IDLE, keeping a reusable connection open
+     */
+    void end();
+
+    /**
+     * @brief Close the connection and return to API_IDLE
+     */
+    void stop();
+
+    /**
+     * @brief Make the following requests conditional on the last response
+     *
+     * The ETag (sent as If-None-Match) or else the Last-Modified date (sent
+     * as If-Modified-Since) of the completed response is remembered. Only
+     * call this after the response body was processed successfully.
+     */
+    void useResponseValidators();
+
+    /**
+     * @brief Make the following requests unconditional again
+     */
+    void clearValidators();
+
+    /**
+     * @brief Get the number of requests sent over an already open connection
+     * @return Connection reuse count
+     */
+    uint32_t getReuseCount() const;
+
+    /**
+     * @brief Get the number of kept-alive connections that had to be reopened
+     * @return Reconnect count
+     */
+    uint32_t getReconnectCount() const;
+
+    /**
+     * @brief Get the number of TCP connections opened
+     * @return Connection count
+     */
+    uint32_t getConnectCount() const;
+
+    /**
+     * @brief Store the result of an asynchronous DNS lookup
+     *
+     * Called from the TCP/IP task, the result is published to the task
+     * calling poll() with release/acquire ordering.
+     *
+     * @param found True if the host name was resolved
+     * @param resolvedAddress IPv4 address in network order
+     */
+    void onHostResolved(bool found, uint32_t resolvedAddress);
+
+private:
+    // Position inside a chunked body
+    enum ChunkState {
+        CHUNK_SIZE,         // Reading the hexadecimal chunk size
+        CHUNK_EXTENSION,    // Skipping chunk extensions up to the line end
+        CHUNK_DATA,         // Reading the chunk payload
+        CHUNK_DATA_END,     // Expecting the CRLF after the payload
+        CHUNK_TRAILER       // Skipping trailer fields up to the empty line
+    };
+
+    char host[HTTP_FETCH_HOST_MAX];         // Host name or IP address
+    char path[HTTP_FETCH_PATH_MAX];         // Request path
+    uint16_t port;                          // Server port
+    const char* acceptType;                 // Media type sent in the Accept header
+    std::atomic<uint32_t> address;          // Resolved IPv4 address (network order), set by the DNS callback
+    bool resolveQueried;                    // DNS lookup has been started
+    std::atomic<bool> resolveDone;          // Set by the DNS callback after address
+    std::atomic<bool> resolveFailed;        // Set by the DNS callback
+
+    int sock;                               // Socket descriptor, -1 if closed
+    APIRequestState state;                  // Current request state
+    int responseCode;                       // Status code or error
+    unsigned long timeout;                  // Request timeout in milliseconds
+    uint32_t requestStartTime;              // Start of the current request
+    uint64_t phaseStartTime;                // Start of the current phase in microseconds
+    HttpFetchTiming timing;                 // Phase durations of the current request
+
+    char request[HTTP_FETCH_REQUEST_MAX];   // Formatted request headers
+    size_t requestLength;                   // Length of the request
+    size_t requestSent;                     // Bytes of the request already sent
+
+    char etag[HTTP_FETCH_VALIDATOR_MAX];            // ETag sent as If-None-Match
+    char lastModified[HTTP_FETCH_VALIDATOR_MAX];    // Date sent as If-Modified-Since
+    char responseEtag[HTTP_FETCH_VALIDATOR_MAX];    // ETag of the last response
+    char responseLastModified[HTTP_FETCH_VALIDATOR_MAX]; // Last-Modified of the last response
+
+    char headers[HTTP_FETCH_HEADER_MAX + 1]; // Received response headers
+    size_t headerLength;                    // Bytes in the header buffer
+    bool responseStarted;                   // A response byte arrived, interim responses included
+
+    char body[HTTP_FETCH_BODY_MAX + 1];     // Received response body
+    size_t bodyLength;                      // Body bytes received so far
+    long contentLength;                     // Announced body length, -1 if unknown
+    long maxAge;                            // Cache-Control max-age in seconds, -1 if not sent
+    long retryAfter;                        // Retry-After in seconds, -1 if not sent
+    bool chunked;                           // Body uses chunked transfer encoding
+    ChunkState chunkState;                  // Chunk decoder state
+    unsigned long chunkRemaining;           // Size or unread payload of the current chunk
+    bool trailerLineStarted;                // Current trailer line is not empty
+    char receiveBuffer[HTTP_FETCH_IO_CHUNK]; // Raw body bytes of one recv() call
+    HttpBodyHandler bodyHandler;            // Streaming body consumer, nullptr to buffer
+    void* bodyHandlerContext;               // Context passed to bodyHandler
+
+    bool keepAlive;                         // Server allows reusing the connection
+    bool reusedConnection;                  // Current attempt runs on a reused connection
+    uint32_t reuseCount;                    // Statistics: reused connections
+    uint32_t reconnectCount;                // Statistics: reopened kept-alive connections
+    uint32_t connectCount;                  // Statistics: opened connections
+
+    /**
+     * @brief Resolve the host name, waiting for the DNS callback
+     */
+    void stepResolve();
+
+    /**
+     * @brief Check whether the non-blocking connect has finished
+     */
+    void stepConnect();
+
+    /**
+     * @brief Send the next part of the request
+     */
+    void stepSend();
+
+    /**
+     * @brief Receive the next part of the response headers
+     */
+    void stepReadHeaders();
+
+    /**
+     * @brief Receive the next part of the response body
+     */
+    void stepReadBody();
+
+    /**
+     * @brief Process received body bytes, removing the chunked framing
+     * @param data Bytes as received from the socket
+     * @param length Number of bytes
+     */
+    void consumeBody(const char* data, size_t length);
+
+    /**
+     * @brief Pass decoded body bytes to the handler or the body buffer
+     * @param data Body bytes
+     * @param length Number of bytes
+     */
+    void deliverBody(const char* data, size_t length);
+
+    /**
+     * @brief Open a non-blocking socket and start connecting
+     */
+    void openConnection();
+
+    /**
+     * @brief Check if an idle kept-alive connection is still usable
+     * @return True if the server has not closed the connection
+     */
+    bool isConnectionAlive();
+
+    /**
+     * @brief Resend the request on a new connection if a reused one failed
+     * @return True if the request was restarted
+     */
+    bool retryOnNewConnection();
+
+    /**
+     * @brief Parse the complete response header block
+     * @return True if the headers describe a response we can read
+     */
+    bool parseHeaders();
+
+    /**
+     * @brief Copy a header value, skipping leading whitespace
+     * @param target Buffer to copy into
+     * @param value Header value after the colon
+     */
+    static void copyHeaderValue(char (&target)[HTTP_FETCH_VALIDATOR_MAX], const char* value);
+
+    /**
+     * @brief Finish the request, closing the socket unless it can be reused
+     * @param code Status code or error to report
+     */
+    void finish(int code);
+
+    /**
+     * @brief Add the time since the last phase change to a phase
+     * @param duration Phase duration to add to
+     */
+    void endPhase(uint32_t& duration);
+
+    /**
+     * @brief Close the socket if open
+     */
+    void closeSocket();
+};
+
+#endif // HTTP_FETCH_H
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include <atomic>
+#include <stdarg.h>
+
+#define LOG_TAG "log"
+#include "logger.h"
+
+/**
+ * @brief One line in the log queue
+ *
+ * The sequence number tells who owns the slot. With base being the write
+ * position without the slot index bits, it equals base while the slot is
+ * free and base + 1 once the line is complete. All zero is a free queue,
+ * so logging works before any constructor has run.
+ */
+struct LogSlot {
+    std::atomic<uint32_t> sequence;    // Ownership, see above
+    uint16_t length;                   // Bytes in text
+    char text[LOG_LINE_MAX];           // Formatted line or framed tokenized line
+};
+
+// Bounded multi-producer queue, any task may log, only the drain task reads
+static LogSlot logSlots[LOG_QUEUE_SLOTS];
+static std::atomic<uint32_t> logWritePosition(0);   // Next slot claimed by a producer
+static uint32_t logReadPosition = 0;                // Next slot written to the serial port
+static std::atomic<uint32_t> droppedLines(0);       // Lines lost to a full queue
+static uint32_t reportedDroppedLines = 0;           // Dropped lines already reported
+static std::atomic_flag drainLock = ATOMIC_FLAG_INIT; // Held by the log task or flushLogging() while draining
+
+// Bits of a queue position that select the slot
+static const uint32_t LOG_SLOT_MASK = LOG_QUEUE_SLOTS - 1;
+
+/**
+ * @brief Write the next complete line to the serial port
+ * @return True if a line was written, false if the queue is empty
+ */
+static bool drainLogLine() {
+    uint32_t base = logReadPosition & ~LOG_SLOT_MASK;
+    LogSlot& slot = logSlots[logReadPosition & LOG_SLOT_MASK];
+    if (slot.sequence.load(std::memory_order_acquire) != base + 1) {
+        return false;
+    }
+
+    // Only this task blocks if the UART is slow
+    Serial.write(reinterpret_cast<const uint8_t*>(slot.text), slot.length);
+
+    // Hand the slot back to the producers for the next round
+    slot.sequence.store(base + LOG_QUEUE_SLOTS, std::memory_order_release);
+    logReadPosition++;
+    return true;
+}
+
+/**
+ * @brief Write all queued lines and report lines dropped since the last report
+ *
+ * Only call with drainLock held, the queue has a single reader.
+ */
+static void drainLogQueue() {
+    while (drainLogLine()) {
+    }
+
+    // Queued like any other line, so it is tokenized as well
+    uint32_t dropped = droppedLines.load(std::memory_order_relaxed);
+    if (dropped != reportedDroppedLines) {
+        LOG_WARN("%lu lines dropped", (unsigned long)(dropped - reportedDroppedLines));
+        reportedDroppedLines = dropped;
+        while (drainLogLine()) {
+        }
+    }
+}
+
+/**
+ * @brief Drain task, writes queued lines whenever the CPU is otherwise idle
+ * @param parameter Unused task parameter
+ */
+static void logTask(void* parameter) {
+    for (;;) {
+        if (!drainLock.test_and_set(std::memory_order_acquire)) {
+            drainLogQueue();
+            drainLock.clear(std::memory_order_release);
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(LOG_TASK_INTERVAL));
+    }
+}
+
+/**
+ * @brief Start the task writing queued log lines to the serial port
+ *
+ * Lines logged before this call wait in the queue.
+ */
+void initLogging() {
+    xTaskCreatePinnedToCore(logTask, "log", LOG_TASK_STACK_SIZE, nullptr,
+                            LOG_TASK_PRIORITY, nullptr, LOG_TASK_CORE);
+}
+
+/**
+ * @brief Write every queued line before returning
+ *
+ * Waits for a drain round of the log task to end, then drains the queue
+ * in the calling task and flushes the serial port. For the last lines
+ * before a restart or the end of a host program.
+ */
+void flushLogging() {
+    while (drainLock.test_and_set(std::memory_order_acquire)) {
+        vTaskDelay(1);
+    }
+    drainLogQueue();
+    drainLock.clear(std::memory_order_release);
+    Serial.flush();
+}
+
+/**
+ * @brief Claim a free slot, lock-free so a preempted producer never stalls another task
+ * @param position Set to the claimed queue position
+ * @return Claimed slot, nullptr if the queue is full and the line was dropped
+ */
+static LogSlot* claimLogSlot(uint32_t& position) {
+    position = logWritePosition.load(std::memory_order_relaxed);
+    for (;;) {
+        LogSlot* slot = &logSlots[position & LOG_SLOT_MASK];
+        int32_t difference = (int32_t)(slot->sequence.load(std::memory_order_acquire) - (position & ~LOG_SLOT_MASK));
+        if (difference == 0) {
+            if (logWritePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return slot;
+            }
+        } else if (difference < 0) {
+            droppedLines.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = logWritePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Hand a filled slot to the drain task
+ * @param slot Slot returned by claimLogSlot()
+ * @param position Queue position returned by claimLogSlot()
+ */
+static void publishLogSlot(LogSlot* slot, uint32_t position) {
+    slot->sequence.store((position & ~LOG_SLOT_MASK) + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Format a line into the log queue, never blocks
+ *
+ * Use the LOG_* macros instead of calling this directly. The line is
+ * dropped if the queue is full.
+ *
+ * @param format printf format of the whole line
+ */
+void logWrite(const char* format, ...) {
+    uint32_t position;
+    LogSlot* slot = claimLogSlot(position);
+    if (slot == nullptr) {
+        return;
+    }
+
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(slot->text, sizeof(slot->text), format, arguments);
+    va_end(arguments);
+
+    // Cut lines keep their line break
+    if (length < 0) {
+        length = 0;
+    } else if (length >= (int)sizeof(slot->text)) {
+        length = sizeof(slot->text) - 1;
+        slot->text[length - 1] = '\n';
+    }
+    slot->length = length;
+
+    publishLogSlot(slot, position);
+}
+
+/**
+ * @brief Queue a tokenized line, never blocks
+ *
+ * The frame is COBS encoded between two zero bytes. The leading zero lets
+ * the decoder resynchronize after boot messages or a reset.
+ *
+ * @param frame Encoded line, see LogEncoder
+ * @param length Bytes in the line, at most LOG_FRAME_MAX
+ */
+void logWriteFrame(const uint8_t* frame, size_t length) {
+    uint32_t position;
+    LogSlot* slot = claimLogSlot(position);
+    if (slot == nullptr) {
+        return;
+    }
+
+    // COBS replaces every zero by the distance to the next one
+    uint8_t* out = reinterpret_cast<uint8_t*>(slot->text);
+    size_t outLength = 0;
+    out[outLength++] = 0;
+    size_t codeIndex = outLength++;
+    uint8_t code = 1;
+    for (size_t i = 0; i < length; i++) {
+        if (frame[i] == 0) {
+            out[codeIndex] = code;
+            codeIndex = outLength++;
+            code = 1;
+        } else {
+            out[outLength++] = frame[i];
+            code++;
+        }
+    }
+    out[codeIndex] = code;
+    out[outLength++] = 0;
+    slot->length = outLength;
+
+    publishLogSlot(slot, position);
+}
+
+/**
+ * @brief Get the number of lines dropped because the queue was full
+ * @return Dropped line count since boot
+ */
+uint32_t getDroppedLogLines() {
+    return droppedLines.load(std::memory_order_relaxed);
+}
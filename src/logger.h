@@ -0,0 +1,243 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "clock.h"
+
+// Log levels, a line is kept if its level is not above the configured level
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+// Level of the whole firmware, can be overridden with -DLOG_LEVEL=... in build_flags
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Level of one source file, define it before the first include to override LOG_LEVEL
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL LOG_LEVEL
+#endif
+
+// Send format string addresses and raw arguments instead of text, see scripts/log_decoder.py
+#ifndef LOG_TOKENIZED
+#define LOG_TOKENIZED 0
+#endif
+
+// Log queue and drain task settings
+#define LOG_LINE_MAX 128               // Longest line including prefix, longer lines are cut
+#define LOG_QUEUE_SLOTS 32             // Lines waiting for the drain task, must be a power of two
+#define LOG_TASK_CORE 0                // Core of the drain task, away from the render task
+#define LOG_TASK_PRIORITY 0            // Lowest priority, runs when nothing else has to
+#define LOG_TASK_STACK_SIZE 3072       // Drain task stack in bytes
+#define LOG_TASK_INTERVAL 20           // Delay when the queue is empty in milliseconds
+#define LOG_FRAME_MAX (LOG_LINE_MAX - 3) // Tokenized line before framing, which adds 3 bytes
+
+/**
+ * Every source file that logs defines its tag before including this header:
+ *
+ *     #define LOG_TAG "wifi"
+ *     #include "logger.h"
+ *
+ * Lines look like "I (12345) wifi: WiFi connected", the number being
+ * clockMillis(). Lines above LOG_LOCAL_LEVEL are removed by the compiler
+ * together with their format strings and arguments.
+ *
+ * With LOG_TOKENIZED the line is not formatted on the device. The address
+ * of the format string and the arguments are sent in a binary frame, the
+ * format string itself only exists in flash and in the ELF file.
+ */
+#define LOG_FORMAT(letter, format) #letter " (%lu) " LOG_TAG ": " format "\n"
+#if LOG_TOKENIZED
+#define LOG_EMIT(format, ...) do { \
+        if (false) { \
+            logCheckFormat(format, ##__VA_ARGS__); \
+        } \
+        logTokenized(format, ##__VA_ARGS__); \
+    } while (0)
+#else
+#define LOG_EMIT(format, ...) logWrite(format, ##__VA_ARGS__)
+#endif
+#define LOG_AT(level, letter, format, ...) do { \
+        if ((level) <= LOG_LOCAL_LEVEL) { \
+            LOG_EMIT(LOG_FORMAT(letter, format), (unsigned long)clockMillis(), ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_ERROR(format, ...) LOG_AT(LOG_LEVEL_ERROR, E, format, ##__VA_ARGS__)
+#define LOG_WARN(format, ...)  LOG_AT(LOG_LEVEL_WARN, W, format, ##__VA_ARGS__)
+#define LOG_INFO(format, ...)  LOG_AT(LOG_LEVEL_INFO, I, format, ##__VA_ARGS__)
+#define LOG_DEBUG(format, ...) LOG_AT(LOG_LEVEL_DEBUG, D, format, ##__VA_ARGS__)
+
+/**
+ * @brief Start the task writing queued log lines to the serial port
+ *
+ * Lines logged before this call wait in the queue.
+ */
+void initLogging();
+
+/**
+ * @brief Write every queued line before returning
+ *
+ * Blocks on the serial port, for the last lines before a restart or the
+ * end of a host program.
+ */
+void flushLogging();
+
+/**
+ * @brief Format a line into the log queue, never blocks
+ *
+ * Use the LOG_* macros instead of calling this directly. The line is
+ * dropped if the queue is full.
+ *
+ * @param format printf format of the whole line
+ */
+void logWrite(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief Queue a tokenized line, never blocks
+ *
+ * Frames are delimited by zero bytes and COBS encoded, so they contain
+ * no zero bytes themselves.
+ *
+ * @param frame Encoded line, see LogEncoder
+ * @param length Bytes in the line, at most LOG_FRAME_MAX
+ */
+void logWriteFrame(const uint8_t* frame, size_t length);
+
+/**
+ * @brief Lets the compiler check the arguments of a tokenized line, never called
+ * @param format printf format of the whole line
+ */
+inline void logCheckFormat(const char* format, ...) __attribute__((format(printf, 1, 2)));
+inline void logCheckFormat(const char* format, ...) {
+}
+
+/**
+ * @brief Packs a tokenized line: format string address, then every argument
+ *
+ * Integers are sent as unsigned LEB128 varints of their 32-bit (or 64-bit)
+ * pattern, strings as varint length and bytes, floating point values as
+ * little endian doubles. The decoder reads them back in the order of the
+ * conversions in the format string. Arguments that do not fit are cut off.
+ */
+class LogEncoder {
+public:
+    /**
+     * @brief Constructor, starts a frame
+     * @param format Format string, its address identifies the line
+     */
+    explicit LogEncoder(const char* format) :
+        length(0) {
+        uint32_t token = (uint32_t)(uintptr_t)format;
+        addBytes(&token, sizeof(token));
+    }
+
+    /**
+     * @brief Add an integer or enum argument
+     * @param value Argument
+     */
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type add(T value) {
+        if (sizeof(T) <= sizeof(uint32_t)) {
+            addVarint((uint32_t)value);
+        } else {
+            addVarint((uint64_t)value);
+        }
+    }
+
+    /**
+     * @brief Add a string argument
+     * @param text Null terminated string, nullptr is sent as "(null)"
+     */
+    void add(const char* text) {
+        if (text == nullptr) {
+            text = "(null)";
+        }
+        size_t textLength = strlen(text);
+        size_t room = length + 2 < LOG_FRAME_MAX ? LOG_FRAME_MAX - length - 2 : 0;
+        if (textLength > room) {
+            textLength = room;
+        }
+        addVarint(textLength);
+        addBytes(text, textLength);
+    }
+
+    /**
+     * @brief Add a floating point argument
+     * @param value Argument
+     */
+    void add(double value) {
+        addBytes(&value, sizeof(value));
+    }
+
+    /**
+     * @brief Add a pointer argument
+     * @param pointer Argument
+     */
+    void add(const void* pointer) {
+        addVarint((uint32_t)(uintptr_t)pointer);
+    }
+
+    /**
+     * @brief Queue the frame
+     */
+    void send() {
+        logWriteFrame(data, length);
+    }
+
+private:
+    uint8_t data[LOG_FRAME_MAX];    // Frame so far
+    size_t length;                  // Bytes in data
+
+    /**
+     * @brief Add an unsigned LEB128 varint
+     * @param value Value to add
+     */
+    void addVarint(uint64_t value) {
+        while (value >= 0x80 && length < LOG_FRAME_MAX) {
+            data[length++] = (uint8_t)(value | 0x80);
+            value >>= 7;
+        }
+        if (length < LOG_FRAME_MAX) {
+            data[length++] = (uint8_t)value;
+        }
+    }
+
+    /**
+     * @brief Add raw bytes, as many as fit
+     * @param bytes Bytes to add
+     * @param count Number of bytes
+     */
+    void addBytes(const void* bytes, size_t count) {
+        if (count > LOG_FRAME_MAX - length) {
+            count = LOG_FRAME_MAX - length;
+        }
+        memcpy(data + length, bytes, count);
+        length += count;
+    }
+};
+
+/**
+ * @brief Queue a tokenized line, use the LOG_* macros instead
+ * @param format Format string of the whole line
+ * @param args Arguments of the format string
+ */
+template <typename... Args>
+inline void logTokenized(const char* format, Args... args) {
+    LogEncoder encoder(format);
+    int expand[] = {0, (encoder.add(args), 0)...};
+    (void)expand;
+    encoder.send();
+}
+
+/**
+ * @brief Get the number of lines dropped because the queue was full
+ * @return Dropped line count since boot
+ */
+uint32_t getDroppedLogLines();
+
+#endif // LOGGER_H
@@ -1,11 +1,21 @@
 #include "main.h"
 #include "matrix_config.h"
 #include "counter.h"
+#include "shared_state.h"
 #include <Arduino.h>
 #include <SPIFFS.h>
 #include "instagram_logo.h"
 #include "wifi_manager.h"
+#include "config_store.h"
+#include "profiler.h"
+#include "metrics_server.h"
+#include "heap_stats.h"
+#include "clock.h"
 #include "animations/animation_manager.h"
+#include "animations/animation_benchmark.h"
+
+#define LOG_TAG "main"
+#include "logger.h"
 
 // Global animation manager instance
 AnimationManager animationManager;
@@ -15,28 +25,50 @@ AnimationManager animationManager;
  */
 void setup() {
     Serial.begin(BAUD_RATE);
-    Serial.println("Starting counter application...");
+    
+    // Serial output is written by a low priority task from now on
+    initLogging();
+    LOG_INFO("Starting counter application...");
     
     if (!SPIFFS.begin(true)) {
-        Serial.println("SPIFFS initialization failed.");
+        LOG_ERROR("SPIFFS initialization failed.");
     } else {
-        Serial.println("SPIFFS initialized successfully.");
+        LOG_INFO("SPIFFS initialized successfully.");
+        
+        // Configuration is read once here, nothing touches the files afterwards
+        if (!configStore.begin()) {
+            printSpiffsFiles();
+        }
     }
     
     initMatrix();
     
-    // Initialize WiFi connection with fallback to captive portal
-    initWiFiWithCaptivePortal();
+    // Initialize animations
+    initAnimations();
     
-    // Initialize OTA after WiFi is connected
-    // OTA is now initialized in initWiFiWithCaptivePortal() if WiFi connects successfully
+#if ANIMATION_BENCHMARK
+    // Measure every style before the other tasks compete for the CPU
+    runAnimationBenchmarks();
+#endif
     
+    // Restore the last known counter, fetching happens later in the network task
     initCounter();
     
-    // Initialize animations
-    initAnimations();
+    // Start rendering right away so the panel stays alive while connecting
+    publishNetworkState();
+    xTaskCreatePinnedToCore(renderTask, "render", RENDER_TASK_STACK_SIZE, nullptr,
+                            RENDER_TASK_PRIORITY, nullptr, RENDER_TASK_CORE);
+    
+    // Start connecting in the background, falls back to the captive portal
+    initWiFiWithCaptivePortal();
+    
+    // OTA is initialized by the WiFi state machine once connected
+    
+    // Everything network related runs on the other core from now on
+    xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK_SIZE, nullptr,
+                            NETWORK_TASK_PRIORITY, nullptr, NETWORK_TASK_CORE);
     
-    Serial.println("Initialization complete.");
+    LOG_INFO("Initialization complete.");
 }
 
 /**
@@ -45,87 +77,170 @@ void setup() {
 void initAnimations() {
     // Initialize animations with durations set in animation_config.h
     animationManager.init();
-    Serial.println("Animations initialized");
+    LOG_INFO("Animations initialized");
 }
 
 /**
- * @brief Main program loop
+ * @brief Main program loop, unused since work runs in dedicated tasks
+ */
+void loop() {
+    // The Arduino loop task is not needed anymore
+    vTaskDelete(nullptr);
+}
+
+/**
+ * @brief Render task, refreshes the display at a fixed frame period
+ * @param parameter Unused task parameter
  */
 unsigned long loopCounter = 0;
 
-void loop() {
-    loopCounter++;
-    unsigned long startMillis = millis();
-    
-    // Handle OTA updates
-    handleOTA();
+void renderTask(void* parameter) {
+    TickType_t lastWakeTime = xTaskGetTickCount();
     
-    // Handle captive portal if active, otherwise maintain WiFi connection
-    if (!handleCaptivePortal()) {
-        // Only check WiFi if captive portal is not active
-        checkAndMaintainWiFi();
+    for (;;) {
+        loopCounter++;
+        uint64_t startMicros = clockMicros();
         
-        // Update counter data using non-blocking approach - only if WiFi is connected
-        if (WiFi.status() == WL_CONNECTED) {
-            // First, check if we need to start a new request
-            bool fetchStarted = checkCounterUpdateTime();
-            if (fetchStarted) {
-                Serial.println("Counter update initiated");
+        // Refresh display
+        updateDisplay();
+        
+        // Log frame performance
+        manageLoopTiming(startMicros);
+        
+        // Wait for the next frame slot, independent of how long the frame took
+        vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(REFRESH_INTERVAL));
+    }
+}
+
+/**
+ * @brief Network task, handles OTA, WiFi, captive portal, API and metrics requests
+ * 
+ * WiFi reconnects are event driven and HTTP requests are non-blocking.
+ * Anything slow in here only delays this task, the render task keeps its
+ * frame rate on the other core.
+ * 
+ * @param parameter Unused task parameter
+ */
+void networkTask(void* parameter) {
+    for (;;) {
+        // Handle OTA updates
+        {
+            PROFILE_SCOPE(PROFILE_STAGE_OTA);
+            handleOTA();
+        }
+        
+        // Handle captive portal if active, otherwise maintain WiFi connection
+        bool portalActive;
+        {
+            PROFILE_SCOPE(PROFILE_STAGE_PORTAL);
+            portalActive = handleCaptivePortal();
+        }
+        
+        if (!portalActive) {
+            // Only check WiFi if captive portal is not active
+            {
+                PROFILE_SCOPE(PROFILE_STAGE_WIFI);
+                checkAndMaintainWiFi();
             }
             
-            // Then, check if any in-progress request has completed
-            APIRequestState state = getAPIRequestState();
-            if (state == API_REQUEST_COMPLETE) {
-                bool processed = processAsyncCounterFetch();
-                if (processed) {
-                    Serial.println("Counter updated");
+            // Update counter data using non-blocking approach - only if WiFi is connected
+            if (WiFi.status() == WL_CONNECTED) {
+                PROFILE_SCOPE(PROFILE_STAGE_FETCH);
+                
+                // Push updates arrive over a stream, polling only runs while it is down
+                updateCounterStream();
+                
+                // First, check if we need to start a new request
+                bool fetchStarted = checkCounterUpdateTime();
+                if (fetchStarted) {
+                    LOG_DEBUG("Counter update initiated");
                 }
+                
+                // Then, check if any in-progress request has completed
+                APIRequestState state = getAPIRequestState();
+                if (state == API_REQUEST_COMPLETE) {
+                    bool processed = processAsyncCounterFetch();
+                    if (processed) {
+                        LOG_DEBUG("Counter updated");
+                    }
+                }
+            }
+            
+            // Answer metrics scrapes, the render task keeps running on the other core
+            if (WiFi.status() == WL_CONNECTED) {
+                handleMetricsServer();
             }
         }
+        
+        // Persist the last good counter, flash writes are coalesced
+        serviceCounterStore();
+        
+        // Heap figures for long-running checks, off unless HEAP_REPORT_INTERVAL is set
+        serviceHeapReport();
+        
+        // Hand the results over to the render task
+        publishNetworkState();
+        
+        vTaskDelay(pdMS_TO_TICKS(NETWORK_TASK_INTERVAL));
     }
-    
-    // Refresh display
-    updateDisplay();
-    
-    // Rate limit the loop execution
-    manageLoopTiming(startMillis);
+}
+
+/**
+ * @brief Publish the current counter and connection status to the render task
+ */
+void publishNetworkState() {
+    DisplayState state;
+    state.counter = getCounterValue();
+    state.wifiConnected = WiFi.status() == WL_CONNECTED;
+    state.lastRequestSuccessful = isLastRequestSuccessful();
+    state.counterFresh = isCounterFresh();
+    publishDisplayState(state);
 }
 
 /**
  * @brief Update the display with counter and status
  */
 void updateDisplay() {
-    matrix->clearScreen();
-    // Use animation manager to draw the counter with the current animation style
-    bool needsRefresh = animationManager.update(getCounterValue());
+    PROFILE_SCOPE(PROFILE_STAGE_FRAME);
+    
+    // Read the state published by the network task, never blocks
+    DisplayState state = readDisplayState();
+    
+    // Use animation manager to draw the counter with the current animation style.
+    // The screen is not cleared here, animations only repaint their dirty regions.
+    bool needsRefresh;
+    {
+        PROFILE_SCOPE(PROFILE_STAGE_ANIMATION);
+        needsRefresh = animationManager.update(state.counter);
+    }
     if (needsRefresh) {
-        // Animation state changed and needs a refresh
-        Serial.println("Animation refreshed");
+        // Animation state changed and was repainted
+        LOG_DEBUG("Animation refreshed");
     }
     
-    // Update status indicator with both WiFi and counter status
-    bool wifiConnected = WiFi.status() == WL_CONNECTED;
-    updateStatusIndicator(wifiConnected, isLastRequestSuccessful());
+    // Update status indicator with WiFi, counter and data freshness status
+    {
+        PROFILE_SCOPE(PROFILE_STAGE_STATUS);
+        updateStatusIndicator(state.wifiConnected, state.lastRequestSuccessful, !state.counterFresh);
+    }
 }
 
 /**
- * @brief Manage the loop timing and log performance
+ * @brief Log frame timing and performance
  * 
- * @param startMillis Time when loop started
+ * @param startMicros Time when the frame started, see clockMicros()
  */
-void manageLoopTiming(unsigned long startMillis) {
-    unsigned long elapsedTime = millis() - startMillis;
+void manageLoopTiming(uint64_t startMicros) {
+    uint64_t elapsedMicros = clockMicros() - startMicros;
     
-    // Add delay if needed
-    if (elapsedTime < REFRESH_INTERVAL) {
-        delay(REFRESH_INTERVAL - elapsedTime);
-    } else {
-        Serial.printf("Loop took longer than %dms, skipping delay\n", REFRESH_INTERVAL);
+    // Pacing is done by vTaskDelayUntil, only report overruns here
+    if (elapsedMicros >= (uint64_t)REFRESH_INTERVAL * 1000) {
+        LOG_WARN("Frame took %lu us, longer than %dms", (unsigned long)elapsedMicros, REFRESH_INTERVAL);
     }
     
-    // Log performance occasionally
-    if (loopCounter % 1000 == 0) {
-        Serial.printf("Loop counter: %lu\n", loopCounter);
-        Serial.printf("Loop took: %lu ms\n", millis() - startMillis);
+    // Log where the frame budget goes occasionally
+    if (loopCounter % PROFILE_REPORT_FRAMES == 0) {
+        LOG_INFO("Loop counter: %lu", loopCounter);
+        profiler.report();
     }
 }
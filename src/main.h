@@ -11,6 +11,15 @@
 // Application settings
 #define REFRESH_INTERVAL 100 // Display refresh interval in milliseconds
 
+// Task settings
+#define RENDER_TASK_CORE 1             // Core running the display refresh
+#define RENDER_TASK_PRIORITY 2         // Above the Arduino loop task
+#define RENDER_TASK_STACK_SIZE 4096    // Render task stack in bytes
+#define NETWORK_TASK_CORE 0            // Core running WiFi, OTA and API requests
+#define NETWORK_TASK_PRIORITY 1        // Same as the Arduino loop task
+#define NETWORK_TASK_STACK_SIZE 8192   // Network task stack in bytes
+#define NETWORK_TASK_INTERVAL 10       // Network task polling interval in milliseconds
+
 // Global animation manager
 extern AnimationManager animationManager;
 
@@ -25,11 +34,28 @@ void initAnimations();
 void updateDisplay();
 
 /**
- * @brief Manage the loop timing and log performance
+ * @brief Log frame timing and performance
  * 
- * @param startMillis Time when loop started
+ * @param startMicros Time when the frame started, see clockMicros()
+ */
+void manageLoopTiming(uint64_t startMicros);
+
+/**
+ * @brief Render task, refreshes the display at a fixed frame period
+ * @param parameter Unused task parameter
+ */
+void renderTask(void* parameter);
+
+/**
+ * @brief Network task, handles OTA, WiFi, captive portal, API and metrics requests
+ * @param parameter Unused task parameter
+ */
+void networkTask(void* parameter);
+
+/**
+ * @brief Publish the current counter and connection status to the render task
  */
-void manageLoopTiming(unsigned long startMillis);
+void publishNetworkState();
 
 /**
  * @brief Setup function called once at startup
@@ -37,7 +63,7 @@ void manageLoopTiming(unsigned long startMillis);
 void setup();
 
 /**
- * @brief Main program loop
+ * @brief Main program loop, unused since work runs in dedicated tasks
  */
 void loop();
 
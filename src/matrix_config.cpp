@@ -1,16 +1,23 @@
 #include "matrix_config.h"
+
+#ifdef ARDUINO
 #include <SPIFFS.h>
 #include <JPEGDecoder.h>
+#endif
+
+#define LOG_TAG "matrix"
+#include "logger.h"
 
 // Global matrix instance
 MatrixPanel_I2S_DMA *matrix = nullptr;
 
 /**
- * @brief Update the status indicator in the bottom left pixel
+ * @brief Update the status indicators in the bottom left and bottom right pixels
  * @param wifiConnected True if WiFi is connected, false otherwise
  * @param updateSuccessful True if counter update was successful, false if there was an error
+ * @param dataStale True while the shown counter is a stored value not yet confirmed by the API
  */
-void updateStatusIndicator(bool wifiConnected, bool updateSuccessful) {
+void updateStatusIndicator(bool wifiConnected, bool updateSuccessful, bool dataStale) {
     if (matrix != nullptr) {
         uint16_t color;
         
@@ -24,6 +31,9 @@ void updateStatusIndicator(bool wifiConnected, bool updateSuccessful) {
         
         // Draw a single pixel at bottom left corner (0, PANEL_HEIGHT-1)
         matrix->drawPixel(0, PANEL_HEIGHT-1, color);
+        
+        // Stale data pixel at bottom right corner, off once fresh data arrived
+        matrix->drawPixel(PANE_WIDTH-1, PANEL_HEIGHT-1, dataStale ? COUNTER_STALE_COLOR : 0);
     }
 }
 
@@ -49,7 +59,7 @@ MatrixPanel_I2S_DMA* initMatrix() {
     matrix->setBrightness8(255);
     
     // Initialize WiFi status indicator as disconnected by default
-    updateStatusIndicator(false, false);
+    updateStatusIndicator(false, false, true);
     
     return matrix;
 }
@@ -177,24 +187,27 @@ void displayBitmap(const uint8_t* bitmap, uint16_t width, uint16_t height,
  * @return True if successful, false if failed
  */
 bool displayJPEG(const char* filename, uint16_t x, uint16_t y, uint16_t maxWidth, uint16_t maxHeight, bool centerPos) {
+#ifndef ARDUINO
+    // Host builds have no file system or JPEG decoder
+    LOG_WARN("JPEG not supported in host builds: %s", filename);
+    return false;
+#else
     // Check if SPIFFS is initialized
     if (!SPIFFS.begin(true)) {
-        Serial.println("SPIFFS initialization failed");
+        LOG_ERROR("SPIFFS initialization failed");
         return false;
     }
     
     // Check if file exists
     if (!SPIFFS.exists(filename)) {
-        Serial.print("File not found: ");
-        Serial.println(filename);
+        LOG_WARN("File not found: %s", filename);
         return false;
     }
 
     // Open the file
     File jpegFile = SPIFFS.open(filename, "r");
     if (!jpegFile) {
-        Serial.print("Failed to open file: ");
-        Serial.println(filename);
+        LOG_WARN("Failed to open file: %s", filename);
         return false;
     }
 
@@ -229,22 +242,18 @@ bool displayJPEG(const char* filename, uint16_t x, uint16_t y, uint16_t maxWidth
     uint16_t startY = centerPos ? y - (displayHeight / 2) : y;
     
     // Output to serial for debugging
-    Serial.print("JPEG dimensions: ");
-    Serial.print(jpegWidth);
-    Serial.print("x");
-    Serial.println(jpegHeight);
-    Serial.print("Display dimensions: ");
-    Serial.print(displayWidth);
-    Serial.print("x");
-    Serial.println(displayHeight);
+    LOG_DEBUG("JPEG dimensions: %ux%u", jpegWidth, jpegHeight);
+    LOG_DEBUG("Display dimensions: %ux%u", displayWidth, displayHeight);
     
     // Render the image
     displayJPEGBlocks(startX, startY, scale, displayWidth, displayHeight);
     
     jpegFile.close();
     return true;
+#endif
 }
 
+#ifdef ARDUINO
 /**
  * @brief Helper function to display JPEG MCU blocks
  * @param startX Starting X position
@@ -288,4 +297,5 @@ void displayJPEGBlocks(uint16_t startX, uint16_t startY, float scale,
             }
         }
     }
-}
\ No newline at end of file
+}
+#endif
@@ -38,6 +38,7 @@
 // Counter status indicator colors
 #define COUNTER_UPDATED_COLOR 0x07E0    // Green
 #define COUNTER_ERROR_COLOR 0xFC00      // Orange
+#define COUNTER_STALE_COLOR 0x001F      // Blue, shown value is from before the last boot
 
 // Function declarations
 /**
@@ -101,11 +102,12 @@ void displayJPEGBlocks(uint16_t startX, uint16_t startY, float scale,
                       uint16_t displayWidth, uint16_t displayHeight);
 
 /**
- * @brief Update the status indicator in the bottom left pixel
+ * @brief Update the status indicators in the bottom left and bottom right pixels
  * @param wifiConnected True if WiFi is connected, false otherwise
  * @param updateSuccessful True if counter update was successful, false if there was an error
+ * @param dataStale True while the shown counter is a stored value not yet confirmed by the API
  */
-void updateStatusIndicator(bool wifiConnected, bool updateSuccessful);
+void updateStatusIndicator(bool wifiConnected, bool updateSuccessful, bool dataStale);
 
 extern MatrixPanel_I2S_DMA *matrix;
 
@@ -0,0 +1,405 @@
+#include "metrics_json_scanner.h"
+#include <limits.h>
+
+// Keys of the fields we extract
+static const char KEY_FOLLOWERS_COUNT[] = "followers_count";
+static const char KEY_USERNAME[] = "username";
+static const char KEY_LAST_UPDATED[] = "last_updated";
+
+/**
+ * @brief Constructor
+ */
+MetricsJsonScanner::MetricsJsonScanner() {
+    reset();
+}
+
+/**
+ * @brief Forget all data and start scanning a new document
+ */
+void MetricsJsonScanner::reset() {
+    state = SCAN_START;
+    field = FIELD_NONE;
+    key[0] = '\0';
+    keyLength = 0;
+    keyTruncated = false;
+    escape = false;
+    unicodeDigits = 0;
+    nestedInString = false;
+    nestedDepth = 0;
+    stringTarget = nullptr;
+    stringCapacity = 0;
+    stringLength = 0;
+
+    followersFound = false;
+    followersCount = 0;
+    numberPart = NUMBER_INTEGER;
+    fractionDigits = 0;
+    exponent = 0;
+    exponentNegative = false;
+    username[0] = '\0';
+    lastUpdated[0] = '\0';
+}
+
+/**
+ * @brief Scan the next part of the document
+ * @param data Received bytes
+ * @param length Number of bytes
+ */
+void MetricsJsonScanner::feed(const char* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (state == SCAN_DONE || state == SCAN_ERROR) {
+            return;
+        }
+        scanChar(data[i]);
+    }
+}
+
+/**
+ * @brief Check if the top-level object has been read completely
+ * @return True if the closing brace was seen without syntax errors
+ */
+bool MetricsJsonScanner::isComplete() const {
+    return state == SCAN_DONE;
+}
+
+/**
+ * @brief Check if the document is not valid JSON
+ * @return True if a syntax error was found
+ */
+bool MetricsJsonScanner::hasError() const {
+    return state == SCAN_ERROR;
+}
+
+/**
+ * @brief Check if followers_count was present
+ * @return True if a followers_count number was found
+ */
+bool MetricsJsonScanner::hasFollowersCount() const {
+    return followersFound;
+}
+
+/**
+ * @brief Get the extracted follower count
+ * @return Follower count, 0 if not present
+ */
+unsigned long MetricsJsonScanner::getFollowersCount() const {
+    return followersCount;
+}
+
+/**
+ * @brief Get the extracted user name
+ * @return User name, empty if not present
+ */
+const char* MetricsJsonScanner::getUsername() const {
+    return username;
+}
+
+/**
+ * @brief Get the extracted last update timestamp
+ * @return Timestamp string, empty if not present
+ */
+const char* MetricsJsonScanner::getLastUpdated() const {
+    return lastUpdated;
+}
+
+/**
+ * @brief Process one character
+ * @param c Character to process
+ */
+void MetricsJsonScanner::scanChar(char c) {
+    switch (state) {
+        case SCAN_START:
+            if (c == '{') {
+                state = SCAN_KEY_OR_END;
+            } else if (!isSpace(c)) {
+                state = SCAN_ERROR;
+            }
+            break;
+
+        case SCAN_KEY_OR_END:
+        case SCAN_KEY_START:
+            if (c == '"') {
+                keyLength = 0;
+                keyTruncated = false;
+                escape = false;
+                state = SCAN_KEY;
+            } else if (c == '}' && state == SCAN_KEY_OR_END) {
+                state = SCAN_DONE;
+            } else if (!isSpace(c)) {
+                state = SCAN_ERROR;
+            }
+            break;
+
+        case SCAN_KEY:
+            if (escape) {
+                // Escaped keys never match one of ours
+                escape = false;
+                keyTruncated = true;
+            } else if (c == '\\') {
+                escape = true;
+            } else if (c == '"') {
+                key[keyLength] = '\0';
+                state = SCAN_COLON;
+            } else if (keyLength < METRICS_KEY_MAX - 1) {
+                key[keyLength++] = c;
+            } else {
+                keyTruncated = true;
+            }
+            break;
+
+        case SCAN_COLON:
+            if (c == ':') {
+                field = FIELD_NONE;
+                if (!keyTruncated) {
+                    if (strcmp(key, KEY_FOLLOWERS_COUNT) == 0) {
+                        field = FIELD_FOLLOWERS_COUNT;
+                    } else if (strcmp(key, KEY_USERNAME) == 0) {
+                        field = FIELD_USERNAME;
+                    } else if (strcmp(key, KEY_LAST_UPDATED) == 0) {
+                        field = FIELD_LAST_UPDATED;
+                    }
+                }
+                state = SCAN_VALUE;
+            } else if (!isSpace(c)) {
+                state = SCAN_ERROR;
+            }
+            break;
+
+        case SCAN_VALUE:
+            if (!isSpace(c)) {
+                beginValue(c);
+            }
+            break;
+
+        case SCAN_STRING_VALUE:
+            if (unicodeDigits > 0) {
+                // Non-ASCII characters cannot be shown on the panel anyway
+                unicodeDigits--;
+                if (unicodeDigits == 0) {
+                    appendString('?');
+                }
+            } else if (escape) {
+                escape = false;
+                switch (c) {
+                    case 'n': appendString('\n'); break;
+                    case 't': appendString('\t'); break;
+                    case 'r': appendString('\r'); break;
+                    case 'b': appendString('\b'); break;
+                    case 'f': appendString('\f'); break;
+                    case 'u': unicodeDigits = 4; break;
+                    default:  appendString(c); break;
+                }
+            } else if (c == '\\') {
+                escape = true;
+            } else if (c == '"') {
+                state = SCAN_COMMA_OR_END;
+            } else {
+                appendString(c);
+            }
+            break;
+
+        case SCAN_NUMBER_VALUE:
+            if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+                if (field == FIELD_FOLLOWERS_COUNT) {
+                    scanFollowersCount(c);
+                }
+            } else {
+                if (field == FIELD_FOLLOWERS_COUNT) {
+                    finishFollowersCount();
+                }
+                state = SCAN_COMMA_OR_END;
+                scanChar(c);
+            }
+            break;
+
+        case SCAN_LITERAL_VALUE:
+            if (c < 'a' || c > 'z') {
+                state = SCAN_COMMA_OR_END;
+                scanChar(c);
+            }
+            break;
+
+        case SCAN_NESTED_VALUE:
+            if (nestedInString) {
+                if (escape) {
+                    escape = false;
+                } else if (c == '\\') {
+                    escape = true;
+                } else if (c == '"') {
+                    nestedInString = false;
+                }
+            } else if (c == '"') {
+                nestedInString = true;
+            } else if (c == '{' || c == '[') {
+                nestedDepth++;
+            } else if (c == '}' || c == ']') {
+                nestedDepth--;
+                if (nestedDepth == 0) {
+                    state = SCAN_COMMA_OR_END;
+                }
+            }
+            break;
+
+        case SCAN_COMMA_OR_END:
+            if (c == ',') {
+                state = SCAN_KEY_START;
+            } else if (c == '}') {
+                state = SCAN_DONE;
+            } else if (!isSpace(c)) {
+                state = SCAN_ERROR;
+            }
+            break;
+
+        case SCAN_DONE:
+        case SCAN_ERROR:
+            break;
+    }
+}
+
+/**
+ * @brief Start reading the value of the current key
+ * @param c First character of the value
+ */
+void MetricsJsonScanner::beginValue(char c) {
+    if (c == '"') {
+        escape = false;
+        unicodeDigits = 0;
+        stringLength = 0;
+        stringTarget = nullptr;
+        stringCapacity = 0;
+
+        if (field == FIELD_USERNAME) {
+            stringTarget = username;
+            stringCapacity = sizeof(username);
+        } else if (field == FIELD_LAST_UPDATED) {
+            stringTarget = lastUpdated;
+            stringCapacity = sizeof(lastUpdated);
+        }
+
+        if (stringTarget != nullptr) {
+            stringTarget[0] = '\0';
+        }
+        state = SCAN_STRING_VALUE;
+    } else if ((c >= '0' && c <= '9') || c == '-') {
+        if (field == FIELD_FOLLOWERS_COUNT) {
+            if (c == '-') {
+                // A negative count is not a valid follower count
+                field = FIELD_NONE;
+            } else {
+                followersCount = (unsigned long)(c - '0');
+                followersFound = true;
+                numberPart = NUMBER_INTEGER;
+                fractionDigits = 0;
+                exponent = 0;
+                exponentNegative = false;
+            }
+        }
+        state = SCAN_NUMBER_VALUE;
+    } else if (c >= 'a' && c <= 'z') {
+        state = SCAN_LITERAL_VALUE;
+    } else if (c == '{' || c == '[') {
+        nestedDepth = 1;
+        nestedInString = false;
+        escape = false;
+        state = SCAN_NESTED_VALUE;
+    } else {
+        state = SCAN_ERROR;
+    }
+}
+
+/**
+ * @brief Add a character of the follower count number
+ *
+ * The digits before and after the decimal point are collected as one
+ * mantissa, finishFollowersCount() scales it by the exponent.
+ *
+ * @param c Digit, decimal point, exponent marker or exponent sign
+ */
+void MetricsJsonScanner::scanFollowersCount(char c) {
+    if (c == '.') {
+        numberPart = NUMBER_FRACTION;
+        return;
+    }
+    if (c == 'e' || c == 'E') {
+        numberPart = NUMBER_EXPONENT;
+        return;
+    }
+    if (c == '+' || c == '-') {
+        // beginValue() took a leading minus, any other sign belongs to the exponent
+        exponentNegative = c == '-';
+        return;
+    }
+
+    unsigned long digit = (unsigned long)(c - '0');
+    if (numberPart == NUMBER_EXPONENT) {
+        if (exponent < METRICS_EXPONENT_MAX) {
+            exponent = exponent * 10 + digit;
+        }
+        return;
+    }
+
+    if (followersCount > (ULONG_MAX - digit) / 10) {
+        // Fraction digits this far down cannot change the integer part
+        if (numberPart == NUMBER_INTEGER) {
+            dropFollowersCount();
+        }
+        return;
+    }
+    followersCount = followersCount * 10 + digit;
+    if (numberPart == NUMBER_FRACTION) {
+        fractionDigits++;
+    }
+}
+
+/**
+ * @brief Apply fraction and exponent once the follower count number ended
+ */
+void MetricsJsonScanner::finishFollowersCount() {
+    int scale = (exponentNegative ? -(int)exponent : (int)exponent) - fractionDigits;
+
+    // Like a conversion of the double to an integer, the fraction is cut off
+    for (; scale < 0 && followersCount > 0; scale++) {
+        followersCount /= 10;
+    }
+    for (; scale > 0 && followersCount > 0; scale--) {
+        if (followersCount > ULONG_MAX / 10) {
+            dropFollowersCount();
+            return;
+        }
+        followersCount *= 10;
+    }
+}
+
+/**
+ * @brief Forget a follower count that does not fit an unsigned long
+ */
+void MetricsJsonScanner::dropFollowersCount() {
+    followersFound = false;
+    followersCount = 0;
+    field = FIELD_NONE;
+}
+
+/**
+ * @brief Append a character to the current string value
+ * @param c Character to append
+ */
+void MetricsJsonScanner::appendString(char c) {
+    if (stringTarget == nullptr) {
+        return;
+    }
+
+    // Truncate silently, keeping room for the terminating null
+    if (stringLength < stringCapacity - 1) {
+        stringTarget[stringLength++] = c;
+        stringTarget[stringLength] = '\0';
+    }
+}
+
+/**
+ * @brief Check if a character is JSON whitespace
+ * @param c Character to check
+ * @return True for space, tab, CR and LF
+ */
+bool MetricsJsonScanner::isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
@@ -0,0 +1,171 @@
+#ifndef METRICS_JSON_SCANNER_H
+#define METRICS_JSON_SCANNER_H
+
+#include <Arduino.h>
+
+// Field buffer sizes (including the terminating null)
+#define METRICS_USERNAME_MAX 32
+#define METRICS_TIMESTAMP_MAX 32
+#define METRICS_KEY_MAX 16
+#define METRICS_EXPONENT_MAX 100    // Larger exponents are clamped, any count overflows or truncates to 0
+
+/**
+ * @brief Streaming extractor for the fields of the metrics JSON response
+ *
+ * Bytes can be fed in arbitrary chunks as they arrive from the network.
+ * Only followers_count, username and last_updated of the top-level object
+ * are kept, everything else is skipped. No heap is used.
+ */
+class MetricsJsonScanner {
+public:
+    /**
+     * @brief Constructor
+     */
+    MetricsJsonScanner();
+
+    /**
+     * @brief Forget all data and start scanning a new document
+     */
+    void reset();
+
+    /**
+     * @brief Scan the next part of the document
+     * @param data Received bytes
+     * @param length Number of bytes
+     */
+    void feed(const char* data, size_t length);
+
+    /**
+     * @brief Check if the top-level object has been read completely
+     * @return True if the closing brace was seen without syntax errors
+     */
+    bool isComplete() const;
+
+    /**
+     * @brief Check if the document is not valid JSON
+     * @return True if a syntax error was found
+     */
+    bool hasError() const;
+
+    /**
+     * @brief Check if followers_count was present
+     * @return True if a followers_count number was found
+     */
+    bool hasFollowersCount() const;
+
+    /**
+     * @brief Get the extracted follower count
+     * @return Follower count, 0 if not present
+     */
+    unsigned long getFollowersCount() const;
+
+    /**
+     * @brief Get the extracted user name
+     * @return User name, empty if not present
+     */
+    const char* getUsername() const;
+
+    /**
+     * @brief Get the extracted last update timestamp
+     * @return Timestamp string, empty if not present
+     */
+    const char* getLastUpdated() const;
+
+private:
+    // Position inside the top-level object
+    enum ScanState {
+        SCAN_START,           // Before the opening brace
+        SCAN_KEY_OR_END,      // Expecting a key or the closing brace
+        SCAN_KEY_START,       // Expecting a key after a comma
+        SCAN_KEY,             // Inside a key string
+        SCAN_COLON,           // Expecting the colon after a key
+        SCAN_VALUE,           // Expecting a value
+        SCAN_STRING_VALUE,    // Inside a string value
+        SCAN_NUMBER_VALUE,    // Inside a number value
+        SCAN_LITERAL_VALUE,   // Inside true, false or null
+        SCAN_NESTED_VALUE,    // Inside a nested object or array
+        SCAN_COMMA_OR_END,    // Expecting a comma or the closing brace
+        SCAN_DONE,            // Top-level object closed
+        SCAN_ERROR            // Syntax error
+    };
+
+    // Fields we extract
+    enum ScanField {
+        FIELD_NONE,
+        FIELD_FOLLOWERS_COUNT,
+        FIELD_USERNAME,
+        FIELD_LAST_UPDATED
+    };
+
+    // Part of the follower count number being read
+    enum NumberPart {
+        NUMBER_INTEGER,       // Digits before the decimal point
+        NUMBER_FRACTION,      // Digits after the decimal point
+        NUMBER_EXPONENT       // Digits after e or E
+    };
+
+    ScanState state;                          // Current scanner state
+    ScanField field;                          // Field the current value belongs to
+    char key[METRICS_KEY_MAX];                // Current key
+    uint8_t keyLength;                        // Characters in key
+    bool keyTruncated;                        // Key did not fit, so it matches nothing
+    bool escape;                              // Previous character was a backslash
+    uint8_t unicodeDigits;                    // Hex digits left of a \u escape
+    bool nestedInString;                      // Nested value is inside a string
+    uint8_t nestedDepth;                      // Nesting level of the skipped value
+    char* stringTarget;                       // Buffer for the current string value
+    size_t stringCapacity;                    // Size of stringTarget
+    size_t stringLength;                      // Characters written to stringTarget
+
+    bool followersFound;                      // followers_count was present
+    unsigned long followersCount;             // Extracted follower count, digits of the mantissa while reading
+    NumberPart numberPart;                    // Part of the follower count being read
+    uint8_t fractionDigits;                   // Fraction digits in followersCount
+    uint16_t exponent;                        // Exponent of the follower count
+    bool exponentNegative;                    // Exponent has a minus sign
+    char username[METRICS_USERNAME_MAX];      // Extracted user name
+    char lastUpdated[METRICS_TIMESTAMP_MAX];  // Extracted timestamp
+
+    /**
+     * @brief Process one character
+     * @param c Character to process
+     */
+    void scanChar(char c);
+
+    /**
+     * @brief Start reading the value of the current key
+     * @param c First character of the value
+     */
+    void beginValue(char c);
+
+    /**
+     * @brief Add a character of the follower count number
+     * @param c Digit, decimal point, exponent marker or exponent sign
+     */
+    void scanFollowersCount(char c);
+
+    /**
+     * @brief Apply fraction and exponent once the follower count number ended
+     */
+    void finishFollowersCount();
+
+    /**
+     * @brief Forget a follower count that does not fit an unsigned long
+     */
+    void dropFollowersCount();
+
+    /**
+     * @brief Append a character to the current string value
+     * @param c Character to append
+     */
+    void appendString(char c);
+
+    /**
+     * @brief Check if a character is JSON whitespace
+     * @param c Character to check
+     * @return True for space, tab, CR and LF
+     */
+    static bool isSpace(char c);
+};
+
+#endif // METRICS_JSON_SCANNER_H
\ No newline at end of file
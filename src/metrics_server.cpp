@@ -0,0 +1,212 @@
+#include "metrics_server.h"
+#include "main.h"
+#include "counter.h"
+#include "profiler.h"
+#include "template_writer.h"
+#include "clock.h"
+#include <WebServer.h>
+#include <WiFi.h>
+
+#define LOG_TAG "metrics"
+#include "logger.h"
+
+// Prometheus endpoint, separate from the captive portal server
+static WebServer metricsServer(METRICS_PORT);
+static bool metricsServerStarted = false;
+
+/**
+ * @brief Write the HELP and TYPE lines of a metric
+ * @param writer Writer of the response
+ * @param name Metric name without prefix
+ * @param type Prometheus metric type
+ * @param help Description of the metric
+ */
+static void writeHeader(TemplateWriter& writer, const char* name, const char* type, const char* help) {
+    char line[160];
+    snprintf(line, sizeof(line), "# HELP " METRICS_PREFIX "%s %s\n# TYPE " METRICS_PREFIX "%s %s\n",
+             name, help, name, type);
+    writer.write(line);
+}
+
+/**
+ * @brief Write one sample with an integer value
+ * @param writer Writer of the response
+ * @param name Metric name without prefix
+ * @param labels Label set including braces, empty for none
+ * @param value Sample value
+ */
+static void writeSample(TemplateWriter& writer, const char* name, const char* labels, long value) {
+    char line[128];
+    snprintf(line, sizeof(line), METRICS_PREFIX "%s%s %ld\n", name, labels, value);
+    writer.write(line);
+}
+
+/**
+ * @brief Write one sample with a duration value in seconds
+ * @param writer Writer of the response
+ * @param name Metric name without prefix
+ * @param labels Label set including braces, empty for none
+ * @param micros Duration in microseconds
+ */
+static void writeSeconds(TemplateWriter& writer, const char* name, const char* labels, uint32_t micros) {
+    char line[128];
+    snprintf(line, sizeof(line), METRICS_PREFIX "%s%s %lu.%06lu\n", name, labels,
+             (unsigned long)(micros / 1000000), (unsigned long)(micros % 1000000));
+    writer.write(line);
+}
+
+/**
+ * @brief Convert a histogram value to microseconds
+ * @param value Histogram value
+ * @param cycles True if the histogram holds CPU cycles, false for microseconds
+ * @return Duration in microseconds
+ */
+static uint32_t toMicros(uint32_t value, bool cycles) {
+    return cycles ? FrameProfiler::toMicroseconds(value) : value;
+}
+
+/**
+ * @brief Write p50, p99 and count of a histogram as samples of a summary
+ * @param writer Writer of the response
+ * @param name Summary name without prefix
+ * @param labels Label pair identifying the histogram, without braces
+ * @param histogram Histogram to write
+ * @param cycles True if the histogram holds CPU cycles, false for microseconds
+ */
+static void writeSummary(TemplateWriter& writer, const char* name, const char* labels,
+                         const StageHistogram& histogram, bool cycles) {
+    static const uint8_t quantiles[] = {50, 99};
+    char sampleLabels[64];
+    char countName[48];
+
+    for (uint8_t percent : quantiles) {
+        snprintf(sampleLabels, sizeof(sampleLabels), "{%s,quantile=\"0.%02u\"}", labels, percent);
+        writeSeconds(writer, name, sampleLabels, toMicros(histogram.percentile(percent), cycles));
+    }
+
+    snprintf(sampleLabels, sizeof(sampleLabels), "{%s}", labels);
+    snprintf(countName, sizeof(countName), "%s_count", name);
+    writeSample(writer, countName, sampleLabels, histogram.getCount());
+}
+
+/**
+ * @brief Write summaries and maximums of a group of histograms
+ * @param writer Writer of the response
+ * @param name Summary name without prefix, the maximums get a _max_seconds gauge
+ * @param help Description of the summary
+ * @param label Label name telling the histograms apart
+ * @param names Label value of each histogram
+ * @param histograms Histograms to write
+ * @param count Number of histograms
+ * @param cycles True if the histograms hold CPU cycles, false for microseconds
+ */
+static void writeHistograms(TemplateWriter& writer, const char* name, const char* help, const char* label,
+                            const char* const* names, const StageHistogram* const* histograms,
+                            size_t count, bool cycles) {
+    char labels[48];
+    char metric[48];
+
+    snprintf(metric, sizeof(metric), "%s_seconds", name);
+    writeHeader(writer, metric, "summary", help);
+    for (size_t i = 0; i < count; i++) {
+        snprintf(labels, sizeof(labels), "%s=\"%s\"", label, names[i]);
+        writeSummary(writer, metric, labels, *histograms[i], cycles);
+    }
+
+    snprintf(metric, sizeof(metric), "%s_max_seconds", name);
+    writeHeader(writer, metric, "gauge", "Longest sample since boot");
+    for (size_t i = 0; i < count; i++) {
+        snprintf(labels, sizeof(labels), "{%s=\"%s\"}", label, names[i]);
+        writeSeconds(writer, metric, labels, toMicros(histograms[i]->getMax(), cycles));
+    }
+}
+
+/**
+ * @brief Handle a scrape, writes all metrics in the Prometheus text format
+ */
+static void handleMetrics() {
+    TemplateWriter writer(metricsServer);
+    writer.begin(200, "text/plain; version=0.0.4");
+
+    // Frame and network stages from the profiler
+    const char* stageNames[PROFILE_STAGE_COUNT];
+    const StageHistogram* stages[PROFILE_STAGE_COUNT];
+    for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        ProfileStage stage = static_cast<ProfileStage>(i);
+        stageNames[i] = FrameProfiler::nameOf(stage);
+        stages[i] = &profiler.get(stage);
+    }
+    writeHistograms(writer, "stage", "Time spent per frame and network task stage", "stage",
+                    stageNames, stages, PROFILE_STAGE_COUNT, true);
+
+    // Counter updates
+    const FetchStats& fetch = getFetchStats();
+    static const char* const phaseNames[] = {"dns", "connect", "ttfb", "parse"};
+    const StageHistogram* phases[] = {&fetch.resolve, &fetch.connect, &fetch.firstByte, &fetch.parse};
+    writeHistograms(writer, "fetch_phase", "Latency per phase of the counter requests", "phase",
+                    phaseNames, phases, sizeof(phases) / sizeof(phases[0]), false);
+    writeHeader(writer, "fetch_requests_total", "counter", "Counter updates by outcome");
+    writeSample(writer, "fetch_requests_total", "{result=\"success\"}", fetch.successCount);
+    writeSample(writer, "fetch_requests_total", "{result=\"failure\"}", fetch.failureCount);
+    writeHeader(writer, "last_request_successful", "gauge", "Whether the last counter update succeeded");
+    writeSample(writer, "last_request_successful", "", isLastRequestSuccessful() ? 1 : 0);
+    writeHeader(writer, "followers", "gauge", "Displayed follower count");
+    writeSample(writer, "followers", "", getCounterValue());
+
+    // Keep-alive of the API connection
+    uint32_t reuses;
+    uint32_t reconnects;
+    getApiConnectionStats(reuses, reconnects);
+    writeHeader(writer, "http_connections_total", "counter",
+                "API requests on a kept-alive connection and kept-alive connections reopened");
+    writeSample(writer, "http_connections_total", "{kind=\"reuse\"}", reuses);
+    writeSample(writer, "http_connections_total", "{kind=\"reconnect\"}", reconnects);
+
+    // WiFi
+    writeHeader(writer, "wifi_rssi_dbm", "gauge", "Signal strength of the access point");
+    writeSample(writer, "wifi_rssi_dbm", "", WiFi.RSSI());
+    writeHeader(writer, "wifi_reconnects_total", "counter", "Reconnects after a lost WiFi connection");
+    writeSample(writer, "wifi_reconnects_total", "", getWiFiStats().reconnectCount);
+
+    // Memory
+    writeHeader(writer, "heap_free_bytes", "gauge", "Free heap");
+    writeSample(writer, "heap_free_bytes", "", ESP.getFreeHeap());
+    writeHeader(writer, "heap_min_free_bytes", "gauge", "Lowest free heap since boot");
+    writeSample(writer, "heap_min_free_bytes", "", ESP.getMinFreeHeap());
+    writeHeader(writer, "heap_largest_free_block_bytes", "gauge", "Largest allocatable heap block");
+    writeSample(writer, "heap_largest_free_block_bytes", "", ESP.getMaxAllocHeap());
+
+    // Display
+    AnimationStyle style = animationManager.getCurrentStyle();
+    char labels[48];
+    snprintf(labels, sizeof(labels), "{style=\"%s\"}", AnimationManager::getStyleName(style));
+    writeHeader(writer, "animation_style", "gauge", "Index of the current animation style");
+    writeSample(writer, "animation_style", labels, style);
+
+    // Logging
+    writeHeader(writer, "log_dropped_lines_total", "counter", "Log lines lost because the queue was full");
+    writeSample(writer, "log_dropped_lines_total", "", getDroppedLogLines());
+
+    writeHeader(writer, "uptime_seconds", "counter", "Time since boot");
+    writeSample(writer, "uptime_seconds", "", (long)(clockMicros() / 1000000));
+
+    writer.end();
+}
+
+/**
+ * @brief Serve pending metrics requests, starts the server on first use
+ *
+ * Runs in the network task on the other core than the render task, so a
+ * scrape never delays a frame. The response is streamed in chunks from
+ * fixed buffers and reads the statistics without locking.
+ */
+void handleMetricsServer() {
+    if (!metricsServerStarted) {
+        metricsServer.on(METRICS_PATH, HTTP_GET, handleMetrics);
+        metricsServer.begin();
+        metricsServerStarted = true;
+        LOG_INFO("Metrics served on port %d%s", METRICS_PORT, METRICS_PATH);
+    }
+
+    metricsServer.handleClient();
+}
@@ -0,0 +1,20 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <Arduino.h>
+
+// Metrics endpoint configuration
+#define METRICS_PORT 9100                 // Port of the Prometheus endpoint in station mode
+#define METRICS_PATH "/metrics"           // Path scraped by Prometheus
+#define METRICS_PREFIX "insta_counter_"   // Prefix of all metric names
+
+/**
+ * @brief Serve pending metrics requests, starts the server on first use
+ *
+ * Runs in the network task on the other core than the render task, so a
+ * scrape never delays a frame. The response is streamed in chunks from
+ * fixed buffers and reads the statistics without locking.
+ */
+void handleMetricsServer();
+
+#endif // METRICS_SERVER_H
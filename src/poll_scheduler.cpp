@@ -0,0 +1,180 @@
+#include "poll_scheduler.h"
+
+/**
+ * @brief Constructor
+ */
+PollScheduler::PollScheduler() :
+    scheduledAt(0),
+    delay(0),
+    failures(0),
+    haveLastUpdated(false),
+    lastUpdatedSeconds(0),
+    changeSeenAt(0),
+    refreshPeriod(0) {
+}
+
+/**
+ * @brief Make the next poll due immediately
+ * @param now Current time in milliseconds
+ */
+void PollScheduler::reset(uint32_t now) {
+    scheduledAt = now;
+    delay = 0;
+    failures = 0;
+}
+
+/**
+ * @brief Check if the next poll is due
+ * @param now Current time in milliseconds
+ * @return True if it is time to poll
+ */
+bool PollScheduler::isDue(uint32_t now) const {
+    return now - scheduledAt >= delay;
+}
+
+/**
+ * @brief Schedule the next poll after a successful one
+ * @param now Current time in milliseconds
+ * @param maxAgeSeconds Cache-Control max-age, -1 if not sent
+ * @param lastUpdated last_updated field ("YYYY-MM-DD HH:MM:SS"), nullptr if unknown
+ */
+void PollScheduler::onSuccess(uint32_t now, long maxAgeSeconds, const char* lastUpdated) {
+    failures = 0;
+    learnRefreshPeriod(now, lastUpdated);
+
+    unsigned long delayMs;
+    if (maxAgeSeconds >= 0) {
+        // The server knows best when its data expires
+        if ((unsigned long)maxAgeSeconds > POLL_MAX_INTERVAL / 1000) {
+            delayMs = POLL_MAX_INTERVAL;
+        } else {
+            delayMs = (unsigned long)maxAgeSeconds * 1000 + POLL_REFRESH_MARGIN;
+        }
+    } else if (refreshPeriod > 0) {
+        // Expect the next change one learned period after the last one
+        unsigned long periodMs = min<unsigned long>(refreshPeriod, POLL_MAX_INTERVAL / 1000) * 1000;
+        uint32_t elapsed = now - changeSeenAt;
+        if (elapsed < periodMs) {
+            delayMs = periodMs - elapsed + POLL_REFRESH_MARGIN;
+        } else {
+            delayMs = POLL_DEFAULT_INTERVAL;  // Overdue, the period may have grown
+        }
+    } else {
+        delayMs = POLL_DEFAULT_INTERVAL;
+    }
+
+    delayMs = constrain(delayMs, (unsigned long)POLL_MIN_INTERVAL, (unsigned long)POLL_MAX_INTERVAL);
+
+    // Only ever add jitter, polling before the data can change is wasted
+    unsigned long jitter = min<unsigned long>(delayMs / 100 * POLL_JITTER_PERCENT, POLL_JITTER_MAX);
+    schedule(now, delayMs + random(jitter + 1));
+}
+
+/**
+ * @brief Schedule the next poll after a failed one
+ * @param now Current time in milliseconds
+ * @param retryAfterSeconds Retry-After sent by the server, -1 if not sent
+ */
+void PollScheduler::onFailure(uint32_t now, long retryAfterSeconds) {
+    if (failures < UINT8_MAX) {
+        failures++;
+    }
+
+    // Exponential backoff with "equal jitter": half fixed, half random
+    unsigned long backoff = POLL_BACKOFF_MAX;
+    if (failures <= 16) {
+        backoff = min<unsigned long>((unsigned long)POLL_BACKOFF_BASE << (failures - 1), POLL_BACKOFF_MAX);
+    }
+    unsigned long delayMs = backoff / 2 + random(backoff / 2 + 1);
+
+    // Never retry earlier than the server asked for
+    if (retryAfterSeconds >= 0) {
+        unsigned long retryAfterMs = (unsigned long)POLL_MAX_INTERVAL;
+        if ((unsigned long)retryAfterSeconds < POLL_MAX_INTERVAL / 1000) {
+            retryAfterMs = (unsigned long)retryAfterSeconds * 1000;
+        }
+        delayMs = max(delayMs, retryAfterMs);
+    }
+
+    schedule(now, max<unsigned long>(delayMs, POLL_MIN_INTERVAL));
+}
+
+/**
+ * @brief Get the delay until the next poll
+ * @param now Current time in milliseconds
+ * @return Milliseconds until the next poll, 0 if already due
+ */
+unsigned long PollScheduler::getTimeUntilDue(uint32_t now) const {
+    uint32_t elapsed = now - scheduledAt;
+    return elapsed >= delay ? 0 : delay - elapsed;
+}
+
+/**
+ * @brief Get the number of failed polls in a row
+ * @return Consecutive failure count
+ */
+uint8_t PollScheduler::getFailureCount() const {
+    return failures;
+}
+
+/**
+ * @brief Track changes of the last_updated field
+ * @param now Current time in milliseconds
+ * @param lastUpdated last_updated field, nullptr if unknown
+ */
+void PollScheduler::learnRefreshPeriod(uint32_t now, const char* lastUpdated) {
+    uint32_t seconds;
+    if (lastUpdated == nullptr || !parseTimestamp(lastUpdated, seconds)) {
+        return;
+    }
+    if (haveLastUpdated && seconds == lastUpdatedSeconds) {
+        return;
+    }
+
+    // The distance between two refreshes is the period we expect next
+    if (haveLastUpdated && seconds > lastUpdatedSeconds) {
+        refreshPeriod = seconds - lastUpdatedSeconds;
+    }
+
+    lastUpdatedSeconds = seconds;
+    changeSeenAt = now;
+    haveLastUpdated = true;
+}
+
+/**
+ * @brief Start a new delay
+ * @param now Current time in milliseconds
+ * @param delayMs Delay until the next poll
+ */
+void PollScheduler::schedule(uint32_t now, unsigned long delayMs) {
+    scheduledAt = now;
+    delay = delayMs;
+}
+
+/**
+ * @brief Parse a "YYYY-MM-DD HH:MM:SS" timestamp
+ * @param text Timestamp to parse
+ * @param seconds Seconds since 2000-01-01 00:00:00
+ * @return True if the timestamp is valid
+ */
+bool PollScheduler::parseTimestamp(const char* text, uint32_t& seconds) {
+    unsigned int year, month, day, hour, minute, second;
+    if (sscanf(text, "%4u-%2u-%2u %2u:%2u:%2u", &year, &month, &day, &hour, &minute, &second) != 6) {
+        return false;
+    }
+    if (year < 2000 || year > 2099 || month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour > 23 || minute > 59 || second > 59) {
+        return false;
+    }
+
+    // Days since 2000-01-01, every fourth year is a leap year until 2100
+    static const uint16_t daysBeforeMonth[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+    uint32_t years = year - 2000;
+    uint32_t days = years * 365 + (years + 3) / 4 + daysBeforeMonth[month - 1] + (day - 1);
+    if (month > 2 && years % 4 == 0) {
+        days++;
+    }
+
+    seconds = ((days * 24 + hour) * 60 + minute) * 60 + second;
+    return true;
+}
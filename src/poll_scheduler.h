@@ -0,0 +1,106 @@
+#ifndef POLL_SCHEDULER_H
+#define POLL_SCHEDULER_H
+
+#include <Arduino.h>
+
+// Scheduling limits in milliseconds
+#define POLL_MIN_INTERVAL 10000          // Never poll more often than this
+#define POLL_MAX_INTERVAL 900000         // Poll at least every 15 minutes
+#define POLL_DEFAULT_INTERVAL 60000      // Interval when the server gives no hint
+#define POLL_REFRESH_MARGIN 2000         // Delay after the expected server refresh
+#define POLL_JITTER_PERCENT 10           // Random extra delay spreading the fleet
+#define POLL_JITTER_MAX 30000            // Upper limit of the random extra delay
+#define POLL_BACKOFF_BASE 20000          // Retry delay after the first failure
+#define POLL_BACKOFF_MAX 600000          // Upper limit of the retry delay
+
+/**
+ * @brief Decides when the next API poll is due
+ *
+ * After a successful poll the next one is timed for when the data can
+ * change: the server's Cache-Control max-age if sent, otherwise the
+ * refresh period learned from the last_updated field, otherwise a default.
+ * After failures the delay grows exponentially with random jitter, or
+ * follows the server's Retry-After.
+ */
+class PollScheduler {
+public:
+    /**
+     * @brief Constructor
+     */
+    PollScheduler();
+
+    /**
+     * @brief Make the next poll due immediately
+     * @param now Current time in milliseconds
+     */
+    void reset(uint32_t now);
+
+    /**
+     * @brief Check if the next poll is due
+     * @param now Current time in milliseconds
+     * @return True if it is time to poll
+     */
+    bool isDue(uint32_t now) const;
+
+    /**
+     * @brief Schedule the next poll after a successful one
+     * @param now Current time in milliseconds
+     * @param maxAgeSeconds Cache-Control max-age, -1 if not sent
+     * @param lastUpdated last_updated field ("YYYY-MM-DD HH:MM:SS"), nullptr if unknown
+     */
+    void onSuccess(uint32_t now, long maxAgeSeconds, const char* lastUpdated);
+
+    /**
+     * @brief Schedule the next poll after a failed one
+     * @param now Current time in milliseconds
+     * @param retryAfterSeconds Retry-After sent by the server, -1 if not sent
+     */
+    void onFailure(uint32_t now, long retryAfterSeconds);
+
+    /**
+     * @brief Get the delay until the next poll
+     * @param now Current time in milliseconds
+     * @return Milliseconds until the next poll, 0 if already due
+     */
+    unsigned long getTimeUntilDue(uint32_t now) const;
+
+    /**
+     * @brief Get the number of failed polls in a row
+     * @return Consecutive failure count
+     */
+    uint8_t getFailureCount() const;
+
+private:
+    uint32_t scheduledAt;           // Time the current delay started
+    unsigned long delay;            // Delay until the next poll
+    uint8_t failures;               // Consecutive failures
+
+    bool haveLastUpdated;           // lastUpdatedSeconds is valid
+    uint32_t lastUpdatedSeconds;    // Last seen last_updated value
+    uint32_t changeSeenAt;          // Time lastUpdatedSeconds was first seen
+    uint32_t refreshPeriod;         // Learned server refresh period in seconds, 0 if unknown
+
+    /**
+     * @brief Track changes of the last_updated field
+     * @param now Current time in milliseconds
+     * @param lastUpdated last_updated field, nullptr if unknown
+     */
+    void learnRefreshPeriod(uint32_t now, const char* lastUpdated);
+
+    /**
+     * @brief Start a new delay
+     * @param now Current time in milliseconds
+     * @param delayMs Delay until the next poll
+     */
+    void schedule(uint32_t now, unsigned long delayMs);
+
+    /**
+     * @brief Parse a "YYYY-MM-DD HH:MM:SS" timestamp
+     * @param text Timestamp to parse
+     * @param seconds Seconds since 2000-01-01 00:00:00
+     * @return True if the timestamp is valid
+     */
+    static bool parseTimestamp(const char* text, uint32_t& seconds);
+};
+
+#endif // POLL_SCHEDULER_H
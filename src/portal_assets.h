@@ -0,0 +1,126 @@
+// This file is automatically generated by scripts/portal_assets.py from portal/, do not edit.
+#ifndef PORTAL_ASSETS_H
+#define PORTAL_ASSETS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// failed.html, 358 bytes gzip-compressed to 263 bytes
+const char portal_failed_html_type[] = "text/html";
+const size_t portal_failed_html_gz_len = 263;
+const uint8_t portal_failed_html_gz[263] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x5d, 0x90, 0xbb, 0x6e, 0xc3, 0x30,
+    0x0c, 0x45, 0x77, 0x7f, 0x05, 0x3b, 0x69, 0x69, 0x62, 0x64, 0x97, 0xbc, 0xa4, 0xe9, 0xda, 0x00,
+    0x0d, 0x50, 0x74, 0x64, 0x2c, 0x3a, 0x26, 0x2a, 0x4b, 0x06, 0x45, 0xdb, 0xf0, 0xdf, 0x57, 0x76,
+    0x3a, 0x75, 0x21, 0xc1, 0xd7, 0xe5, 0x21, 0xed, 0xcb, 0xdb, 0xc7, 0xf9, 0xf6, 0x7d, 0xbd, 0x40,
+    0xaf, 0x43, 0x68, 0xec, 0x9f, 0x25, 0xf4, 0x4d, 0x65, 0x95, 0x35, 0x50, 0xf3, 0xc5, 0xef, 0x0c,
+    0xe7, 0x14, 0x3b, 0x7e, 0x4c, 0x82, 0xca, 0x29, 0xda, 0xfa, 0x59, 0xa9, 0xec, 0x40, 0x8a, 0x10,
+    0x71, 0x20, 0x67, 0x66, 0xa6, 0x65, 0x4c, 0xa2, 0x06, 0xda, 0x14, 0x95, 0xa2, 0x3a, 0xb3, 0xb0,
+    0xd7, 0xde, 0x79, 0x9a, 0xb9, 0xa5, 0xc3, 0x1e, 0xbc, 0x02, 0x47, 0x56, 0xc6, 0x70, 0xc8, 0x2d,
+    0x06, 0x72, 0x27, 0x53, 0x44, 0x02, 0xc7, 0x1f, 0x10, 0x0a, 0xce, 0x64, 0x5d, 0x03, 0xe5, 0x9e,
+    0xa8, 0xa8, 0xf4, 0x42, 0x9d, 0x33, 0xf5, 0x9e, 0x3a, 0xb6, 0x39, 0x6f, 0x9d, 0xf5, 0x0e, 0x66,
+    0xef, 0xc9, 0xaf, 0x25, 0xf2, 0x3c, 0x43, 0x1b, 0x30, 0x67, 0x67, 0xb6, 0x95, 0xc8, 0x91, 0xa4,
+    0xe8, 0xe4, 0x29, 0x28, 0x74, 0xc8, 0x81, 0xfc, 0x36, 0xd3, 0x9f, 0x9a, 0x8b, 0x48, 0x12, 0xf8,
+    0xc4, 0x99, 0xe3, 0xe3, 0xff, 0x25, 0xa5, 0x5c, 0xd9, 0xb1, 0xb9, 0xf5, 0x24, 0x04, 0x0b, 0x66,
+    0x40, 0x18, 0x25, 0xdd, 0x03, 0x0d, 0x90, 0x9f, 0x03, 0x6b, 0x9a, 0x04, 0xf6, 0x27, 0xb4, 0x42,
+    0xbe, 0x1c, 0x56, 0xf0, 0xf3, 0x11, 0xae, 0x81, 0x30, 0x13, 0xa8, 0xac, 0x80, 0x8f, 0xb2, 0xfb,
+    0x68, 0xeb, 0x71, 0x43, 0x2c, 0x54, 0x9b, 0xdb, 0x19, 0x8b, 0xfc, 0xf6, 0xcf, 0xea, 0x17, 0x93,
+    0x18, 0x42, 0x96, 0x66, 0x01, 0x00, 0x00
+};
+
+// index.html, template with {{name}} placeholders
+const char portal_index_html[] =
+    "<!DOCTYPE html><html><head>\n"
+    "<title>ESP WiFi Setup</title>\n"
+    "<meta name='viewport' content='width=device-width, initial-scale=1'>\n"
+    "<link rel='stylesheet' href='/style.css'>\n"
+    "</head><body>\n"
+    "<div class='container'>\n"
+    "<h1>Instagram Counter WiFi Setup</h1>\n"
+    "<form method='post' action='/save'>\n"
+    "<div class='form-group'>\n"
+    "<label>Networks in range:</label>\n"
+    "<div class='networks'>{{networks}}</div>\n"
+    "</div>\n"
+    "<div class='form-group'>\n"
+    "<label for='ssid'>WiFi Network Name (SSID):</label>\n"
+    "<input type='text' id='ssid' name='ssid' value='{{ssid}}' required>\n"
+    "</div>\n"
+    "<div class='form-group'>\n"
+    "<label for='password'>WiFi Password:</label>\n"
+    "<input type='password' id='password' name='password' value='{{password}}'>\n"
+    "</div>\n"
+    "<button type='submit'>Save Configuration</button>\n"
+    "</form>\n"
+    "<div class='footer'>After saving, the device will attempt to connect to your WiFi network.</div>\n"
+    "</div>\n"
+    "<script>function pick(s){document.getElementById('ssid').value=s;document.getElementById('password').focus();}</script>\n"
+    "</body></html>\n";
+
+// saved.html, 373 bytes gzip-compressed to 267 bytes
+const char portal_saved_html_type[] = "text/html";
+const size_t portal_saved_html_gz_len = 267;
+const uint8_t portal_saved_html_gz[267] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x55, 0x90, 0x31, 0x6f, 0xc3, 0x20,
+    0x10, 0x85, 0x77, 0xff, 0x8a, 0xcb, 0xc4, 0xd2, 0xd8, 0xf2, 0x0e, 0x5e, 0xd2, 0x66, 0x6d, 0xa5,
+    0x46, 0xaa, 0x3a, 0x12, 0xb8, 0x94, 0x53, 0x30, 0x58, 0x70, 0xb6, 0xe5, 0x7f, 0x5f, 0xb0, 0xbb,
+    0x74, 0x01, 0x8e, 0xc7, 0xbd, 0xfb, 0x1e, 0xf2, 0xf4, 0xfa, 0x7e, 0xb9, 0x7d, 0x7f, 0xbc, 0x81,
+    0xe3, 0xd1, 0x0f, 0xf2, 0x6f, 0x45, 0x6d, 0x87, 0x46, 0x32, 0xb1, 0xc7, 0xe1, 0x8b, 0xae, 0x04,
+    0x97, 0x18, 0x1e, 0xf4, 0x33, 0x27, 0xcd, 0x14, 0x83, 0xec, 0x0e, 0xa5, 0x91, 0x23, 0xb2, 0x86,
+    0xa0, 0x47, 0x54, 0x62, 0x21, 0x5c, 0xa7, 0x98, 0x58, 0x80, 0x89, 0x81, 0x31, 0xb0, 0x12, 0x2b,
+    0x59, 0x76, 0xca, 0xe2, 0x42, 0x06, 0xcf, 0x7b, 0xf1, 0x02, 0x14, 0x88, 0x49, 0xfb, 0x73, 0x36,
+    0xda, 0xa3, 0xea, 0x45, 0x31, 0xf1, 0x14, 0x9e, 0x90, 0xd0, 0x2b, 0x91, 0x79, 0xf3, 0x98, 0x1d,
+    0x62, 0x71, 0x71, 0x09, 0x1f, 0x4a, 0x74, 0xfb, 0x55, 0x6b, 0x72, 0xae, 0x2f, 0xbb, 0x1d, 0x4c,
+    0xde, 0xa3, 0xdd, 0x4a, 0x65, 0x69, 0x01, 0xe3, 0x75, 0xce, 0x4a, 0xd4, 0x91, 0x9a, 0x02, 0xa6,
+    0xe2, 0x93, 0x67, 0xcf, 0x90, 0xf5, 0x82, 0xb6, 0xb6, 0xb8, 0x7e, 0xf8, 0xc7, 0x0e, 0x9f, 0x55,
+    0x39, 0x15, 0xab, 0xbe, 0xa8, 0xd3, 0x91, 0xce, 0x24, 0xb4, 0x85, 0xb8, 0x70, 0x65, 0x70, 0x45,
+    0x87, 0x3b, 0x62, 0x38, 0x3c, 0x5a, 0xb8, 0x39, 0x84, 0x23, 0x03, 0xac, 0xe4, 0x3d, 0x84, 0xb8,
+    0x82, 0x66, 0xc6, 0x71, 0x62, 0xe0, 0x58, 0xd3, 0x06, 0x34, 0xfb, 0x71, 0x8b, 0x73, 0x82, 0x80,
+    0xbc, 0xc6, 0xf4, 0x6c, 0x65, 0x37, 0x55, 0xe2, 0x02, 0x59, 0xb7, 0x1d, 0xb9, 0x0c, 0xad, 0xdf,
+    0xdb, 0xfc, 0x02, 0xbb, 0xc4, 0x28, 0xfe, 0x75, 0x01, 0x00, 0x00
+};
+
+// style.css, 1279 bytes gzip-compressed to 580 bytes
+const char portal_style_css_type[] = "text/css";
+const size_t portal_style_css_gz_len = 580;
+const uint8_t portal_style_css_gz[580] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8d, 0x94, 0xdd, 0x8e, 0x9b, 0x30,
+    0x10, 0x85, 0xef, 0xf7, 0x29, 0x90, 0xa2, 0x4a, 0xad, 0xb4, 0x8e, 0x20, 0x3f, 0x74, 0x65, 0xd4,
+    0x8b, 0x55, 0xa5, 0xbe, 0x44, 0xb5, 0x17, 0x03, 0x36, 0x60, 0xc5, 0xd8, 0x96, 0x6d, 0x16, 0x52,
+    0x6b, 0xdf, 0xbd, 0xb6, 0x21, 0x21, 0x24, 0xad, 0x5a, 0x71, 0xe7, 0x9f, 0x99, 0xef, 0xcc, 0x39,
+    0xa6, 0x94, 0xe4, 0xec, 0x6a, 0x29, 0x2c, 0xaa, 0xa1, 0x63, 0xfc, 0x8c, 0x5f, 0x35, 0x03, 0xfe,
+    0x6c, 0x40, 0x18, 0x64, 0xa8, 0x66, 0x75, 0xd1, 0x81, 0x6e, 0x98, 0xc0, 0x69, 0xa1, 0x80, 0x10,
+    0x26, 0x1a, 0xbc, 0x4b, 0xd5, 0x58, 0x94, 0x50, 0x9d, 0x1a, 0x2d, 0x7b, 0x41, 0xf0, 0xa6, 0x3e,
+    0x86, 0xaf, 0xa8, 0x24, 0x97, 0x1a, 0x6f, 0xf6, 0xfb, 0x7d, 0xc1, 0x99, 0xa0, 0xa8, 0xa5, 0xac,
+    0x69, 0x2d, 0xce, 0xb6, 0x79, 0xf1, 0xf1, 0xd4, 0x66, 0x6e, 0xde, 0x4f, 0xd3, 0x3c, 0xaf, 0xaa,
+    0xc2, 0xd2, 0xd1, 0x22, 0xe0, 0xac, 0x11, 0xb8, 0xa2, 0xc2, 0x52, 0x3d, 0x37, 0x42, 0xa5, 0xb4,
+    0x56, 0x76, 0x78, 0x1f, 0xba, 0x7c, 0x3c, 0x6d, 0x2b, 0xcf, 0x06, 0xbe, 0x9c, 0x76, 0x1d, 0x8c,
+    0x68, 0x60, 0xc4, 0xb6, 0xf8, 0x90, 0x86, 0xcd, 0x0b, 0x58, 0x02, 0xbd, 0x95, 0xb7, 0x40, 0x43,
+    0xcb, 0x2c, 0xbd, 0xc3, 0x95, 0x9a, 0x50, 0x8d, 0x34, 0x10, 0xd6, 0x1b, 0xfc, 0x12, 0x57, 0x46,
+    0x64, 0x5a, 0x20, 0x72, 0xf0, 0x15, 0x76, 0x6a, 0x4c, 0x32, 0x7f, 0x2e, 0xd1, 0x4d, 0x09, 0x9f,
+    0xd3, 0xe7, 0xf8, 0x6d, 0xb3, 0x2f, 0x01, 0xa0, 0x96, 0xba, 0x43, 0xa1, 0xb2, 0x72, 0x6b, 0xc2,
+    0xec, 0x18, 0x09, 0x39, 0x94, 0x94, 0x3b, 0xc2, 0x8c, 0xe2, 0x70, 0xc6, 0x25, 0x97, 0xd5, 0xe9,
+    0x4e, 0x4a, 0x38, 0x17, 0x47, 0x3c, 0x4c, 0x13, 0x29, 0x25, 0x27, 0xfe, 0x22, 0x13, 0xaa, 0xb7,
+    0x3f, 0xed, 0x59, 0xd1, 0x6f, 0x61, 0x18, 0x6f, 0xcf, 0x37, 0x0b, 0x0a, 0x8c, 0x19, 0x3c, 0xf3,
+    0x9b, 0x9b, 0x14, 0x67, 0x69, 0xfa, 0xe9, 0xaa, 0x28, 0x5b, 0x14, 0xe1, 0xcc, 0x43, 0x1b, 0xc9,
+    0x19, 0x49, 0x36, 0x84, 0x90, 0x3b, 0x9d, 0x87, 0x8b, 0x4e, 0xf6, 0x2b, 0xdc, 0x9b, 0x37, 0xfd,
+    0x8a, 0xef, 0x5e, 0xf6, 0x9e, 0x4d, 0xb8, 0x5b, 0x1f, 0x67, 0x67, 0x26, 0x9f, 0xa6, 0x21, 0xce,
+    0x5d, 0x84, 0x14, 0xcb, 0x40, 0x33, 0x3f, 0xad, 0xe2, 0x06, 0xeb, 0xb1, 0x67, 0xd5, 0x6b, 0xe3,
+    0x4b, 0x28, 0xc9, 0xa2, 0xb1, 0x51, 0xbb, 0x67, 0xa0, 0x38, 0xcb, 0xd5, 0xd2, 0x1b, 0xb7, 0xf2,
+    0xdd, 0xdb, 0xba, 0x26, 0x38, 0x1e, 0x01, 0xa6, 0xa9, 0x4b, 0x7f, 0xd5, 0xfd, 0x35, 0x25, 0x56,
+    0xaa, 0xc9, 0xd9, 0x9b, 0xe2, 0x81, 0x6b, 0x0e, 0x59, 0x9e, 0x87, 0xd0, 0x6d, 0x35, 0x35, 0x3d,
+    0xb7, 0x7f, 0xa8, 0x72, 0xdd, 0x4b, 0x7c, 0x30, 0xd7, 0x6e, 0xa5, 0xdb, 0xfc, 0x2b, 0xed, 0xc2,
+    0x09, 0x03, 0xef, 0x94, 0x24, 0x4b, 0x72, 0x0f, 0xdf, 0x5f, 0x7f, 0x1c, 0xd3, 0x48, 0x07, 0x8c,
+    0xaf, 0xb6, 0xea, 0xc3, 0x61, 0xbf, 0x8f, 0x2d, 0x05, 0xb5, 0xde, 0xb8, 0x93, 0x71, 0xff, 0x6b,
+    0x50, 0x88, 0xf5, 0xfc, 0x54, 0x76, 0x51, 0x51, 0x98, 0x4a, 0xcd, 0xe5, 0x80, 0xce, 0x38, 0x26,
+    0x7b, 0x29, 0x7a, 0x4d, 0x59, 0xcd, 0xe9, 0x58, 0x44, 0x41, 0xc8, 0xbb, 0xd4, 0x99, 0x8b, 0xac,
+    0x06, 0x54, 0x0c, 0xf7, 0xc3, 0x9b, 0x7d, 0x99, 0x03, 0xbe, 0xca, 0xa1, 0xf0, 0xc9, 0x06, 0x7e,
+    0xef, 0xd6, 0x35, 0x25, 0x53, 0xc8, 0x17, 0x7c, 0x4a, 0xe9, 0x0d, 0x0b, 0xe6, 0x60, 0x2c, 0xaa,
+    0x5a, 0xc6, 0x89, 0x5b, 0x5f, 0x89, 0x61, 0x59, 0x0e, 0x26, 0x46, 0x81, 0x70, 0x81, 0x18, 0x67,
+    0x57, 0x6d, 0xb8, 0x65, 0x84, 0x50, 0x31, 0xfd, 0x05, 0xae, 0x8b, 0x94, 0x73, 0xa6, 0x0c, 0x33,
+    0x45, 0x0c, 0x1f, 0xf2, 0x17, 0x2b, 0xea, 0xcb, 0x0d, 0x1a, 0xd4, 0xaa, 0xa0, 0xa7, 0xe6, 0x6e,
+    0xed, 0x74, 0xeb, 0xe1, 0xdd, 0x83, 0xec, 0xec, 0x5f, 0x09, 0xf9, 0x0d, 0x93, 0x86, 0x96, 0x1e,
+    0xff, 0x04, 0x00, 0x00
+};
+
+#endif // PORTAL_ASSETS_H
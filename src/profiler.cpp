@@ -0,0 +1,180 @@
+#include "profiler.h"
+
+#define LOG_TAG "profiler"
+#include "logger.h"
+
+// Global profiler instance
+FrameProfiler profiler;
+
+/**
+ * @brief Constructor, starts empty
+ */
+StageHistogram::StageHistogram() :
+    count(0),
+    max(0) {
+    memset(buckets, 0, sizeof(buckets));
+}
+
+/**
+ * @brief Add one sample
+ * @param value Duration in the unit of the histogram
+ */
+void StageHistogram::record(uint32_t value) {
+    buckets[bucketOf(value)]++;
+    count++;
+    if (value > max) {
+        max = value;
+    }
+}
+
+/**
+ * @brief Get the number of samples since boot
+ * @return Sample count
+ */
+uint32_t StageHistogram::getCount() const {
+    return count;
+}
+
+/**
+ * @brief Get the longest sample since boot
+ * @return Duration in the unit of the histogram
+ */
+uint32_t StageHistogram::getMax() const {
+    return max;
+}
+
+/**
+ * @brief Estimate a percentile of all samples since boot
+ * @param percent Percentile, 0 to 100
+ * @return Upper bound of the bucket holding the percentile, 0 if empty
+ */
+uint32_t StageHistogram::percentile(uint8_t percent) const {
+    uint32_t total = count;
+    if (total == 0) {
+        return 0;
+    }
+
+    // Rank of the sample at the percentile, rounded up
+    uint32_t rank = (uint32_t)(((uint64_t)total * percent + 99) / 100);
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint32_t seen = 0;
+    for (uint8_t bucket = 0; bucket < PROFILE_BUCKETS; bucket++) {
+        seen += buckets[bucket];
+        if (seen >= rank) {
+            uint32_t upper = bucket + 1 < PROFILE_BUCKETS ? lowerBoundOf(bucket + 1) - 1 : UINT32_MAX;
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+/**
+ * @brief Find the bucket of a duration
+ *
+ * Values below PROFILE_SUB_BUCKETS get a bucket each. Above that, the
+ * position of the highest set bit selects the power of two and the next
+ * two bits the linear bucket within it.
+ *
+ * @param value Duration in the unit of the histogram
+ * @return Bucket index
+ */
+uint8_t StageHistogram::bucketOf(uint32_t value) {
+    if (value < PROFILE_SUB_BUCKETS) {
+        return value;
+    }
+    uint8_t exponent = 31 - __builtin_clz(value);
+    uint8_t mantissa = (value >> (exponent - 2)) & (PROFILE_SUB_BUCKETS - 1);
+    return (exponent - 1) * PROFILE_SUB_BUCKETS + mantissa;
+}
+
+/**
+ * @brief Get the shortest duration that falls into a bucket
+ * @param bucket Bucket index
+ * @return Duration in the unit of the histogram
+ */
+uint32_t StageHistogram::lowerBoundOf(uint8_t bucket) {
+    if (bucket < PROFILE_SUB_BUCKETS) {
+        return bucket;
+    }
+    uint8_t exponent = bucket / PROFILE_SUB_BUCKETS + 1;
+    uint8_t mantissa = bucket % PROFILE_SUB_BUCKETS;
+    return (uint32_t)(PROFILE_SUB_BUCKETS + mantissa) << (exponent - 2);
+}
+
+/**
+ * @brief Add one sample to a stage
+ * @param stage Profiled stage
+ * @param cycles Duration in CPU cycles
+ */
+void FrameProfiler::record(ProfileStage stage, uint32_t cycles) {
+    stages[stage].record(cycles);
+}
+
+/**
+ * @brief Get the histogram of a stage
+ * @param stage Profiled stage
+ * @return Histogram since boot
+ */
+const StageHistogram& FrameProfiler::get(ProfileStage stage) const {
+    return stages[stage];
+}
+
+/**
+ * @brief Print count, p50, p99 and max of every stage in microseconds
+ */
+void FrameProfiler::report() const {
+    for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        const StageHistogram& histogram = stages[i];
+        if (histogram.getCount() == 0) {
+            continue;
+        }
+        LOG_INFO("Profile %-9s n=%lu p50=%lu us p99=%lu us max=%lu us",
+                      nameOf(static_cast<ProfileStage>(i)),
+                      (unsigned long)histogram.getCount(),
+                      (unsigned long)toMicroseconds(histogram.percentile(50)),
+                      (unsigned long)toMicroseconds(histogram.percentile(99)),
+                      (unsigned long)toMicroseconds(histogram.getMax()));
+    }
+}
+
+/**
+ * @brief Get the name of a stage
+ * @param stage Profiled stage
+ * @return Short lowercase name
+ */
+const char* FrameProfiler::nameOf(ProfileStage stage) {
+    switch (stage) {
+        case PROFILE_STAGE_OTA:       return "ota";
+        case PROFILE_STAGE_PORTAL:    return "portal";
+        case PROFILE_STAGE_WIFI:      return "wifi";
+        case PROFILE_STAGE_FETCH:     return "fetch";
+        case PROFILE_STAGE_ANIMATION: return "animation";
+        case PROFILE_STAGE_STATUS:    return "status";
+        case PROFILE_STAGE_FRAME:     return "frame";
+        default:                      return "unknown";
+    }
+}
+
+/**
+ * @brief Convert CPU cycles to microseconds
+ * @param cycles Duration in CPU cycles
+ * @return Duration in microseconds
+ */
+uint32_t FrameProfiler::toMicroseconds(uint32_t cycles) {
+    return cycles / cyclesPerMicrosecond();
+}
+
+/**
+ * @brief Get the rate of readCycleCount()
+ * @return CPU cycles per microsecond, 1000 on the host where nanoseconds are counted
+ */
+uint32_t FrameProfiler::cyclesPerMicrosecond() {
+#ifdef ARDUINO
+    return ESP.getCpuFreqMHz();
+#else
+    return 1000;
+#endif
+}
@@ -0,0 +1,199 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+// Profiling on or off, can be overridden with -DPROFILE_ENABLED=0 in build_flags
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED 1                 // Set to 0 to compile all profiling scopes away
+#endif
+
+// Profiler configuration
+#define PROFILE_SUB_BUCKETS 4             // Buckets per power of two, sets the resolution to 25%
+#define PROFILE_BUCKETS 124               // Covers the full 32-bit cycle range
+#define PROFILE_REPORT_FRAMES 1000        // Frames between two reports on the serial port
+
+/**
+ * @brief Stages of the render and network tasks that are timed separately
+ */
+enum ProfileStage {
+    PROFILE_STAGE_OTA,          // handleOTA(), network task
+    PROFILE_STAGE_PORTAL,       // handleCaptivePortal(), network task
+    PROFILE_STAGE_WIFI,         // checkAndMaintainWiFi(), network task
+    PROFILE_STAGE_FETCH,        // Counter stream and API request handling, network task
+    PROFILE_STAGE_ANIMATION,    // Animation draw, render task
+    PROFILE_STAGE_STATUS,       // Status indicator, render task
+    PROFILE_STAGE_FRAME,        // Whole frame, render task
+    PROFILE_STAGE_COUNT
+};
+
+/**
+ * @brief Fixed-size histogram of durations with logarithmic buckets
+ *
+ * Every power of two is split into PROFILE_SUB_BUCKETS linear buckets,
+ * so percentiles are accurate to within 25% at any scale without storing
+ * samples. Recording is a few instructions and never allocates.
+ *
+ * Each histogram has a single writer. Readers on another task may see a
+ * sample counted in one field but not yet in another, which is fine for
+ * statistics.
+ */
+class StageHistogram {
+public:
+    /**
+     * @brief Constructor, starts empty
+     */
+    StageHistogram();
+
+    /**
+     * @brief Add one sample
+     * @param value Duration in the unit of the histogram
+     */
+    void record(uint32_t value);
+
+    /**
+     * @brief Get the number of samples since boot
+     * @return Sample count
+     */
+    uint32_t getCount() const;
+
+    /**
+     * @brief Get the longest sample since boot
+     * @return Duration in the unit of the histogram
+     */
+    uint32_t getMax() const;
+
+    /**
+     * @brief Estimate a percentile of all samples since boot
+     * @param percent Percentile, 0 to 100
+     * @return Upper bound of the bucket holding the percentile, 0 if empty
+     */
+    uint32_t percentile(uint8_t percent) const;
+
+private:
+    uint32_t buckets[PROFILE_BUCKETS];    // Samples per bucket
+    uint32_t count;                       // Samples in all buckets
+    uint32_t max;                         // Longest sample
+
+    /**
+     * @brief Find the bucket of a duration
+     * @param value Duration in the unit of the histogram
+     * @return Bucket index
+     */
+    static uint8_t bucketOf(uint32_t value);
+
+    /**
+     * @brief Get the shortest duration that falls into a bucket
+     * @param bucket Bucket index
+     * @return Duration in the unit of the histogram
+     */
+    static uint32_t lowerBoundOf(uint8_t bucket);
+};
+
+/**
+ * @brief Collects one histogram per profiled stage
+ */
+class FrameProfiler {
+public:
+    /**
+     * @brief Add one sample to a stage
+     * @param stage Profiled stage
+     * @param cycles Duration in CPU cycles
+     */
+    void record(ProfileStage stage, uint32_t cycles);
+
+    /**
+     * @brief Get the histogram of a stage
+     * @param stage Profiled stage
+     * @return Histogram since boot
+     */
+    const StageHistogram& get(ProfileStage stage) const;
+
+    /**
+     * @brief Print count, p50, p99 and max of every stage in microseconds
+     */
+    void report() const;
+
+    /**
+     * @brief Get the name of a stage
+     * @param stage Profiled stage
+     * @return Short lowercase name
+     */
+    static const char* nameOf(ProfileStage stage);
+
+    /**
+     * @brief Convert CPU cycles to microseconds
+     * @param cycles Duration in CPU cycles
+     * @return Duration in microseconds
+     */
+    static uint32_t toMicroseconds(uint32_t cycles);
+
+    /**
+     * @brief Get the rate of readCycleCount()
+     * @return CPU cycles per microsecond, 1000 on the host where nanoseconds are counted
+     */
+    static uint32_t cyclesPerMicrosecond();
+
+private:
+    StageHistogram stages[PROFILE_STAGE_COUNT];
+};
+
+// Global profiler shared by the render and network tasks
+extern FrameProfiler profiler;
+
+/**
+ * @brief Read the CPU cycle counter
+ *
+ * Host builds run on virtual time, so they read the monotonic clock in
+ * nanoseconds instead.
+ *
+ * @return Cycles since an arbitrary point, wraps around
+ */
+inline uint32_t readCycleCount() {
+#ifdef ARDUINO
+    return ESP.getCycleCount();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * @brief Times the enclosing block and records it when the block is left
+ */
+class ProfileScope {
+public:
+    /**
+     * @brief Constructor, starts timing
+     * @param profiledStage Stage the block belongs to
+     */
+    explicit ProfileScope(ProfileStage profiledStage) :
+        stage(profiledStage),
+        start(readCycleCount()) {
+    }
+
+    /**
+     * @brief Destructor, records the elapsed cycles
+     */
+    ~ProfileScope() {
+        profiler.record(stage, readCycleCount() - start);
+    }
+
+private:
+    ProfileStage stage;    // Stage the block belongs to
+    uint32_t start;        // Cycle count at the start of the block
+};
+
+#if PROFILE_ENABLED
+#define PROFILE_SCOPE_NAME(line) profileScope##line
+#define PROFILE_SCOPE_AT(stage, line) ProfileScope PROFILE_SCOPE_NAME(line)(stage)
+#define PROFILE_SCOPE(stage) PROFILE_SCOPE_AT(stage, __LINE__)
+#else
+#define PROFILE_SCOPE(stage) do {} while (0)
+#endif
+
+#endif // PROFILER_H
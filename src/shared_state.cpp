@@ -0,0 +1,40 @@
+#include "shared_state.h"
+#include <atomic>
+
+// Sequence lock: odd while a publish is in progress
+static std::atomic<uint32_t> stateSequence(0);
+static DisplayState sharedState = {0, false, false, false};
+
+/**
+ * @brief Publish a new display state snapshot
+ * @param state New state to publish
+ */
+void publishDisplayState(const DisplayState& state) {
+    uint32_t sequence = stateSequence.load(std::memory_order_relaxed);
+
+    stateSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    sharedState = state;
+
+    stateSequence.store(sequence + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Read the latest consistent display state snapshot
+ * @return Copy of the latest published state
+ */
+DisplayState readDisplayState() {
+    DisplayState snapshot;
+    uint32_t before;
+    uint32_t after;
+
+    do {
+        before = stateSequence.load(std::memory_order_acquire);
+        snapshot = sharedState;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = stateSequence.load(std::memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+
+    return snapshot;
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef SHARED_STATE_H
+#define SHARED_STATE_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Everything the render task needs to know about the outside world
+ */
+struct DisplayState {
+    unsigned long counter;        // Counter value to display
+    bool wifiConnected;           // WiFi station is connected
+    bool lastRequestSuccessful;   // Last API request succeeded
+    bool counterFresh;            // Counter was confirmed by the API since boot
+};
+
+/**
+ * @brief Publish a new display state snapshot
+ *
+ * Must only be called from a single writer running on the other core than
+ * the render task (the network task, or setup() before the render task is
+ * started). Never blocks.
+ *
+ * @param state New state to publish
+ */
+void publishDisplayState(const DisplayState& state);
+
+/**
+ * @brief Read the latest consistent display state snapshot
+ *
+ * Lock-free: retries while a publish is in progress instead of waiting
+ * on a mutex, so the render task never blocks on the network task.
+ *
+ * @return Copy of the latest published state
+ */
+DisplayState readDisplayState();
+
+#endif // SHARED_STATE_H
\ No newline at end of file
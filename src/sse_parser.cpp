@@ -0,0 +1,223 @@
+#include "sse_parser.h"
+
+/**
+ * @brief Constructor
+ */
+SseParser::SseParser() :
+    handler(nullptr),
+    handlerContext(nullptr),
+    retry(0),
+    droppedCount(0) {
+    reset();
+}
+
+/**
+ * @brief Set the callback for complete events
+ * @param eventHandler Event callback
+ * @param context Pointer passed to every handler call
+ */
+void SseParser::setHandler(SseEventHandler eventHandler, void* context) {
+    handler = eventHandler;
+    handlerContext = context;
+}
+
+/**
+ * @brief Forget any partial event, for example after reconnecting
+ */
+void SseParser::reset() {
+    lineState = LINE_START;
+    afterCr = false;
+    field[0] = '\0';
+    fieldLength = 0;
+    fieldType = FIELD_OTHER;
+    retryValue = 0;
+    eventLength = 0;
+    event[0] = '\0';
+    data[0] = '\0';
+    dataLength = 0;
+    hasData = false;
+    dataTruncated = false;
+}
+
+/**
+ * @brief Parse the next part of the stream
+ * @param bytes Received bytes
+ * @param length Number of bytes
+ */
+void SseParser::feed(const char* bytes, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        char c = bytes[i];
+
+        // Lines end with CRLF, LF or a bare CR, the LF of a CRLF may arrive
+        // in the next read
+        if (c == '\n' && afterCr) {
+            afterCr = false;
+            continue;
+        }
+        afterCr = c == '\r';
+        if (afterCr) {
+            c = '\n';
+        }
+
+        switch (lineState) {
+            case LINE_START:
+                if (c == '\n') {
+                    // An empty line completes the event
+                    dispatchEvent();
+                } else if (c == ':') {
+                    // Comment, servers send these to keep the stream alive
+                    lineState = LINE_IGNORE;
+                } else {
+                    field[0] = c;
+                    fieldLength = 1;
+                    lineState = LINE_FIELD;
+                }
+                break;
+
+            case LINE_FIELD:
+                if (c == ':' || c == '\n') {
+                    field[fieldLength] = '\0';
+                    beginValue();
+                    if (c == '\n') {
+                        endLine();
+                    } else {
+                        lineState = LINE_VALUE_START;
+                    }
+                } else if (fieldLength < SSE_FIELD_MAX - 1) {
+                    field[fieldLength++] = c;
+                } else {
+                    // No field we know is that long
+                    lineState = LINE_IGNORE;
+                }
+                break;
+
+            case LINE_VALUE_START:
+                lineState = LINE_VALUE;
+                if (c == ' ') {
+                    break;
+                }
+                // The character already belongs to the value
+                // fall through
+            case LINE_VALUE:
+                if (c == '\n') {
+                    endLine();
+                } else {
+                    appendValue(c);
+                }
+                break;
+
+            case LINE_IGNORE:
+                if (c == '\n') {
+                    lineState = LINE_START;
+                }
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Get the reconnect delay requested with a retry field
+ * @return Delay in milliseconds, 0 if the server did not send one
+ */
+unsigned long SseParser::getRetry() const {
+    return retry;
+}
+
+/**
+ * @brief Get the number of events dropped because they were too large
+ * @return Dropped event count
+ */
+uint32_t SseParser::getDroppedCount() const {
+    return droppedCount;
+}
+
+/**
+ * @brief Start the value of the field that was just named
+ */
+void SseParser::beginValue() {
+    if (strcmp(field, "data") == 0) {
+        fieldType = FIELD_DATA;
+
+        // Multiple data lines are joined with a line feed
+        if (hasData) {
+            appendValue('\n');
+        }
+        hasData = true;
+    } else if (strcmp(field, "event") == 0) {
+        fieldType = FIELD_EVENT;
+        eventLength = 0;
+        event[0] = '\0';
+    } else if (strcmp(field, "retry") == 0) {
+        fieldType = FIELD_RETRY;
+        retryValue = 0;
+    } else {
+        fieldType = FIELD_OTHER;
+    }
+}
+
+/**
+ * @brief Append a character to the current field value
+ * @param c Character to append
+ */
+void SseParser::appendValue(char c) {
+    switch (fieldType) {
+        case FIELD_DATA:
+            if (dataLength < SSE_DATA_MAX - 1) {
+                data[dataLength++] = c;
+            } else {
+                dataTruncated = true;
+            }
+            break;
+
+        case FIELD_EVENT:
+            if (eventLength < SSE_EVENT_MAX - 1) {
+                event[eventLength++] = c;
+                event[eventLength] = '\0';
+            }
+            break;
+
+        case FIELD_RETRY:
+            // Only plain digits are a valid retry value
+            if (c >= '0' && c <= '9' && retryValue < 100000000UL) {
+                retryValue = retryValue * 10 + (c - '0');
+            } else {
+                fieldType = FIELD_OTHER;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Finish the current field line
+ */
+void SseParser::endLine() {
+    if (fieldType == FIELD_RETRY && retryValue > 0) {
+        retry = retryValue;
+    }
+    fieldType = FIELD_OTHER;
+    lineState = LINE_START;
+}
+
+/**
+ * @brief Pass the pending event to the handler and start a new one
+ */
+void SseParser::dispatchEvent() {
+    if (hasData) {
+        if (dataTruncated) {
+            droppedCount++;
+        } else if (handler != nullptr) {
+            data[dataLength] = '\0';
+            handler(eventLength > 0 ? event : "message", data, handlerContext);
+        }
+    }
+
+    eventLength = 0;
+    event[0] = '\0';
+    dataLength = 0;
+    data[0] = '\0';
+    hasData = false;
+    dataTruncated = false;
+}
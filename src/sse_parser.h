@@ -0,0 +1,124 @@
+#ifndef SSE_PARSER_H
+#define SSE_PARSER_H
+
+#include <Arduino.h>
+
+// Buffer sizes (including the terminating null)
+#define SSE_DATA_MAX 384        // Maximum data of one event
+#define SSE_EVENT_MAX 24        // Maximum event type length
+#define SSE_FIELD_MAX 8         // Maximum field name length
+
+/**
+ * @brief Callback receiving a complete server-sent event
+ * @param event Event type, "message" if the server did not name it
+ * @param data Event data, multiple data lines joined by '\n'
+ * @param context Pointer passed to setHandler()
+ */
+typedef void (*SseEventHandler)(const char* event, const char* data, void* context);
+
+/**
+ * @brief Streaming parser for text/event-stream bodies
+ *
+ * Bytes can be fed in arbitrary chunks. Events whose data does not fit
+ * into SSE_DATA_MAX are dropped, comments and id fields are ignored.
+ * No heap is used.
+ */
+class SseParser {
+public:
+    /**
+     * @brief Constructor
+     */
+    SseParser();
+
+    /**
+     * @brief Set the callback for complete events
+     * @param eventHandler Event callback
+     * @param context Pointer passed to every handler call
+     */
+    void setHandler(SseEventHandler eventHandler, void* context);
+
+    /**
+     * @brief Forget any partial event, for example after reconnecting
+     */
+    void reset();
+
+    /**
+     * @brief Parse the next part of the stream
+     * @param bytes Received bytes
+     * @param length Number of bytes
+     */
+    void feed(const char* bytes, size_t length);
+
+    /**
+     * @brief Get the reconnect delay requested with a retry field
+     * @return Delay in milliseconds, 0 if the server did not send one
+     */
+    unsigned long getRetry() const;
+
+    /**
+     * @brief Get the number of events dropped because they were too large
+     * @return Dropped event count
+     */
+    uint32_t getDroppedCount() const;
+
+private:
+    // Position inside the current line
+    enum LineState {
+        LINE_START,         // At the beginning of a line
+        LINE_FIELD,         // Inside the field name
+        LINE_VALUE_START,   // Right after the colon, a single space is skipped
+        LINE_VALUE,         // Inside the field value
+        LINE_IGNORE         // Inside a comment or an unknown field
+    };
+
+    // Fields that are not ignored
+    enum FieldType {
+        FIELD_DATA,         // Event data
+        FIELD_EVENT,        // Event type
+        FIELD_RETRY,        // Reconnect delay
+        FIELD_OTHER         // Anything else
+    };
+
+    SseEventHandler handler;            // Event callback
+    void* handlerContext;               // Context passed to handler
+
+    LineState lineState;                // Current line state
+    bool afterCr;                       // Last character was a CR, a LF right after it is skipped
+    char field[SSE_FIELD_MAX];          // Current field name
+    uint8_t fieldLength;                // Characters in field
+    FieldType fieldType;                // Type of the current field
+    unsigned long retryValue;           // Retry value being parsed
+    size_t eventLength;                 // Characters in event
+
+    char event[SSE_EVENT_MAX];          // Event type of the pending event
+    char data[SSE_DATA_MAX];            // Data of the pending event
+    size_t dataLength;                  // Characters in data
+    bool hasData;                       // Pending event has a data field
+    bool dataTruncated;                 // Pending event data did not fit
+
+    unsigned long retry;                // Requested reconnect delay
+    uint32_t droppedCount;              // Statistics: dropped events
+
+    /**
+     * @brief Start the value of the field that was just named
+     */
+    void beginValue();
+
+    /**
+     * @brief Append a character to the current field value
+     * @param c Character to append
+     */
+    void appendValue(char c);
+
+    /**
+     * @brief Finish the current field line
+     */
+    void endLine();
+
+    /**
+     * @brief Pass the pending event to the handler and start a new one
+     */
+    void dispatchEvent();
+};
+
+#endif // SSE_PARSER_H
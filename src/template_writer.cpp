@@ -0,0 +1,125 @@
+#include "template_writer.h"
+
+/**
+ * @brief Constructor
+ * @param target Server handling the current request
+ */
+TemplateWriter::TemplateWriter(WebServer& target) :
+    server(target),
+    length(0) {
+}
+
+/**
+ * @brief Send the status line and headers of a chunked response
+ * @param code HTTP status code
+ * @param contentType Content type of the response
+ */
+void TemplateWriter::begin(int code, const char* contentType) {
+    length = 0;
+
+    // An unknown length switches the server to chunked transfer encoding
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(code, contentType, "");
+}
+
+/**
+ * @brief Write a template, placeholders are filled in by the handler
+ * @param text Null terminated template
+ * @param handler Callback for placeholder values, placeholders are dropped if nullptr
+ * @param context Pointer passed to every handler call
+ */
+void TemplateWriter::render(const char* text, TemplateValueHandler handler, void* context) {
+    const char* literal = text;
+
+    for (;;) {
+        const char* open = strstr(literal, "{{");
+        const char* close = open != nullptr ? strstr(open + 2, "}}") : nullptr;
+        if (close == nullptr) {
+            write(literal, strlen(literal));
+            return;
+        }
+
+        write(literal, open - literal);
+
+        char name[TEMPLATE_NAME_MAX];
+        size_t nameLength = min((size_t)(close - open - 2), sizeof(name) - 1);
+        memcpy(name, open + 2, nameLength);
+        name[nameLength] = '\0';
+        if (handler != nullptr) {
+            handler(name, *this, context);
+        }
+
+        literal = close + 2;
+    }
+}
+
+/**
+ * @brief Write raw bytes
+ * @param data Bytes to write
+ * @param dataLength Number of bytes
+ */
+void TemplateWriter::write(const char* data, size_t dataLength) {
+    while (dataLength > 0) {
+        size_t count = min(dataLength, sizeof(buffer) - length);
+        memcpy(buffer + length, data, count);
+        length += count;
+        data += count;
+        dataLength -= count;
+
+        if (length == sizeof(buffer)) {
+            flush();
+        }
+    }
+}
+
+/**
+ * @brief Write raw text
+ * @param text Null terminated text
+ */
+void TemplateWriter::write(const char* text) {
+    write(text, strlen(text));
+}
+
+/**
+ * @brief Write text with HTML special characters escaped
+ * @param text Null terminated text
+ */
+void TemplateWriter::writeEscaped(const char* text) {
+    const char* plain = text;
+
+    for (const char* c = text; *c != '\0'; c++) {
+        const char* entity;
+        switch (*c) {
+            case '&':  entity = "&amp;";  break;
+            case '<':  entity = "&lt;";   break;
+            case '>':  entity = "&gt;";   break;
+            case '"':  entity = "&quot;"; break;
+            case '\'': entity = "&#39;";  break;
+            default:   continue;
+        }
+        write(plain, c - plain);
+        write(entity, strlen(entity));
+        plain = c + 1;
+    }
+    write(plain, strlen(plain));
+}
+
+/**
+ * @brief Send the remaining output and finish the response
+ */
+void TemplateWriter::end() {
+    flush();
+
+    // An empty chunk ends a chunked response
+    server.sendContent("");
+}
+
+/**
+ * @brief Send the buffered output as one chunk
+ */
+void TemplateWriter::flush() {
+    if (length > 0) {
+        server.sendContent(buffer, length);
+        length = 0;
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef TEMPLATE_WRITER_H
+#define TEMPLATE_WRITER_H
+
+#include <Arduino.h>
+#include <WebServer.h>
+
+// Template writer configuration
+#define TEMPLATE_CHUNK_SIZE 512     // Bytes collected before a chunk is sent
+#define TEMPLATE_NAME_MAX 16        // Maximum placeholder name length including the null
+
+class TemplateWriter;
+
+/**
+ * @brief Callback writing the value of one placeholder
+ * @param name Placeholder name, without the braces
+ * @param writer Writer to send the value to, usually with writeEscaped()
+ * @param context Pointer passed to render()
+ */
+typedef void (*TemplateValueHandler)(const char* name, TemplateWriter& writer, void* context);
+
+/**
+ * @brief Streams an HTML template with {{name}} placeholders as a chunked response
+ *
+ * Output is collected in a fixed buffer and sent in chunks of
+ * TEMPLATE_CHUNK_SIZE bytes, so the page is never assembled in memory
+ * and no heap is used. The template itself can stay in flash.
+ */
+class TemplateWriter {
+public:
+    /**
+     * @brief Constructor
+     * @param target Server handling the current request
+     */
+    explicit TemplateWriter(WebServer& target);
+
+    /**
+     * @brief Send the status line and headers of a chunked response
+     * @param code HTTP status code
+     * @param contentType Content type of the response
+     */
+    void begin(int code, const char* contentType);
+
+    /**
+     * @brief Write a template, placeholders are filled in by the handler
+     * @param text Null terminated template
+     * @param handler Callback for placeholder values, placeholders are dropped if nullptr
+     * @param context Pointer passed to every handler call
+     */
+    void render(const char* text, TemplateValueHandler handler, void* context);
+
+    /**
+     * @brief Write raw bytes
+     * @param data Bytes to write
+     * @param dataLength Number of bytes
+     */
+    void write(const char* data, size_t dataLength);
+
+    /**
+     * @brief Write raw text
+     * @param text Null terminated text
+     */
+    void write(const char* text);
+
+    /**
+     * @brief Write text with HTML special characters escaped
+     * @param text Null terminated text
+     */
+    void writeEscaped(const char* text);
+
+    /**
+     * @brief Send the remaining output and finish the response
+     */
+    void end();
+
+private:
+    WebServer& server;                      // Server handling the current request
+    char buffer[TEMPLATE_CHUNK_SIZE];       // Output not sent yet
+    size_t length;                          // Bytes in buffer
+
+    /**
+     * @brief Send the buffered output as one chunk
+     */
+    void flush();
+};
+
+#endif // TEMPLATE_WRITER_H
@@ -0,0 +1,114 @@
+#include "wifi_cache.h"
+#include <Preferences.h>
+#include <stddef.h>
+#include "fnv1a.h"
+
+// Marks a record written by this firmware
+static const uint32_t STORED_WIFI_MAGIC = 0x57464332; // "WFC2"
+
+/**
+ * @brief Load the record of an SSID
+ * @param ssid Network SSID
+ * @param record Loaded record
+ * @return True if an intact record for the SSID was found
+ */
+bool WiFiCache::load(const char* ssid, StoredWiFiNetwork& record) {
+    char key[16];
+    Preferences preferences;
+
+    keyOf(ssid, key);
+    memset(&record, 0, sizeof(record));
+    if (!preferences.begin(WIFI_CACHE_NAMESPACE, true)) {
+        return false;
+    }
+    bool found = preferences.getBytes(key, &record, sizeof(record)) == sizeof(record);
+    preferences.end();
+
+    // Hash collisions are caught by comparing the SSID
+    return found &&
+           record.magic == STORED_WIFI_MAGIC &&
+           record.ssid[WIFI_SSID_MAX - 1] == '\0' &&
+           record.checksum == checksumOf(record) &&
+           strcmp(record.ssid, ssid) == 0;
+}
+
+/**
+ * @brief Store the record of an SSID if it differs from the stored one
+ * @param record Record to store, ssid must be set
+ * @return True if the stored record is up to date
+ */
+bool WiFiCache::save(StoredWiFiNetwork& record) {
+    record.magic = STORED_WIFI_MAGIC;
+    record.ssid[WIFI_SSID_MAX - 1] = '\0';
+    record.checksum = checksumOf(record);
+
+    // Reconnects to the same access point must not wear the flash
+    StoredWiFiNetwork stored;
+    if (load(record.ssid, stored) && memcmp(&stored, &record, sizeof(record)) == 0) {
+        return true;
+    }
+
+    char key[16];
+    Preferences preferences;
+
+    keyOf(record.ssid, key);
+    if (!preferences.begin(WIFI_CACHE_NAMESPACE, false)) {
+        return false;
+    }
+    bool success = preferences.putBytes(key, &record, sizeof(record)) == sizeof(record);
+    preferences.end();
+    return success;
+}
+
+/**
+ * @brief Remove the record of an SSID
+ * @param ssid Network SSID
+ */
+void WiFiCache::forget(const char* ssid) {
+    char key[16];
+    Preferences preferences;
+
+    keyOf(ssid, key);
+    if (preferences.begin(WIFI_CACHE_NAMESPACE, false)) {
+        preferences.remove(key);
+        preferences.end();
+    }
+}
+
+/**
+ * @brief Check if the lease of a record can still be used
+ * @param record Loaded record
+ * @param clock Current count of time()
+ * @param now Current time() in seconds
+ * @return False if there is no lease, it expired or its age is unknown
+ */
+bool WiFiCache::leaseValid(const StoredWiFiNetwork& record, uint32_t clock, uint32_t now) {
+    if (record.ip == 0 || record.leaseSeconds == 0) {
+        return false;
+    }
+    // After a power loss the time since the lease start is unknown
+    if (record.leaseClock != clock || now < record.leaseStart) {
+        return false;
+    }
+    // Stop at the renewal time, half the lease, so the server still holds the address
+    return now - record.leaseStart < record.leaseSeconds / 2;
+}
+
+/**
+ * @brief Build the NVS key of an SSID
+ * @param ssid Network SSID
+ * @param key Buffer for the key, NVS keys are at most 15 characters
+ */
+void WiFiCache::keyOf(const char* ssid, char (&key)[16]) {
+    uint32_t hash = fnv1a(FNV1A_SEED, ssid, strlen(ssid));
+    snprintf(key, sizeof(key), "n%08lx", (unsigned long)hash);
+}
+
+/**
+ * @brief Compute the checksum of a record
+ * @param record Record to checksum
+ * @return FNV-1a hash of all fields before the checksum
+ */
+uint32_t WiFiCache::checksumOf(const StoredWiFiNetwork& record) {
+    return fnv1a(FNV1A_SEED, &record, offsetof(StoredWiFiNetwork, checksum));
+}
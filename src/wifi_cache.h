@@ -0,0 +1,89 @@
+#ifndef WIFI_CACHE_H
+#define WIFI_CACHE_H
+
+#include <Arduino.h>
+#include "config_store.h"
+
+// Persistence configuration
+#define WIFI_CACHE_NAMESPACE "wifi"                // NVS namespace
+
+/**
+ * @brief What is known about the last successful connection to one SSID
+ *
+ * Addresses are stored as uint32_t in IPAddress byte order, a zero ip
+ * means there is no lease to reuse. The lease start is read from time(),
+ * which keeps counting across resets but starts over after a power loss,
+ * leaseClock tells the two counts apart.
+ */
+struct StoredWiFiNetwork {
+    uint32_t magic;                                // Marks an initialized record
+    char ssid[WIFI_SSID_MAX];                      // SSID the record belongs to
+    uint8_t bssid[6];                              // Access point that accepted the connection
+    uint8_t channel;                               // Channel of that access point
+    uint32_t ip;                                   // Leased address
+    uint32_t gateway;                              // Gateway of the lease
+    uint32_t subnet;                               // Subnet mask of the lease
+    uint32_t dns;                                  // DNS server of the lease
+    uint32_t leaseSeconds;                         // Lease time granted by the DHCP server
+    uint32_t leaseStart;                           // time() in seconds when the lease was granted
+    uint32_t leaseClock;                           // Count of time() leaseStart belongs to
+    uint32_t checksum;                             // Checksum of the fields above
+};
+
+/**
+ * @brief Remembers access point and DHCP lease per SSID in NVS
+ *
+ * Allows a directed connect to a known BSSID and channel without a
+ * scan, and skipping DHCP by reusing the last lease. Each SSID gets its
+ * own NVS key derived from a hash of the SSID. Records are only written
+ * when something changed.
+ */
+class WiFiCache {
+public:
+    /**
+     * @brief Load the record of an SSID
+     * @param ssid Network SSID
+     * @param record Loaded record
+     * @return True if an intact record for the SSID was found
+     */
+    bool load(const char* ssid, StoredWiFiNetwork& record);
+
+    /**
+     * @brief Store the record of an SSID if it differs from the stored one
+     * @param record Record to store, ssid must be set
+     * @return True if the stored record is up to date
+     */
+    bool save(StoredWiFiNetwork& record);
+
+    /**
+     * @brief Remove the record of an SSID
+     * @param ssid Network SSID
+     */
+    void forget(const char* ssid);
+
+    /**
+     * @brief Check if the lease of a record can still be used
+     * @param record Loaded record
+     * @param clock Current count of time()
+     * @param now Current time() in seconds
+     * @return False if there is no lease, it expired or its age is unknown
+     */
+    static bool leaseValid(const StoredWiFiNetwork& record, uint32_t clock, uint32_t now);
+
+private:
+    /**
+     * @brief Build the NVS key of an SSID
+     * @param ssid Network SSID
+     * @param key Buffer for the key, NVS keys are at most 15 characters
+     */
+    static void keyOf(const char* ssid, char (&key)[16]);
+
+    /**
+     * @brief Compute the checksum of a record
+     * @param record Record to checksum
+     * @return FNV-1a hash of all fields before the checksum
+     */
+    static uint32_t checksumOf(const StoredWiFiNetwork& record);
+};
+
+#endif // WIFI_CACHE_H
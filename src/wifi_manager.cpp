@@ -1,13 +1,96 @@
 #include "wifi_manager.h"
+#include "wifi_cache.h"
+#include "template_writer.h"
+#include "portal_assets.h"
+#include "clock.h"
+#include <atomic>
+#include <time.h>
+#include <esp_system.h>
+#include <esp_netif.h>
+#include <esp_netif_net_stack.h>
+#include <lwip/tcpip.h>
+#include <lwip/etharp.h>
+#include <lwip/dhcp.h>
+#include <lwip/prot/dhcp.h>
+
+#define LOG_TAG "wifi"
+#include "logger.h"
 
 // Global variables for captive portal functionality
 WebServer webServer(WEB_SERVER_PORT);
 DNSServer dnsServer;
 bool captivePortalActive = false;
-unsigned long portalStartTime = 0;
+uint32_t portalStartTime = 0;
+
+// WiFi connection state machine
+static WiFiConnectionState wifiState = WIFI_STATE_IDLE;
+static uint32_t wifiStateSince = 0;            // Time the current state was entered
+static bool wifiFastAttempt = false;           // Current attempt uses the cached access point without a scan
+static size_t wifiNetwork = 0;                 // Network of the current attempt or connection
+static int wifiPreferredNetwork = -1;          // Network tried first in a round, -1 if not known yet
+static WiFiCache wifiCache;                    // Access point and lease per SSID
+static bool wifiLeaseReused = false;           // Current attempt skipped DHCP
+static StoredWiFiNetwork wifiReusedLease;      // Cached record whose lease the current attempt reuses
+static uint32_t wifiArpRequestTime = 0;        // Last ARP request to the gateway of a reused lease
+
+// Identifies the current count of time(), kept across resets but not across a power loss
+RTC_NOINIT_ATTR static uint32_t leaseClock;
+
+/**
+ * @brief A configured network found by the last scan
+ */
+struct WiFiCandidate {
+    size_t network;          // Index into the configured networks
+    int8_t rssi;             // Signal strength of the strongest access point
+    uint8_t channel;         // Channel of that access point
+    uint8_t bssid[6];        // That access point
+};
+
+// Visible configured networks of the last scan, strongest first
+static WiFiCandidate wifiCandidates[WIFI_NETWORKS_MAX];
+static size_t wifiCandidateCount = 0;
+static size_t wifiCandidateIndex = 0;          // Candidate of the current attempt
+static unsigned long wifiRetryDelay = 0;       // Delay before the next connection round
+static bool portalOnFailure = false;           // Start the portal if no network can be reached
+static bool wifiLost = false;                  // Reconnecting after a lost connection
+static uint32_t wifiLostAt = 0;                // Time the connection was lost
+static bool otaStarted = false;                // OTA is initialized after the first connection
+static WiFiConnectionStats wifiStats = {0, 0, 0, 0};
+
+// Written by the WiFi event task, read by the network task
+static volatile uint32_t gotIpEvents = 0;
+static volatile uint32_t disconnectEvents = 0;
+static volatile uint8_t lastDisconnectReason = 0;
+static uint32_t seenGotIpEvents = 0;
+static uint32_t seenDisconnectEvents = 0;
+
+// Shared between the network task and the portal task
+static std::atomic<bool> portalStopRequested(false);   // Portal task should stop the servers
+static std::atomic<bool> portalTaskRunning(false);     // Portal task has not stopped yet
+static std::atomic<bool> portalClosing(false);         // Credentials were saved, portal closes soon
+static uint32_t portalCloseTime = 0;                   // Time the credentials were saved
+
+// Background scan of the captive portal, runs in the network task
+static bool portalScanRunning = false;
+static uint32_t portalScanTime = 0;                    // Start or end of the last scan
+
+/**
+ * @brief A network found by the portal scan
+ */
+struct PortalNetwork {
+    char ssid[WIFI_SSID_MAX];    // Network SSID
+    int8_t rssi;                 // Signal strength of the strongest access point
+    bool open;                   // Network needs no password
+};
+
+// Cached scan results, written by the network task and read by the portal task
+static std::atomic<uint32_t> portalNetworksSequence(0);  // Odd while an update is in progress
+static PortalNetwork portalNetworks[PORTAL_NETWORKS_MAX];
+static size_t portalNetworkCount = 0;
 
 // Forward declarations of captive portal handlers
 void handleRoot();
+void handleStyle();
 void handleSave();
 void handleNotFound();
 
@@ -17,9 +100,9 @@ void handleNotFound();
 void printSpiffsFiles() {
     File root = SPIFFS.open("/");
     File file = root.openNextFile();
-    Serial.println("Files in SPIFFS:");
+    LOG_INFO("Files in SPIFFS:");
     while(file) {
-        Serial.printf("  %s (%d bytes)\n", file.name(), file.size());
+        LOG_INFO("  %s (%u bytes)", file.name(), (unsigned)file.size());
         file = root.openNextFile();
     }
 }
@@ -47,141 +130,516 @@ bool copyToBuffer(char* dest, String source, size_t maxSize) {
 }
 
 /**
- * @brief Logs credential information for debugging
+ * @brief Logs credential information for debugging, never the password itself
  */
 void logCredentials(const char* ssid, const char* password) {
     size_t ssidLen = strlen(ssid);
     size_t pwdLen = strlen(password);
     
-    Serial.println("WiFi credentials loaded from config file");
-    Serial.printf("SSID: [%s]\n", ssid);
-    Serial.printf("SSID length: %d\n", ssidLen);
-    Serial.printf("Password: [%s]\n", password);
-    Serial.printf("Password length: %d\n", pwdLen);
+    LOG_INFO("WiFi credentials loaded from configuration");
+    LOG_INFO("SSID: [%s]", ssid);
+    LOG_DEBUG("SSID length: %u", (unsigned)ssidLen);
+    LOG_DEBUG("Password length: %u", (unsigned)pwdLen);
     
-    Serial.println("SSID hex values:");
-    for (size_t i = 0; i < ssidLen; i++) {
-        Serial.printf("0x%02X ", (uint8_t)ssid[i]);
+#if LOG_LOCAL_LEVEL >= LOG_LEVEL_DEBUG
+    char hex[WIFI_SSID_MAX * 5];
+    size_t hexLength = 0;
+    for (size_t i = 0; i < ssidLen && hexLength + 6 <= sizeof(hex); i++) {
+        hexLength += snprintf(hex + hexLength, sizeof(hex) - hexLength, "0x%02X ", (uint8_t)ssid[i]);
     }
-    Serial.println();
+    hex[hexLength] = '\0';
+    LOG_DEBUG("SSID hex values: %s", hex);
+#endif
 }
 
 /**
- * @brief Attempts to connect to WiFi using given credentials
- * 
- * @param ssid WiFi network SSID
- * @param password WiFi network password
- * @return True if connection successful
+ * @brief Receives WiFi events, runs in the WiFi event task
+ *
+ * Only counts the events, checkAndMaintainWiFi() acts on them in the
+ * network task.
+ *
+ * @param event Event type
+ * @param info Event details
  */
-bool attemptWiFiConnection(const char* ssid, const char* password) {
-    Serial.printf("Attempting to connect to WiFi network: %s\n", ssid);
-    updateStatusIndicator(false, false);
-    
+static void onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            gotIpEvents++;
+            break;
+
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            lastDisconnectReason = info.wifi_sta_disconnected.reason;
+            disconnectEvents++;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Checks whether new events of one kind arrived since the last call
+ *
+ * @param events Event count maintained by the event task
+ * @param seen Event count already handled
+ * @return True if at least one new event arrived
+ */
+static bool takeWiFiEvent(volatile uint32_t& events, uint32_t& seen) {
+    uint32_t current = events;
+    if (current == seen) {
+        return false;
+    }
+    seen = current;
+    return true;
+}
+
+/**
+ * @brief Get the lwIP interface of the station
+ * @return Interface, nullptr before WiFi is started
+ */
+static struct netif* stationNetif() {
+    esp_netif_t* handle = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    return handle != nullptr ? static_cast<struct netif*>(esp_netif_get_netif_impl(handle)) : nullptr;
+}
+
+/**
+ * @brief Arguments and result of readDhcpLease()
+ */
+struct DhcpLeaseCall {
+    struct tcpip_api_call_data call;   // Must be first, lwIP passes a pointer to it
+    struct netif* netif;               // Station interface
+    uint32_t seconds;                  // Lease time, 0 if the client is not bound
+};
+
+/**
+ * @brief Reads the lease time of the DHCP client, runs in the tcpip thread
+ * @param call DhcpLeaseCall
+ * @return ERR_OK
+ */
+static err_t readDhcpLeaseInTcpip(struct tcpip_api_call_data* call) {
+    DhcpLeaseCall* lease = reinterpret_cast<DhcpLeaseCall*>(call);
+    struct dhcp* dhcp = netif_dhcp_data(lease->netif);
+    lease->seconds = dhcp != nullptr && dhcp->state == DHCP_STATE_BOUND ? dhcp->offered_t0_lease : 0;
+    return ERR_OK;
+}
+
+/**
+ * @brief Get the lease time granted by the DHCP server
+ * @return Lease time in seconds, 0 if unknown
+ */
+static uint32_t readDhcpLease() {
+    DhcpLeaseCall lease = {};
+    lease.netif = stationNetif();
+    if (lease.netif == nullptr || tcpip_api_call(readDhcpLeaseInTcpip, &lease.call) != ERR_OK) {
+        return 0;
+    }
+    return lease.seconds;
+}
+
+/**
+ * @brief Arguments and result of probeGateway()
+ */
+struct GatewayProbeCall {
+    struct tcpip_api_call_data call;   // Must be first, lwIP passes a pointer to it
+    struct netif* netif;               // Station interface
+    ip4_addr_t gateway;                // Gateway of the reused lease
+    bool clear;                        // Drop ARP entries learned before this connection
+    bool request;                      // Send an ARP request if the gateway is not known yet
+    bool answered;                     // Gateway is in the ARP table
+};
+
+/**
+ * @brief Looks up and requests the gateway in the ARP table, runs in the tcpip thread
+ * @param call GatewayProbeCall
+ * @return ERR_OK
+ */
+static err_t probeGatewayInTcpip(struct tcpip_api_call_data* call) {
+    GatewayProbeCall* probe = reinterpret_cast<GatewayProbeCall*>(call);
+    struct eth_addr* ethAddress;
+    const ip4_addr_t* ipAddress;
+
+    if (probe->clear) {
+        etharp_cleanup_netif(probe->netif);
+    }
+    probe->answered = etharp_find_addr(probe->netif, &probe->gateway, &ethAddress, &ipAddress) >= 0;
+    if (!probe->answered && probe->request) {
+        etharp_request(probe->netif, &probe->gateway);
+    }
+    return ERR_OK;
+}
+
+/**
+ * @brief Checks whether the gateway of the reused lease answered ARP
+ *
+ * @param clear Forget what was learned before, for the first probe of a connection
+ * @param request Send another ARP request if there is no answer yet
+ * @return True if the gateway answered
+ */
+static bool probeGateway(bool clear, bool request) {
+    GatewayProbeCall probe = {};
+    probe.netif = stationNetif();
+    probe.gateway.addr = wifiReusedLease.gateway;
+    probe.clear = clear;
+    probe.request = request;
+    if (probe.netif == nullptr || tcpip_api_call(probeGatewayInTcpip, &probe.call) != ERR_OK) {
+        return false;
+    }
+    return probe.answered;
+}
+
+/**
+ * @brief Switches the connection state machine to a new state
+ *
+ * @param state New state
+ * @param now Current time in milliseconds
+ */
+static void setWiFiState(WiFiConnectionState state, unsigned long now) {
+    wifiState = state;
+    wifiStateSince = now;
+}
+
+/**
+ * @brief Starts connecting to a WiFi network without waiting for the result
+ *
+ * The station connects straight to the given access point and channel,
+ * no further scan is needed. A cached record of the network may supply
+ * the last DHCP lease, it is only reused while it has not expired.
+ *
+ * @param network Index into the credentials table
+ * @param bssid Access point to connect to
+ * @param channel Channel of the access point
+ * @param cached Last successful connection to this network, nullptr if unknown
+ */
+static void beginWiFiAttempt(size_t network, const uint8_t* bssid, uint8_t channel, const StoredWiFiNetwork* cached) {
+    const WiFiCredentials& credentials = configStore.get().networks[network];
+    wifiNetwork = network;
+    wifiLeaseReused = false;
+
+    // Results of earlier attempts must not end this one
+    seenGotIpEvents = gotIpEvents;
+    seenDisconnectEvents = disconnectEvents;
+
     WiFi.disconnect();
     WiFi.mode(WIFI_STA);
     // Set the hostname before connecting
     WiFi.setHostname(OTA_HOSTNAME);
-    WiFi.begin(ssid, password);
-    
-    unsigned long connectionStartTime = millis();
-    
-    // Wait for connection or timeout
-    while (WiFi.status() != WL_CONNECTED) {
-        if (millis() - connectionStartTime > WIFI_CONNECT_TIMEOUT) {
-            Serial.printf("Failed to connect to %s, timeout reached\n", ssid);
-            return false;
+
+#ifdef WIFI_STATIC_IP
+    WiFi.config(IPAddress(WIFI_STATIC_IP), IPAddress(WIFI_STATIC_GATEWAY),
+                IPAddress(WIFI_STATIC_SUBNET), IPAddress(WIFI_STATIC_DNS));
+#else
+    wifiLeaseReused = WIFI_REUSE_DHCP_LEASE && cached != nullptr &&
+                      WiFiCache::leaseValid(*cached, leaseClock, (uint32_t)time(nullptr));
+    if (wifiLeaseReused) {
+        wifiReusedLease = *cached;
+        WiFi.config(IPAddress(cached->ip), IPAddress(cached->gateway),
+                    IPAddress(cached->subnet), IPAddress(cached->dns));
+    } else {
+        // Zero addresses switch DHCP back on
+        WiFi.config(IPAddress(), IPAddress(), IPAddress());
+    }
+#endif
+
+    WiFi.begin(credentials.ssid, credentials.password, channel, bssid);
+}
+
+/**
+ * @brief Ends a connection round in which no network could be reached
+ *
+ * Either the captive portal is started or the next round is scheduled
+ * with exponential backoff.
+ *
+ * @param now Current time in milliseconds
+ */
+static void endWiFiRound(uint32_t now) {
+    if (portalOnFailure) {
+        LOG_WARN("WiFi connection failed. Starting captive portal.");
+        startCaptivePortal();
+        return;
+    }
+
+    wifiRetryDelay = wifiRetryDelay == 0 ? WIFI_RETRY_MIN : min(wifiRetryDelay * 2, (unsigned long)WIFI_RETRY_MAX);
+    LOG_WARN("No WiFi network reachable, retrying in %lu s", wifiRetryDelay / 1000);
+    setWiFiState(WIFI_STATE_RETRY_WAIT, now);
+}
+
+/**
+ * @brief Starts one asynchronous scan for all configured networks
+ *
+ * @param now Current time in milliseconds
+ */
+static void startWiFiScan(uint32_t now) {
+    // A pending connection attempt would make the scan fail
+    WiFi.disconnect();
+    WiFi.mode(WIFI_STA);
+
+    if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) {
+        LOG_ERROR("WiFi scan failed to start");
+        endWiFiRound(now);
+        return;
+    }
+    setWiFiState(WIFI_STATE_SCANNING, now);
+}
+
+/**
+ * @brief Picks the configured networks out of the scan results, strongest first
+ *
+ * @param resultCount Number of scan results
+ */
+static void collectWiFiCandidates(int16_t resultCount) {
+    const DeviceConfig& config = configStore.get();
+    wifiCandidateCount = 0;
+    wifiCandidateIndex = 0;
+
+    for (int16_t i = 0; i < resultCount; i++) {
+        const wifi_ap_record_t* result = static_cast<const wifi_ap_record_t*>(WiFi.getScanInfoByIndex(i));
+        if (result == nullptr) {
+            continue;
         }
-        
-        delay(500);
-        Serial.print(".");
+
+        size_t network = 0;
+        while (network < config.networkCount &&
+               strcmp(config.networks[network].ssid, reinterpret_cast<const char*>(result->ssid)) != 0) {
+            network++;
+        }
+        if (network == config.networkCount) {
+            continue;
+        }
+
+        // Several access points may share an SSID, only the strongest one is kept
+        size_t slot = 0;
+        while (slot < wifiCandidateCount && wifiCandidates[slot].network != network) {
+            slot++;
+        }
+        if (slot == wifiCandidateCount) {
+            wifiCandidateCount++;
+        } else if (wifiCandidates[slot].rssi >= result->rssi) {
+            continue;
+        }
+
+        WiFiCandidate& candidate = wifiCandidates[slot];
+        candidate.network = network;
+        candidate.rssi = result->rssi;
+        candidate.channel = result->primary;
+        memcpy(candidate.bssid, result->bssid, sizeof(candidate.bssid));
     }
-    
-    // Connection successful
-    Serial.println();
-    Serial.printf("Connected to WiFi network: %s\n", ssid);
-    Serial.printf("IP address: %s\n", WiFi.localIP().toString().c_str());
-    Serial.printf("Signal strength (RSSI): %d dBm\n", WiFi.RSSI());
-    
-    return true;
+
+    // Insertion sort, the table holds only a handful of entries
+    for (size_t i = 1; i < wifiCandidateCount; i++) {
+        WiFiCandidate candidate = wifiCandidates[i];
+        size_t j = i;
+        while (j > 0 && wifiCandidates[j - 1].rssi < candidate.rssi) {
+            wifiCandidates[j] = wifiCandidates[j - 1];
+            j--;
+        }
+        wifiCandidates[j] = candidate;
+    }
+
+    LOG_INFO("WiFi scan found %u of %u configured networks",
+                  (unsigned)wifiCandidateCount, (unsigned)config.networkCount);
 }
 
 /**
- * @brief Reads WiFi credentials from config file in SPIFFS
- * 
- * @param ssid Buffer to store the SSID
- * @param password Buffer to store the password
- * @return True if credentials were successfully read from file
+ * @brief Tries the next visible network, or ends the round
+ *
+ * @param now Current time in milliseconds
  */
-bool readWiFiCredentials(char* ssid, char* password) {
-    if (!SPIFFS.begin(true)) {
-        Serial.println("Failed to mount SPIFFS");
-        return false;
+static void tryNextWiFiCandidate(uint32_t now) {
+    if (wifiCandidateIndex >= wifiCandidateCount) {
+        endWiFiRound(now);
+        return;
     }
-    
-    File configFile = SPIFFS.open(WIFI_CONFIG_FILE, "r");
-    
-    if (!configFile) {
-        Serial.println("Failed to open WiFi config file");
-        // List files for debugging
-        printSpiffsFiles();
-        return false;
+
+    const DeviceConfig& config = configStore.get();
+    const WiFiCandidate& candidate = wifiCandidates[wifiCandidateIndex];
+
+    LOG_INFO("Attempting to connect to WiFi network: %s (channel %u, %d dBm)",
+                  config.networks[candidate.network].ssid, candidate.channel, candidate.rssi);
+    wifiFastAttempt = false;
+    // Attempts after a scan always use DHCP, the cached lease may be what made the fast connect fail
+    beginWiFiAttempt(candidate.network, candidate.bssid, candidate.channel, nullptr);
+    setWiFiState(WIFI_STATE_CONNECTING, now);
+}
+
+/**
+ * @brief Starts a connection round
+ *
+ * The network used last is tried first with a fast connect to its cached
+ * access point. If that is not possible or fails, a single scan decides
+ * which configured networks are tried.
+ *
+ * @param now Current time in milliseconds
+ */
+static void startWiFiRound(uint32_t now) {
+    const DeviceConfig& config = configStore.get();
+    if (config.networkCount == 0) {
+        LOG_WARN("No WiFi networks configured");
+        endWiFiRound(now);
+        return;
     }
-    
-    // Check for legacy format (SSID on first line, password on second)
-    String firstLine = configFile.readStringUntil('\n');
-    firstLine.trim();
-    
-    if (firstLine.indexOf(':') == -1) {
-        // Legacy format detected
-        String secondLine = configFile.readStringUntil('\n');
-        secondLine.trim();
-        configFile.close();
-        
-        if (firstLine.isEmpty() || secondLine.isEmpty()) {
-            Serial.println("WiFi config file format is invalid");
-            return false;
+
+    // After boot the first network with a cached access point is preferred
+    StoredWiFiNetwork cached;
+    bool hasCached = false;
+    if (wifiPreferredNetwork >= 0) {
+        hasCached = wifiCache.load(config.networks[wifiPreferredNetwork].ssid, cached);
+    } else {
+        for (size_t i = 0; i < config.networkCount && !hasCached; i++) {
+            hasCached = wifiCache.load(config.networks[i].ssid, cached);
+            if (hasCached) {
+                wifiPreferredNetwork = i;
+            }
         }
-        
-        // Safe copy to buffers
-        if (!copyToBuffer(ssid, firstLine, 32) || 
-            !copyToBuffer(password, secondLine, 64)) {
-            return false;
+    }
+
+    if (!hasCached) {
+        startWiFiScan(now);
+        return;
+    }
+
+    LOG_INFO("Fast connect to WiFi network: %s (channel %u)",
+                  config.networks[wifiPreferredNetwork].ssid, cached.channel);
+    wifiFastAttempt = true;
+    beginWiFiAttempt(wifiPreferredNetwork, cached.bssid, cached.channel, &cached);
+    setWiFiState(WIFI_STATE_CONNECTING, now);
+}
+
+/**
+ * @brief Caches access point, channel and lease of the current connection
+ */
+static void rememberWiFiNetwork() {
+    const DeviceConfig& config = configStore.get();
+    StoredWiFiNetwork record;
+    memset(&record, 0, sizeof(record));
+    snprintf(record.ssid, sizeof(record.ssid), "%s", config.networks[wifiNetwork].ssid);
+
+    const uint8_t* bssid = WiFi.BSSID();
+    if (bssid == nullptr) {
+        return;
+    }
+    memcpy(record.bssid, bssid, sizeof(record.bssid));
+    record.channel = WiFi.channel();
+
+#ifndef WIFI_STATIC_IP
+    record.ip = WiFi.localIP();
+    record.gateway = WiFi.gatewayIP();
+    record.subnet = WiFi.subnetMask();
+    record.dns = WiFi.dnsIP();
+
+    if (wifiLeaseReused) {
+        // No DHCP exchange took place, the lease still ends when it did
+        record.leaseSeconds = wifiReusedLease.leaseSeconds;
+        record.leaseStart = wifiReusedLease.leaseStart;
+        record.leaseClock = wifiReusedLease.leaseClock;
+    } else {
+        record.leaseSeconds = readDhcpLease();
+        record.leaseStart = time(nullptr);
+        record.leaseClock = leaseClock;
+    }
+#endif
+
+    if (!wifiCache.save(record)) {
+        LOG_ERROR("Failed to cache WiFi network");
+    }
+}
+
+/**
+ * @brief Handles a successful connection
+ *
+ * @param now Current time in milliseconds
+ */
+static void onWiFiConnected(uint32_t now) {
+    LOG_INFO("Connected to WiFi network: %s", WiFi.SSID().c_str());
+    LOG_INFO("IP address: %s", WiFi.localIP().toString().c_str());
+    LOG_INFO("Signal strength (RSSI): %d dBm", WiFi.RSSI());
+
+    if (wifiLost) {
+        uint32_t latency = now - wifiLostAt;
+        wifiStats.reconnectCount++;
+        wifiStats.lastReconnectLatency = latency;
+        if (latency > wifiStats.maxReconnectLatency) {
+            wifiStats.maxReconnectLatency = latency;
         }
-        
-        // Log success
-        logCredentials(ssid, password);
-        return true;
+        wifiLost = false;
+        LOG_INFO("WiFi reconnected in %lu ms", (unsigned long)latency);
+    } else if (wifiStats.initialConnectLatency == 0) {
+        wifiStats.initialConnectLatency = now;
+        LOG_INFO("WiFi connected %lu ms after boot", (unsigned long)now);
     }
-    
-    // New format with credentials on each line as SSID:PASSWORD
-    // Reset file position
-    configFile.seek(0);
-    
-    // Read first entry
-    String line = configFile.readStringUntil('\n');
-    configFile.close();
-    
-    line.trim();
-    if (line.isEmpty()) {
-        Serial.println("WiFi config file is empty");
-        return false;
+
+    // Remember access point and lease for a fast connect next time
+    rememberWiFiNetwork();
+    wifiPreferredNetwork = wifiNetwork;
+
+    // Failures after a working connection are retried instead of opening the portal
+    portalOnFailure = false;
+    wifiRetryDelay = 0;
+
+    if (!otaStarted) {
+        initOTA();
+        otaStarted = true;
     }
-    
-    // Extract SSID and password
-    int delimiterPos = line.indexOf(':');
-    if (delimiterPos == -1) {
-        Serial.println("Invalid format in WiFi config file (expected SSID:PASSWORD)");
+
+    setWiFiState(WIFI_STATE_CONNECTED, now);
+}
+
+/**
+ * @brief Handles an IP address on a reused lease
+ *
+ * The address is only taken as working once the gateway answers ARP,
+ * another device may have been given the lease meanwhile or the network
+ * may have been renumbered.
+ *
+ * @param now Current time in milliseconds
+ */
+static void startLeaseCheck(uint32_t now) {
+    LOG_DEBUG("Checking reused lease, gateway %s", IPAddress(wifiReusedLease.gateway).toString().c_str());
+    probeGateway(true, true);
+    wifiArpRequestTime = now;
+    setWiFiState(WIFI_STATE_CHECKING_LEASE, now);
+}
+
+/**
+ * @brief Drops a reused lease the gateway did not confirm and reconnects with DHCP
+ *
+ * @param now Current time in milliseconds
+ */
+static void dropReusedLease(uint32_t now) {
+    const char* ssid = configStore.get().networks[wifiNetwork].ssid;
+    LOG_WARN("Gateway did not answer on the cached lease of %s, using DHCP", ssid);
+    wifiCache.forget(ssid);
+
+    // Same access point, only the address is requested again
+    beginWiFiAttempt(wifiNetwork, wifiReusedLease.bssid, wifiReusedLease.channel, nullptr);
+    setWiFiState(WIFI_STATE_CONNECTING, now);
+}
+
+/**
+ * @brief Get a configured network from the configuration store
+ * 
+ * @param index Zero based index of the network entry
+ * @return Network credentials, nullptr if the entry does not exist
+ */
+const WiFiCredentials* getWiFiNetwork(size_t index) {
+    const DeviceConfig& config = configStore.get();
+    return index < config.networkCount ? &config.networks[index] : nullptr;
+}
+
+/**
+ * @brief Reads the preferred WiFi credentials from the configuration store
+ * 
+ * @param ssid Buffer to store the SSID, WIFI_SSID_MAX bytes
+ * @param password Buffer to store the password, WIFI_PASSWORD_MAX bytes
+ * @return True if credentials are configured
+ */
+bool readWiFiCredentials(char* ssid, char* password) {
+    const WiFiCredentials* network = getWiFiNetwork(0);
+    if (network == nullptr) {
         return false;
     }
     
-    String ssidString = line.substring(0, delimiterPos);
-    String passwordString = line.substring(delimiterPos + 1);
-    
-    // Safe copy to buffers
-    if (!copyToBuffer(ssid, ssidString, 32) || 
-        !copyToBuffer(password, passwordString, 64)) {
-        return false;
-    }
+    snprintf(ssid, WIFI_SSID_MAX, "%s", network->ssid);
+    snprintf(password, WIFI_PASSWORD_MAX, "%s", network->password);
     
     // Log success
     logCredentials(ssid, password);
@@ -189,117 +647,134 @@ bool readWiFiCredentials(char* ssid, char* password) {
 }
 
 /**
- * @brief Connects to WiFi network
+ * @brief Starts connecting to the configured networks
  * 
- * @return True if connection was successful
+ * Returns immediately, checkAndMaintainWiFi() follows up on the result.
  */
-bool connectToWiFi() {
-    if (!SPIFFS.begin(true)) {
-        Serial.println("Failed to mount SPIFFS");
-        updateStatusIndicator(false, false);
-        return false;
-    }
-    
-    File configFile = SPIFFS.open(WIFI_CONFIG_FILE, "r");
-    
-    if (!configFile) {
-        Serial.println("Failed to open WiFi config file");
-        // List files for debugging
-        printSpiffsFiles();
-        updateStatusIndicator(false, false);
-        return false;
-    }
-    
-    bool connected = false;
-    bool legacyFormat = false;
-    char ssid[32];
-    char password[64];
-    
-    // Check first line to detect format
-    String firstLine = configFile.readStringUntil('\n');
-    firstLine.trim();
-    
-    if (firstLine.indexOf(':') == -1) {
-        // Legacy format (SSID on first line, password on second)
-        legacyFormat = true;
-        String secondLine = configFile.readStringUntil('\n');
-        secondLine.trim();
-        
-        if (!firstLine.isEmpty() && !secondLine.isEmpty()) {
-            copyToBuffer(ssid, firstLine, 32);
-            copyToBuffer(password, secondLine, 64);
+void connectToWiFi() {
+    startWiFiRound(clockMillis());
+}
+
+/**
+ * @brief Advances the WiFi connection state machine, never blocks
+ */
+void checkAndMaintainWiFi() {
+    uint32_t now = clockMillis();
+    bool gotIp = takeWiFiEvent(gotIpEvents, seenGotIpEvents);
+    bool disconnected = takeWiFiEvent(disconnectEvents, seenDisconnectEvents);
+    uint8_t reason = lastDisconnectReason;
+    
+    switch (wifiState) {
+        case WIFI_STATE_CONNECTING:
+            if (gotIp && wifiLeaseReused) {
+                startLeaseCheck(now);
+            } else if (gotIp) {
+                onWiFiConnected(now);
+            } else if ((disconnected && reason != WIFI_REASON_ASSOC_LEAVE) ||
+                       now - wifiStateSince > (wifiFastAttempt ? WIFI_FAST_CONNECT_TIMEOUT : WIFI_CONNECT_TIMEOUT)) {
+                // Leaving the previous network is part of every attempt and ignored above
+                if (disconnected) {
+                    LOG_WARN("Failed to connect to WiFi network (reason %u)", reason);
+                } else {
+                    LOG_WARN("WiFi connection attempt timed out");
+                }
+                if (wifiFastAttempt) {
+                    // The access point may have moved, or another network is in range now
+                    startWiFiScan(now);
+                } else {
+                    wifiCandidateIndex++;
+                    tryNextWiFiCandidate(now);
+                }
+            }
+            break;
             
-            connected = attemptWiFiConnection(ssid, password);
+        case WIFI_STATE_CHECKING_LEASE: {
+            bool request = now - wifiArpRequestTime >= WIFI_LEASE_CHECK_INTERVAL;
+            if (request) {
+                wifiArpRequestTime = now;
+            }
+            if (probeGateway(false, request)) {
+                onWiFiConnected(now);
+            } else if (disconnected) {
+                LOG_WARN("Failed to connect to WiFi network (reason %u)", reason);
+                startWiFiScan(now);
+            } else if (now - wifiStateSince > WIFI_LEASE_CHECK_TIMEOUT) {
+                dropReusedLease(now);
+            }
+            break;
         }
-    } else {
-        // Reset file position to start
-        configFile.seek(0);
-        
-        // Try each network configuration until successful
-        while (!connected && configFile.available()) {
-            String line = configFile.readStringUntil('\n');
-            line.trim();
-            
-            if (line.isEmpty()) continue;
-            
-            int delimiterPos = line.indexOf(':');
-            if (delimiterPos == -1) {
-                Serial.println("Invalid format in WiFi config (expected SSID:PASSWORD)");
-                continue;
+
+        case WIFI_STATE_CONNECTED:
+            if (disconnected) {
+                LOG_WARN("WiFi connection lost (reason %u), reconnecting...", reason);
+                if (!wifiLost) {
+                    wifiLost = true;
+                    wifiLostAt = now;
+                }
+                // Start with the network that just worked
+                startWiFiRound(now);
             }
+            break;
             
-            String ssidString = line.substring(0, delimiterPos);
-            String passwordString = line.substring(delimiterPos + 1);
-            
-            copyToBuffer(ssid, ssidString, 32);
-            copyToBuffer(password, passwordString, 64);
+        case WIFI_STATE_SCANNING: {
+            int16_t resultCount = WiFi.scanComplete();
+            if (resultCount == WIFI_SCAN_RUNNING && now - wifiStateSince < WIFI_SCAN_TIMEOUT) {
+                break;
+            }
+            if (resultCount >= 0) {
+                collectWiFiCandidates(resultCount);
+                WiFi.scanDelete();
+                tryNextWiFiCandidate(now);
+            } else {
+                LOG_ERROR("WiFi scan failed");
+                WiFi.scanDelete();
+                endWiFiRound(now);
+            }
+            break;
+        }
             
-            // Log the network we're trying
-            Serial.printf("Trying WiFi configuration: %s\n", ssid);
+        case WIFI_STATE_RETRY_WAIT:
+            if (now - wifiStateSince >= wifiRetryDelay) {
+                connectToWiFi();
+            }
+            break;
             
-            // Attempt connection with this configuration
-            connected = attemptWiFiConnection(ssid, password);
-        }
+        default:
+            break;
     }
-    
-    configFile.close();
-    
-    // Update status - WiFi connected (or not), but counter status stays the same
-    extern bool isLastRequestSuccessful();
-    updateStatusIndicator(connected, isLastRequestSuccessful());
-    
-    return connected;
 }
 
 /**
- * @brief Check WiFi connection and reconnect if needed
+ * @brief Get the current state of the WiFi connection state machine
+ * @return Connection state
  */
-void checkAndMaintainWiFi() {
-    static bool prevWifiConnected = false;
-    bool currentlyConnected = (WiFi.status() == WL_CONNECTED);
-    
-    // Only take action if connection state has changed
-    if (currentlyConnected != prevWifiConnected) {
-        prevWifiConnected = currentlyConnected;
-        
-        if (!currentlyConnected) {
-            Serial.println("WiFi connection lost, attempting to reconnect...");
-            connectToWiFi();
-        } else {
-            // WiFi connection was restored
-            extern bool isLastRequestSuccessful();
-            updateStatusIndicator(true, isLastRequestSuccessful());
-        }
-    }
+WiFiConnectionState getWiFiState() {
+    return wifiState;
+}
+
+/**
+ * @brief Get WiFi connection statistics
+ * @return Statistics since boot
+ */
+WiFiConnectionStats getWiFiStats() {
+    return wifiStats;
 }
 
 /**
  * @brief Initialize WiFi connection
  */
 void initWiFi() {
-    if (!connectToWiFi()) {
-        Serial.println("Continuing without WiFi connection");
+    // Connection results arrive as events, the state machine does all retries
+    WiFi.onEvent(onWiFiEvent);
+    WiFi.setAutoReconnect(false);
+
+    // time() starts over after a power loss, leases stored before are of unknown age
+    esp_reset_reason_t resetReason = esp_reset_reason();
+    if (resetReason == ESP_RST_POWERON || resetReason == ESP_RST_BROWNOUT || leaseClock == 0) {
+        leaseClock = esp_random() | 1;
     }
+
+    connectToWiFi();
 }
 
 /**
@@ -308,11 +783,11 @@ void initWiFi() {
 void initOTA() {
     // Configure OTA hostname
     ArduinoOTA.setHostname(OTA_HOSTNAME);
-    Serial.printf("OTA hostname set to: %s\n", OTA_HOSTNAME);
+    LOG_INFO("OTA hostname set to: %s", OTA_HOSTNAME);
     
     // Set password for OTA updates
     ArduinoOTA.setPassword(OTA_PASSWORD);
-    Serial.printf("OTA password configured (password: %s)\n", OTA_PASSWORD);
+    LOG_INFO("OTA password configured");
     
     // OTA callbacks
     ArduinoOTA.onStart([]() {
@@ -324,36 +799,41 @@ void initOTA() {
             // Unmount SPIFFS to avoid data corruption
             SPIFFS.end();
         }
-        Serial.println("OTA update started: " + type);
+        LOG_INFO("OTA update started: %s", type.c_str());
     });
     
     ArduinoOTA.onEnd([]() {
-        Serial.println("\nOTA update complete");
+        LOG_INFO("OTA update complete");
     });
     
     ArduinoOTA.onProgress([](unsigned int progress, unsigned int total) {
         unsigned int percentage = (progress / (total / 100));
-        Serial.printf("OTA Progress: %u%%\r", percentage);
+        static unsigned int reportedPercentage = 0;
+        if (percentage / 10 != reportedPercentage / 10) {
+            LOG_INFO("OTA progress: %u%%", percentage);
+        }
+        reportedPercentage = percentage;
     });
     
     ArduinoOTA.onError([](ota_error_t error) {
-        Serial.printf("OTA Error[%u]: ", error);
+        const char* reason = "Unknown";
         if (error == OTA_AUTH_ERROR) {
-            Serial.println("Auth Failed");
+            reason = "Auth Failed";
         } else if (error == OTA_BEGIN_ERROR) {
-            Serial.println("Begin Failed");
+            reason = "Begin Failed";
         } else if (error == OTA_CONNECT_ERROR) {
-            Serial.println("Connect Failed");
+            reason = "Connect Failed";
         } else if (error == OTA_RECEIVE_ERROR) {
-            Serial.println("Receive Failed");
+            reason = "Receive Failed";
         } else if (error == OTA_END_ERROR) {
-            Serial.println("End Failed");
+            reason = "End Failed";
         }
+        LOG_ERROR("OTA Error[%u]: %s", error, reason);
     });
     
     // Begin OTA service
     ArduinoOTA.begin();
-    Serial.println("OTA initialized, ready for update");
+    LOG_INFO("OTA initialized, ready for update");
 }
 
 /**
@@ -364,26 +844,157 @@ void handleOTA() {
 }
 
 /**
- * @brief Writes new WiFi credentials to the config file
+ * @brief Stores new WiFi credentials as the preferred network
  */
 bool writeWiFiCredentials(const char* ssid, const char* password) {
-    if (!SPIFFS.begin(true)) {
-        Serial.println("Failed to mount SPIFFS");
+    if (!configStore.addNetwork(ssid, password)) {
+        LOG_ERROR("Failed to store WiFi credentials");
         return false;
     }
     
-    File configFile = SPIFFS.open(WIFI_CONFIG_FILE, "w");
-    if (!configFile) {
-        Serial.println("Failed to open WiFi config file for writing");
-        return false;
+    // Network indices changed, the new network is tried first
+    wifiPreferredNetwork = -1;
+    
+    LOG_INFO("WiFi credentials stored");
+    return true;
+}
+
+/**
+ * @brief Portal task, serves DNS and HTTP requests until asked to stop
+ * 
+ * Runs next to the network task, so portal traffic never waits for
+ * connection handling or API requests and vice versa.
+ * 
+ * @param parameter Unused task parameter
+ */
+static void portalTask(void* parameter) {
+    while (!portalStopRequested.load(std::memory_order_acquire)) {
+        dnsServer.processNextRequest();
+        webServer.handleClient();
+        vTaskDelay(pdMS_TO_TICKS(PORTAL_TASK_INTERVAL));
     }
     
-    // Write in the format SSID:PASSWORD
-    configFile.printf("%s:%s\n", ssid, password);
-    configFile.close();
+    webServer.stop();
+    dnsServer.stop();
+    portalTaskRunning.store(false, std::memory_order_release);
+    vTaskDelete(nullptr);
+}
+
+/**
+ * @brief Publish the networks found by a portal scan to the portal task
+ * 
+ * @param networks Networks sorted by signal strength
+ * @param count Number of networks
+ */
+static void publishPortalNetworks(const PortalNetwork* networks, size_t count) {
+    uint32_t sequence = portalNetworksSequence.load(std::memory_order_relaxed);
     
-    Serial.println("WiFi credentials written to config file");
-    return true;
+    portalNetworksSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    memcpy(portalNetworks, networks, count * sizeof(PortalNetwork));
+    portalNetworkCount = count;
+    
+    portalNetworksSequence.store(sequence + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Read a consistent copy of the cached portal scan results
+ * 
+ * @param networks Buffer for PORTAL_NETWORKS_MAX networks
+ * @return Number of networks copied
+ */
+static size_t readPortalNetworks(PortalNetwork* networks) {
+    uint32_t before;
+    uint32_t after;
+    size_t count;
+    
+    do {
+        before = portalNetworksSequence.load(std::memory_order_acquire);
+        count = portalNetworkCount;
+        memcpy(networks, portalNetworks, count * sizeof(PortalNetwork));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = portalNetworksSequence.load(std::memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+    
+    return count;
+}
+
+/**
+ * @brief Collect the results of a finished portal scan, strongest first
+ * 
+ * @param resultCount Number of scan results
+ */
+static void collectPortalNetworks(int16_t resultCount) {
+    PortalNetwork networks[PORTAL_NETWORKS_MAX];
+    size_t count = 0;
+    
+    for (int16_t i = 0; i < resultCount; i++) {
+        const wifi_ap_record_t* result = static_cast<const wifi_ap_record_t*>(WiFi.getScanInfoByIndex(i));
+        if (result == nullptr || result->ssid[0] == '\0') {
+            continue;
+        }
+        const char* ssid = reinterpret_cast<const char*>(result->ssid);
+        
+        // Several access points may share an SSID, only the strongest one is listed
+        size_t slot = 0;
+        while (slot < count && strcmp(networks[slot].ssid, ssid) != 0) {
+            slot++;
+        }
+        if (slot == count) {
+            if (count == PORTAL_NETWORKS_MAX) {
+                // Replace the weakest network if this one is stronger
+                slot = count - 1;
+                if (networks[slot].rssi >= result->rssi) {
+                    continue;
+                }
+            } else {
+                count++;
+            }
+        } else if (networks[slot].rssi >= result->rssi) {
+            continue;
+        }
+        
+        snprintf(networks[slot].ssid, sizeof(networks[slot].ssid), "%s", ssid);
+        networks[slot].rssi = result->rssi;
+        networks[slot].open = result->authmode == WIFI_AUTH_OPEN;
+        
+        // Keep the list sorted so the weakest network is always last
+        while (slot > 0 && networks[slot - 1].rssi < networks[slot].rssi) {
+            PortalNetwork swap = networks[slot - 1];
+            networks[slot - 1] = networks[slot];
+            networks[slot] = swap;
+            slot--;
+        }
+    }
+    
+    publishPortalNetworks(networks, count);
+}
+
+/**
+ * @brief Keep the cached network list of the portal fresh with background scans
+ * 
+ * @param now Current time in milliseconds
+ */
+static void servicePortalScan(uint32_t now) {
+    if (portalScanRunning) {
+        int16_t resultCount = WiFi.scanComplete();
+        if (resultCount == WIFI_SCAN_RUNNING && now - portalScanTime < WIFI_SCAN_TIMEOUT) {
+            return;
+        }
+        if (resultCount >= 0) {
+            collectPortalNetworks(resultCount);
+        }
+        WiFi.scanDelete();
+        portalScanRunning = false;
+        portalScanTime = now;
+        return;
+    }
+    
+    if (portalScanTime == 0 || now - portalScanTime >= PORTAL_SCAN_INTERVAL) {
+        portalScanRunning = WiFi.scanNetworks(true) != WIFI_SCAN_FAILED;
+        portalScanTime = now;
+    }
 }
 
 /**
@@ -392,45 +1003,63 @@ bool writeWiFiCredentials(const char* ssid, const char* password) {
 void startCaptivePortal() {
     // Stop any existing WiFi connection
     WiFi.disconnect();
-    delay(100);
     
-    // Set up access point
-    WiFi.mode(WIFI_AP);
+    // Set up access point, the station interface stays up for scanning
+    WiFi.mode(WIFI_AP_STA);
     WiFi.softAPConfig(IPAddress(AP_IP_ADDRESS), IPAddress(AP_IP_ADDRESS), IPAddress(255, 255, 255, 0));
     
     // Start the access point with SSID and password
     if (WiFi.softAP(AP_SSID, AP_PASSWORD)) {
-        Serial.println("Access Point started");
-        Serial.printf("SSID: %s\n", AP_SSID);
-        Serial.printf("Password: %s\n", AP_PASSWORD);
-        Serial.printf("AP IP address: %s\n", WiFi.softAPIP().toString().c_str());
+        LOG_INFO("Access Point started");
+        LOG_INFO("SSID: %s", AP_SSID);
+        LOG_INFO("Password: %s", AP_PASSWORD);
+        LOG_INFO("AP IP address: %s", WiFi.softAPIP().toString().c_str());
     } else {
-        Serial.println("Failed to start Access Point");
+        LOG_ERROR("Failed to start Access Point");
         return;
     }
     
     // Start DNS server for captive portal
     dnsServer.start(DNS_PORT, "*", IPAddress(AP_IP_ADDRESS));
     
-    // Set up web server routes
-    webServer.on("/", HTTP_GET, handleRoot);
-    webServer.on("/save", HTTP_POST, handleSave);
-    webServer.onNotFound(handleNotFound);
+    // Set up web server routes once, the server keeps them across restarts
+    static bool routesRegistered = false;
+    if (!routesRegistered) {
+        webServer.on("/", HTTP_GET, handleRoot);
+        webServer.on("/style.css", HTTP_GET, handleStyle);
+        webServer.on("/save", HTTP_POST, handleSave);
+        webServer.onNotFound(handleNotFound);
+        routesRegistered = true;
+    }
     
     // Start web server
     webServer.begin();
-    Serial.println("Captive portal started");
     
     // Set the start time for timeout tracking
-    portalStartTime = millis();
+    portalStartTime = clockMillis();
     captivePortalActive = true;
+    portalClosing.store(false, std::memory_order_relaxed);
+    portalStopRequested.store(false, std::memory_order_relaxed);
+    portalScanRunning = false;
+    portalScanTime = 0;
+    setWiFiState(WIFI_STATE_PORTAL, portalStartTime);
+    
+    // Requests are served by their own task from now on
+    portalTaskRunning.store(true, std::memory_order_release);
+    xTaskCreatePinnedToCore(portalTask, "portal", PORTAL_TASK_STACK_SIZE, nullptr,
+                            PORTAL_TASK_PRIORITY, nullptr, PORTAL_TASK_CORE);
+    LOG_INFO("Captive portal started");
 
-    // Visual indicator that we're in AP mode
-    updateStatusIndicator(false, false);
+    // The render task shows the disconnected indicator while in AP mode
 }
 
 /**
  * @brief Handle captive portal in the main loop
+ * 
+ * Requests are served by the portal task, this only runs the background
+ * scan, watches for timeout and saved credentials, and shuts the portal
+ * down.
+ * 
  * @return True if portal is still active, false if it was closed
  */
 bool handleCaptivePortal() {
@@ -438,81 +1067,129 @@ bool handleCaptivePortal() {
         return false;
     }
     
-    // Check for portal timeout
-    if (millis() - portalStartTime > PORTAL_TIMEOUT_MS) {
-        Serial.println("Captive portal timeout reached");
-        captivePortalActive = false;
-        
-        // Try to connect with any existing credentials
-        if (connectToWiFi()) {
-            Serial.println("Connected to WiFi after portal timeout");
+    uint32_t now = clockMillis();
+    
+    if (!portalStopRequested.load(std::memory_order_relaxed)) {
+        if (portalClosing.load(std::memory_order_acquire) && now - portalCloseTime >= PORTAL_CLOSE_DELAY) {
+            // Close the portal once the client got the save page, then try the new
+            // credentials and reopen the portal if that fails
+            portalOnFailure = true;
+            portalStopRequested.store(true, std::memory_order_release);
+        } else if (now - portalStartTime > PORTAL_TIMEOUT_MS) {
+            // Keep trying any existing credentials in the background
+            LOG_WARN("Captive portal timeout reached");
+            portalOnFailure = false;
+            portalStopRequested.store(true, std::memory_order_release);
         } else {
-            Serial.println("No WiFi connection after portal timeout");
+            servicePortalScan(now);
         }
-        
-        return false;
+        return true;
     }
     
-    // Process DNS and web server requests
-    dnsServer.processNextRequest();
-    webServer.handleClient();
+    // Wait until the portal task has stopped the servers
+    if (portalTaskRunning.load(std::memory_order_acquire)) {
+        return true;
+    }
     
-    return true;
+    if (portalScanRunning) {
+        WiFi.scanDelete();
+        portalScanRunning = false;
+    }
+    captivePortalActive = false;
+    WiFi.softAPdisconnect(true);
+    connectToWiFi();
+    return false;
+}
+
+/**
+ * @brief Send a gzip-compressed asset straight from flash
+ * 
+ * @param data Compressed asset
+ * @param length Size of the compressed asset
+ * @param contentType Content type of the uncompressed asset
+ * @param maxAge Seconds the client may cache the asset, 0 for no caching
+ */
+static void sendGzipAsset(const uint8_t* data, size_t length, const char* contentType, unsigned long maxAge) {
+    char cacheControl[32];
+    if (maxAge > 0) {
+        snprintf(cacheControl, sizeof(cacheControl), "max-age=%lu", maxAge);
+    } else {
+        snprintf(cacheControl, sizeof(cacheControl), "no-store");
+    }
+    
+    webServer.sendHeader("Content-Encoding", "gzip");
+    webServer.sendHeader("Cache-Control", cacheControl);
+    webServer.send_P(200, contentType, reinterpret_cast<const char*>(data), length);
+}
+
+/**
+ * @brief Write the cached scan results as a list of selectable networks
+ * 
+ * @param writer Writer of the page
+ */
+static void writeNetworkList(TemplateWriter& writer) {
+    PortalNetwork networks[PORTAL_NETWORKS_MAX];
+    size_t count = readPortalNetworks(networks);
+    
+    if (count == 0) {
+        writer.write("<p class='hint'>No networks found yet, reload the page in a few seconds.</p>");
+        return;
+    }
+    
+    char signal[24];
+    for (size_t i = 0; i < count; i++) {
+        writer.write("<label class='network'><input type='radio' name='pick' value='");
+        writer.writeEscaped(networks[i].ssid);
+        writer.write("' onclick='pick(this.value)'><span>");
+        writer.writeEscaped(networks[i].ssid);
+        snprintf(signal, sizeof(signal), "</span><small>%s%d dBm</small></label>",
+                 networks[i].open ? "open, " : "", networks[i].rssi);
+        writer.write(signal);
+    }
+}
+
+/**
+ * @brief Fill in the placeholders of the root page
+ * 
+ * @param name Placeholder name
+ * @param writer Writer of the page
+ * @param context Unused
+ */
+static void writeRootValue(const char* name, TemplateWriter& writer, void* context) {
+    if (strcmp(name, "networks") == 0) {
+        writeNetworkList(writer);
+        return;
+    }
+    
+    // Prefill the form with the preferred network, if there is one
+    const WiFiCredentials* network = getWiFiNetwork(0);
+    if (network == nullptr) {
+        return;
+    }
+    
+    if (strcmp(name, "ssid") == 0) {
+        writer.writeEscaped(network->ssid);
+    } else if (strcmp(name, "password") == 0) {
+        writer.writeEscaped(network->password);
+    }
 }
 
 /**
  * @brief Handle root page of captive portal
  */
 void handleRoot() {
-    // Read existing WiFi credentials if available
-    char ssid[32] = "";
-    char password[64] = "";
-    bool hasExistingConfig = readWiFiCredentials(ssid, password);
-    
-    // Create the configuration web page
-    String html = "<!DOCTYPE html><html><head>"
-                  "<title>ESP WiFi Setup</title>"
-                  "<meta name='viewport' content='width=device-width, initial-scale=1'>"
-                  "<style>"
-                  "body{font-family:Arial,sans-serif;margin:0;padding:20px;background:#f5f5f5;color:#333;line-height:1.6;}"
-                  "h1{color:#0066cc;text-align:center;margin-bottom:30px;}"
-                  ".container{max-width:400px;margin:0 auto;background:white;padding:20px;border-radius:8px;box-shadow:0 2px 10px rgba(0,0,0,0.1);}"
-                  ".form-group{margin-bottom:15px;}"
-                  "label{display:block;margin-bottom:5px;font-weight:bold;}"
-                  "input[type=text],input[type=password]{width:100%;padding:10px;border:1px solid #ddd;border-radius:4px;box-sizing:border-box;}"
-                  "button{background:#0066cc;color:white;border:none;padding:12px;width:100%;border-radius:4px;cursor:pointer;font-size:16px;}"
-                  "button:hover{background:#0055aa;}"
-                  ".footer{text-align:center;margin-top:20px;font-size:12px;color:#666;}"
-                  "</style>"
-                  "</head><body>"
-                  "<div class='container'>"
-                  "<h1>Instagram Counter WiFi Setup</h1>"
-                  "<form method='post' action='/save'>"
-                  "<div class='form-group'>"
-                  "<label for='ssid'>WiFi Network Name (SSID):</label>"
-                  "<input type='text' id='ssid' name='ssid' value='";
-    
-    // Add existing SSID if available
-    html += hasExistingConfig ? ssid : "";
-    
-    html += "' required>"
-            "</div>"
-            "<div class='form-group'>"
-            "<label for='password'>WiFi Password:</label>"
-            "<input type='password' id='password' name='password' value='";
-    
-    // Add existing password if available
-    html += hasExistingConfig ? password : "";
-    
-    html += "' required>"
-            "</div>"
-            "<button type='submit'>Save Configuration</button>"
-            "</form>"
-            "<div class='footer'>After saving, the device will attempt to connect to your WiFi network.</div>"
-            "</div>"
-            "</body></html>";
-    
-    webServer.send(200, "text/html", html);
+    // Streamed in chunks, the page is never assembled in memory
+    TemplateWriter writer(webServer);
+    writer.begin(200, "text/html");
+    writer.render(portal_index_html, writeRootValue, nullptr);
+    writer.end();
+}
+
+/**
+ * @brief Handle the stylesheet shared by all portal pages
+ */
+void handleStyle() {
+    sendGzipAsset(portal_style_css_gz, portal_style_css_gz_len, portal_style_css_type, PORTAL_ASSET_MAX_AGE);
 }
 
 /**
@@ -528,78 +1205,29 @@ void handleSave() {
         return;
     }
     
-    Serial.println("Received new WiFi credentials:");
-    Serial.printf("SSID: %s\n", newSsid.c_str());
-    Serial.println("Password: [hidden]");
+    LOG_INFO("Received new WiFi credentials for SSID: %s", newSsid.c_str());
     
     // Convert String to char arrays
-    char ssidBuffer[32] = {0};
-    char passwordBuffer[64] = {0};
+    char ssidBuffer[WIFI_SSID_MAX] = {0};
+    char passwordBuffer[WIFI_PASSWORD_MAX] = {0};
     
-    copyToBuffer(ssidBuffer, newSsid, 32);
-    copyToBuffer(passwordBuffer, newPassword, 64);
+    copyToBuffer(ssidBuffer, newSsid, sizeof(ssidBuffer));
+    copyToBuffer(passwordBuffer, newPassword, sizeof(passwordBuffer));
     
-    // Save to config file
+    // Save as the preferred network
     bool saved = writeWiFiCredentials(ssidBuffer, passwordBuffer);
     
     // Send response
-    String html = "<!DOCTYPE html><html><head>"
-                  "<title>WiFi Configuration</title>"
-                  "<meta name='viewport' content='width=device-width, initial-scale=1'>"
-                  "<style>"
-                  "body{font-family:Arial,sans-serif;margin:0;padding:20px;background:#f5f5f5;color:#333;line-height:1.6;}"
-                  ".container{max-width:400px;margin:0 auto;background:white;padding:20px;border-radius:8px;box-shadow:0 2px 10px rgba(0,0,0,0.1);text-align:center;}"
-                  "h1{color:";
-    
-    // Change title color based on result
-    html += saved ? "#4CAF50" : "#f44336";
-    
-    html += ";}"
-            "</style>"
-            "</head><body>"
-            "<div class='container'>"
-            "<h1>";
-            
     if (saved) {
-        html += "Configuration Saved!";
+        sendGzipAsset(portal_saved_html_gz, portal_saved_html_gz_len, portal_saved_html_type, 0);
     } else {
-        html += "Error Saving Configuration";
+        sendGzipAsset(portal_failed_html_gz, portal_failed_html_gz_len, portal_failed_html_type, 0);
     }
     
-    html += "</h1>"
-            "<p>";
-            
+    // If saved successfully, connect once the client had time to get the response
     if (saved) {
-        html += "WiFi credentials have been saved. The device will now attempt to connect to your network.";
-    } else {
-        html += "There was a problem saving your WiFi credentials. Please try again.";
-    }
-    
-    html += "</p>"
-            "</div>"
-            "</body></html>";
-    
-    webServer.send(200, "text/html", html);
-    
-    // If saved successfully, try to connect
-    if (saved) {
-        // Wait a bit to make sure the client gets the response
-        delay(2000);
-        
-        // Stop captive portal
-        captivePortalActive = false;
-        webServer.stop();
-        WiFi.softAPdisconnect(true);
-        dnsServer.stop();
-        
-        // Try to connect with new credentials
-        if (attemptWiFiConnection(ssidBuffer, passwordBuffer)) {
-            Serial.println("Successfully connected with new credentials");
-        } else {
-            Serial.println("Failed to connect with new credentials");
-            // Restart captive portal if connection fails
-            startCaptivePortal();
-        }
+        portalCloseTime = clockMillis();
+        portalClosing.store(true, std::memory_order_release);
     }
 }
 
@@ -618,13 +1246,7 @@ void handleNotFound() {
  * @brief Initialize WiFi with fallback to captive portal
  */
 void initWiFiWithCaptivePortal() {
-    // First try to connect with saved credentials
-    if (connectToWiFi()) {
-        Serial.println("Connected to WiFi with saved credentials");
-        initOTA();
-    } else {
-        // If connection fails, start the captive portal
-        Serial.println("WiFi connection failed. Starting captive portal.");
-        startCaptivePortal();
-    }
+    // Try the saved credentials first, the portal starts if none of them work
+    portalOnFailure = true;
+    initWiFi();
 }
\ No newline at end of file
@@ -7,11 +7,24 @@
 #include <ArduinoOTA.h>  // Include the OTA library
 #include <WebServer.h>   // For captive portal web server
 #include <DNSServer.h>   // For captive DNS server
-#include "matrix_config.h" // For access to the updateStatusIndicator function
+#include "config_store.h"
+#include "wifi_cache.h"
 
 // WiFi settings
-#define WIFI_CONFIG_FILE "/wifi_config.txt"    // Path to WiFi config file in SPIFFS
 #define WIFI_CONNECT_TIMEOUT 10000             // WiFi connection timeout in milliseconds
+#define WIFI_SCAN_TIMEOUT 15000                // Give up on a scan that did not complete
+#define WIFI_RETRY_MIN 5000                    // First delay before retrying all networks
+#define WIFI_RETRY_MAX 300000                  // Longest delay before retrying all networks
+#define WIFI_FAST_CONNECT_TIMEOUT 4000         // Timeout of a directed connect to a cached access point
+#define WIFI_REUSE_DHCP_LEASE 1                // Skip DHCP on fast connects by reusing the cached lease
+#define WIFI_LEASE_CHECK_TIMEOUT 1500          // Time the gateway has to answer ARP on a reused lease
+#define WIFI_LEASE_CHECK_INTERVAL 250          // Time between two ARP requests to the gateway
+
+// Optional static IP configuration, replaces DHCP and the cached lease when defined
+// #define WIFI_STATIC_IP 192, 168, 1, 50
+// #define WIFI_STATIC_GATEWAY 192, 168, 1, 1
+// #define WIFI_STATIC_SUBNET 255, 255, 255, 0
+// #define WIFI_STATIC_DNS 192, 168, 1, 1
 
 // AP Mode settings
 #define AP_SSID "InstagramCounterConfig"             // AP mode SSID
@@ -20,11 +33,44 @@
 #define DNS_PORT 53                            // Standard DNS port
 #define WEB_SERVER_PORT 80                     // Standard HTTP port
 #define PORTAL_TIMEOUT_MS 300000               // 5 minutes timeout for portal mode
+#define PORTAL_CLOSE_DELAY 2000                // Time for the save page to reach the client
+#define PORTAL_ASSET_MAX_AGE 86400             // Seconds clients may cache static portal assets
+#define PORTAL_SCAN_INTERVAL 30000             // Time between background scans while the portal is open
+#define PORTAL_NETWORKS_MAX 12                 // Networks listed on the portal page
+
+// Portal task, serves DNS and HTTP while the network task keeps scanning
+#define PORTAL_TASK_CORE 0                     // Same core as the network task
+#define PORTAL_TASK_PRIORITY 1                 // Same priority as the network task
+#define PORTAL_TASK_STACK_SIZE 6144            // Stack size in bytes
+#define PORTAL_TASK_INTERVAL 5                 // Delay between request polls in milliseconds
 
 // OTA settings
 #define OTA_HOSTNAME "insta_counter"
 #define OTA_PASSWORD "123456789"       // Make sure this matches platformio.ini upload_flags auth
 
+/**
+ * @brief States of the WiFi connection state machine
+ */
+enum WiFiConnectionState {
+    WIFI_STATE_IDLE,           // Not started yet
+    WIFI_STATE_SCANNING,       // Scanning for the configured networks
+    WIFI_STATE_CONNECTING,     // Associating with a network and waiting for an IP address
+    WIFI_STATE_CHECKING_LEASE, // Reused lease, waiting for the gateway to answer ARP
+    WIFI_STATE_CONNECTED,      // Station has an IP address
+    WIFI_STATE_RETRY_WAIT,     // No network reachable, waiting before the next round
+    WIFI_STATE_PORTAL          // Captive portal is active
+};
+
+/**
+ * @brief WiFi connection statistics since boot
+ */
+struct WiFiConnectionStats {
+    uint32_t reconnectCount;               // Reconnects after a lost connection
+    unsigned long lastReconnectLatency;    // Connection loss to IP address, last reconnect (ms)
+    unsigned long maxReconnectLatency;     // Longest reconnect latency (ms)
+    unsigned long initialConnectLatency;   // Boot to first IP address (ms), 0 if not connected yet
+};
+
 /**
  * @brief Lists all files in SPIFFS root directory
  */
@@ -41,29 +87,56 @@ void printSpiffsFiles();
 bool copyToBuffer(char* dest, String source, size_t maxSize);
 
 /**
- * @brief Logs credential information for debugging
+ * @brief Logs credential information for debugging, never the password itself
  */
 void logCredentials(const char* ssid, const char* password);
 
 /**
- * @brief Reads WiFi credentials from config file in SPIFFS
- * @param ssid Buffer to store the SSID
- * @param password Buffer to store the password
- * @return True if credentials were successfully read from file
+ * @brief Get a configured network from the configuration store
+ * @param index Zero based index of the network entry
+ * @return Network credentials, nullptr if the entry does not exist
+ */
+const WiFiCredentials* getWiFiNetwork(size_t index);
+
+/**
+ * @brief Reads the preferred WiFi credentials from the configuration store
+ * @param ssid Buffer to store the SSID, WIFI_SSID_MAX bytes
+ * @param password Buffer to store the password, WIFI_PASSWORD_MAX bytes
+ * @return True if credentials are configured
  */
 bool readWiFiCredentials(char* ssid, char* password);
 
 /**
- * @brief Connects to WiFi network
- * @return True if connection was successful
+ * @brief Starts connecting to the configured networks
+ * 
+ * The network used last gets a fast connect to its cached access point.
+ * Otherwise one asynchronous scan finds the configured networks in range,
+ * which are tried strongest first. Returns immediately,
+ * checkAndMaintainWiFi() follows up on the result.
  */
-bool connectToWiFi();
+void connectToWiFi();
 
 /**
- * @brief Check WiFi connection and reconnect if needed
+ * @brief Advances the WiFi connection state machine, never blocks
+ * 
+ * Acts on the connect and disconnect events collected since the last
+ * call: moves on to the next network after a failure or timeout, and
+ * reconnects with exponential backoff after the connection was lost.
  */
 void checkAndMaintainWiFi();
 
+/**
+ * @brief Get the current state of the WiFi connection state machine
+ * @return Connection state
+ */
+WiFiConnectionState getWiFiState();
+
+/**
+ * @brief Get WiFi connection statistics
+ * @return Statistics since boot
+ */
+WiFiConnectionStats getWiFiStats();
+
 /**
  * @brief Initialize OTA update functionality
  */
@@ -76,25 +149,33 @@ void handleOTA();
 
 /**
  * @brief Initialize WiFi connection
+ * 
+ * Registers the WiFi event handler and starts connecting, without
+ * waiting for the result.
  */
 void initWiFi();
 
 /**
  * @brief Set up a captive portal for WiFi configuration
  * 
- * Creates an access point and hosts a simple web server
- * allowing users to configure WiFi credentials
+ * Creates an access point and starts the portal task, which hosts a
+ * simple web server allowing users to configure WiFi credentials
  */
 void startCaptivePortal();
 
 /**
- * @brief Process captive portal requests in the main loop
+ * @brief Maintain the captive portal from the network task
+ * 
+ * Refreshes the cached network list with background scans and closes
+ * the portal after a timeout or once new credentials were saved.
+ * Requests are served by the portal task.
+ * 
  * @return True if the portal is active, False if it's been closed
  */
 bool handleCaptivePortal();
 
 /**
- * @brief Writes new WiFi credentials to the config file
+ * @brief Stores new WiFi credentials as the preferred network
  * @param ssid New SSID to write
  * @param password New password to write
  * @return True if credentials were successfully written
@@ -105,7 +186,8 @@ bool writeWiFiCredentials(const char* ssid, const char* password);
  * @brief Initialize WiFi with fallback to captive portal
  * 
  * Tries to connect to WiFi using saved credentials first,
- * and if that fails, starts a captive portal for configuration
+ * and if that fails, starts a captive portal for configuration.
+ * Returns immediately, the attempts run in checkAndMaintainWiFi().
  */
 void initWiFiWithCaptivePortal();
 